@@ -0,0 +1,394 @@
+//  interop/bench/throughput.cpp  ------------------------------------------------------//
+
+//  Copyright Beman Dawes 2012
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+//--------------------------------------------------------------------------------------//
+//                                                                                      //
+//  Conversion throughput for every pair of the narrow, wide, utf8, utf16, and utf32    //
+//  codecs, through make_string(), copy_string(), conversion_iterator, and the stream   //
+//  inserters, over locally generated ASCII, Latin, CJK, emoji, and mixed corpora.      //
+//                                                                                      //
+//  Results are written as JSON, to stdout or to the named file. Progress goes to       //
+//  stderr.                                                                             //
+//                                                                                      //
+//    Usage: throughput [-t seconds] [-n code-points] [output-file]                    //
+//                                                                                      //
+//  -t is the minimum time spent on each measurement (default 0.25), -n the length      //
+//  of each corpus in code points (default 262144).                                     //
+//                                                                                      //
+//--------------------------------------------------------------------------------------//
+
+#include <boost/interop/string_interop.hpp>
+#include <boost/interop/string_operators.hpp>
+#include <boost/interop/stream.hpp>
+#include <boost/interop/codepage.hpp>
+#include "../test/random_sequence.hpp"
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+#ifndef BOOST_NO_CXX11_HDR_CHRONO
+# include <chrono>
+#else
+# include <ctime>
+#endif
+
+using std::string;
+using std::wstring;
+using boost::u16string;
+using boost::u32string;
+using boost::char32;
+using namespace boost::interop;
+
+namespace
+{
+  double min_time = 0.25;
+  std::size_t corpus_size = 262144;
+  std::vector<string> results;
+  volatile std::size_t sink;  // keeps the optimizer from discarding conversions
+
+//--------------------------------------------------------------------------------------//
+//                                      timer                                           //
+//--------------------------------------------------------------------------------------//
+
+  class timer
+  {
+  public:
+#ifndef BOOST_NO_CXX11_HDR_CHRONO
+    timer() : m_start(std::chrono::steady_clock::now()) {}
+    double elapsed() const
+    {
+      return std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - m_start).count();
+    }
+  private:
+    std::chrono::steady_clock::time_point m_start;
+#else
+    timer() : m_start(std::clock()) {}
+    double elapsed() const
+      { return static_cast<double>(std::clock() - m_start) / CLOCKS_PER_SEC; }
+  private:
+    std::clock_t m_start;
+#endif
+  };
+
+//--------------------------------------------------------------------------------------//
+//                                     corpora                                          //
+//--------------------------------------------------------------------------------------//
+
+  interop_test::random_sequence next_random(0);
+
+  char32 in_range(char32 first, char32 last)
+  {
+    return first + next_random() % (last - first + 1);
+  }
+
+  char32 ascii_cp()
+  {
+    unsigned r = next_random() % 64;
+    return r == 0 ? char32('\n') : r < 12 ? char32(' ') : in_range(0x21, 0x7E);
+  }
+
+  char32 latin_cp()
+  {
+    return next_random() % 4 ? ascii_cp() : in_range(0xA0, 0x17F);
+  }
+
+  char32 cjk_cp()
+  {
+    unsigned r = next_random() % 10;
+    return r < 8 ? in_range(0x4E00, 0x9FFF) : r < 9 ? in_range(0x3041, 0x30FF)
+      : ascii_cp();
+  }
+
+  char32 emoji_cp()
+  {
+    return next_random() % 5 < 3 ? in_range(0x1F300, 0x1FAFF) : ascii_cp();
+  }
+
+  char32 mixed_cp()
+  {
+    switch (next_random() % 4)
+    {
+    case 0:  return latin_cp();
+    case 1:  return cjk_cp();
+    case 2:  return emoji_cp();
+    default: return ascii_cp();
+    }
+  }
+
+  struct corpus
+  {
+    const char* name;
+    u32string   text;
+  };
+
+  std::vector<corpus> make_corpora()
+  {
+    struct { const char* name; char32 (*generate)(); } const kinds[] =
+    {
+      {"ascii", ascii_cp}, {"latin", latin_cp}, {"cjk", cjk_cp},
+      {"emoji", emoji_cp}, {"mixed", mixed_cp}
+    };
+
+    std::vector<corpus> corpora;
+    for (std::size_t i = 0; i < sizeof(kinds) / sizeof(kinds[0]); ++i)
+    {
+      next_random.seed(12345 + i);
+      corpus c;
+      c.name = kinds[i].name;
+      c.text.reserve(corpus_size);
+      while (c.text.size() < corpus_size)
+        c.text += kinds[i].generate();
+      corpora.push_back(c);
+    }
+    return corpora;
+  }
+
+//--------------------------------------------------------------------------------------//
+//                                   operations                                         //
+//--------------------------------------------------------------------------------------//
+
+//  Each operation converts a source string and returns a count that depends on the
+//  result, so that the conversion cannot be optimized away.
+
+  template <class ToCodec, class FromCodec>
+  struct make_string_op
+  {
+    typedef std::basic_string<typename FromCodec::value_type>  from_string;
+    typedef std::basic_string<typename ToCodec::value_type>    to_string;
+
+    std::size_t operator()(const from_string& s) const
+    {
+      return make_string<ToCodec, FromCodec, to_string>(s).size();
+    }
+  };
+
+  template <class ToCodec, class FromCodec>
+  struct copy_string_op
+  {
+    typedef std::basic_string<typename FromCodec::value_type>  from_string;
+    typedef std::basic_string<typename ToCodec::value_type>    to_string;
+
+    std::size_t operator()(const from_string& s) const
+    {
+      to_string r;
+      copy_string<FromCodec, ToCodec>(s.begin(), s.end(), std::back_inserter(r));
+      return r.size();
+    }
+  };
+
+  template <class ToCodec, class FromCodec>
+  struct conversion_iterator_op
+  {
+    typedef std::basic_string<typename FromCodec::value_type>  from_string;
+    typedef conversion_iterator<ToCodec, FromCodec,
+      typename from_string::const_iterator>                    iter_type;
+
+    std::size_t operator()(const from_string& s) const
+    {
+      std::size_t sum = 0;
+      for (iter_type it(s.begin(), s.end()); it != iter_type(); ++it)
+        sum += static_cast<std::size_t>(*it);
+      return sum;
+    }
+  };
+
+  template <class Ostringstream, class FromString>
+  struct stream_op
+  {
+    std::size_t operator()(const FromString& s) const
+    {
+      Ostringstream os;
+      os << s;
+      return os.str().size();
+    }
+  };
+
+//--------------------------------------------------------------------------------------//
+//                                   measurement                                        //
+//--------------------------------------------------------------------------------------//
+
+  template <class ToCodec, class FromCodec>
+  bool representable(const u32string& text,
+    std::basic_string<typename FromCodec::value_type>& source)
+  {
+    //  narrow may not be able to represent the corpus, e.g. Windows codepage 437
+    try
+    {
+      source = make_string<FromCodec, utf32,
+        std::basic_string<typename FromCodec::value_type> >(text);
+      make_string<ToCodec, utf32,
+        std::basic_string<typename ToCodec::value_type> >(text);
+      return true;
+    }
+    catch (const std::exception&)
+    {
+      return false;
+    }
+  }
+
+  template <class Op, class FromString>
+  void measure(Op op, const char* method, const char* to_name, const char* from_name,
+    const corpus& c, const FromString& source)
+  {
+    std::cerr << method << ' ' << from_name << " -> " << to_name << ' ' << c.name
+      << std::endl;
+
+    sink = op(source);  // warm up
+    std::size_t iterations = 0;
+    double seconds = 0.0;
+    timer t;
+    do
+    {
+      sink = op(source);
+      ++iterations;
+    } while ((seconds = t.elapsed()) < min_time);
+
+    double bytes = static_cast<double>(source.size())
+      * sizeof(typename FromString::value_type) * iterations;
+    double cps = static_cast<double>(c.text.size()) * iterations;
+
+    std::ostringstream os;
+    os << "    {\"method\": \"" << method << "\", \"from\": \"" << from_name
+       << "\", \"to\": \"" << to_name << "\", \"corpus\": \"" << c.name
+       << "\", \"input_bytes\": " << source.size() * sizeof(typename FromString::value_type)
+       << ", \"code_points\": " << c.text.size()
+       << ", \"iterations\": " << iterations
+       << ", \"seconds\": " << seconds
+       << ", \"mb_per_s\": " << bytes / seconds / 1.0e6
+       << ", \"code_points_per_s\": " << cps / seconds << '}';
+    results.push_back(os.str());
+  }
+
+  template <class ToCodec, class FromCodec>
+  void bench_pair(const char* to_name, const char* from_name,
+    const std::vector<corpus>& corpora)
+  {
+    for (std::size_t i = 0; i < corpora.size(); ++i)
+    {
+      std::basic_string<typename FromCodec::value_type> source;
+      if (!representable<ToCodec, FromCodec>(corpora[i].text, source))
+        continue;
+      measure(make_string_op<ToCodec, FromCodec>(), "make_string",
+        to_name, from_name, corpora[i], source);
+      measure(copy_string_op<ToCodec, FromCodec>(), "copy_string",
+        to_name, from_name, corpora[i], source);
+      measure(conversion_iterator_op<ToCodec, FromCodec>(), "conversion_iterator",
+        to_name, from_name, corpora[i], source);
+    }
+  }
+
+  template <class ToCodec>
+  void bench_to(const char* to_name, const std::vector<corpus>& corpora)
+  {
+    bench_pair<ToCodec, narrow>(to_name, "narrow", corpora);
+    bench_pair<ToCodec, wide>(to_name, "wide", corpora);
+    bench_pair<ToCodec, utf8>(to_name, "utf8", corpora);
+    bench_pair<ToCodec, utf16>(to_name, "utf16", corpora);
+    bench_pair<ToCodec, utf32>(to_name, "utf32", corpora);
+  }
+
+  //  the inserters convert from the codec selected by the string's character type to
+  //  the codec selected by the stream's
+  template <class Ostringstream, class FromCodec>
+  void bench_stream(const char* to_name, const char* from_name,
+    const std::vector<corpus>& corpora)
+  {
+    typedef typename select_codec<typename Ostringstream::char_type>::type to_codec;
+    for (std::size_t i = 0; i < corpora.size(); ++i)
+    {
+      std::basic_string<typename FromCodec::value_type> source;
+      if (!representable<to_codec, FromCodec>(corpora[i].text, source))
+        continue;
+      measure(stream_op<Ostringstream, std::basic_string<typename FromCodec::value_type> >(),
+        "stream_inserter", to_name, from_name, corpora[i], source);
+    }
+  }
+
+  //  the table narrow uses, or 0 if it is UTF-8
+  const codepage* narrow_table()
+  {
+#ifdef BOOST_WINDOWS_API
+    return find_codepage(437u);  // narrow is narrow_codec<codepage_437>
+#else
+    return narrow_codepage();
+#endif
+  }
+
+  int usage()
+  {
+    std::cerr << "Usage: throughput [-t seconds] [-n code-points] [output-file]\n";
+    return 1;
+  }
+
+}  // unnamed namespace
+
+int main(int argc, char* argv[])
+{
+  const char* path = 0;
+  for (int i = 1; i < argc; ++i)
+  {
+    if (std::strcmp(argv[i], "-t") == 0 && i + 1 < argc)
+      min_time = std::atof(argv[++i]);
+    else if (std::strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+      corpus_size = static_cast<std::size_t>(std::atol(argv[++i]));
+    else if (argv[i][0] != '-' && !path)
+      path = argv[i];
+    else
+      return usage();
+  }
+  if (min_time <= 0.0 || corpus_size == 0)
+    return usage();
+
+  std::vector<corpus> corpora = make_corpora();
+
+  bench_to<narrow>("narrow", corpora);
+  bench_to<wide>("wide", corpora);
+  bench_to<utf8>("utf8", corpora);
+  bench_to<utf16>("utf16", corpora);
+  bench_to<utf32>("utf32", corpora);
+
+  bench_stream<std::ostringstream, wide>("narrow", "wide", corpora);
+  bench_stream<std::ostringstream, utf16>("narrow", "utf16", corpora);
+  bench_stream<std::ostringstream, utf32>("narrow", "utf32", corpora);
+  bench_stream<std::wostringstream, narrow>("wide", "narrow", corpora);
+  bench_stream<std::wostringstream, utf16>("wide", "utf16", corpora);
+  bench_stream<std::wostringstream, utf32>("wide", "utf32", corpora);
+
+  std::ofstream file;
+  if (path)
+  {
+    file.open(path);
+    if (!file)
+    {
+      std::cerr << "throughput: could not open " << path << std::endl;
+      return 1;
+    }
+  }
+  std::ostream& out = path ? file : std::cout;
+
+  out << "{\n  \"benchmark\": \"interop throughput\",\n"
+      << "  \"narrow_is_utf8\": " << (narrow_table() ? "false" : "true") << ",\n"
+      << "  \"narrow_encoding\": \""
+      << (narrow_table() ? narrow_table()->name : "UTF-8") << "\",\n"
+      << "  \"wchar_t_bits\": " << sizeof(wchar_t) * 8 << ",\n"
+      << "  \"min_time\": " << min_time << ",\n  \"corpora\": [\n";
+  for (std::size_t i = 0; i < corpora.size(); ++i)
+    out << "    {\"name\": \"" << corpora[i].name << "\", \"code_points\": "
+        << corpora[i].text.size() << (i + 1 < corpora.size() ? "},\n" : "}\n");
+  out << "  ],\n  \"results\": [\n";
+  for (std::size_t i = 0; i < results.size(); ++i)
+    out << results[i] << (i + 1 < results.size() ? ",\n" : "\n");
+  out << "  ]\n}\n";
+  return out ? 0 : 1;
+}
@@ -0,0 +1,299 @@
+//  boost/interop/code_point_view.hpp  -------------------------------------------------//
+
+//  Copyright Beman Dawes 2012
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+//--------------------------------------------------------------------------------------//
+//                                                                                      //
+//  Random access by code point to encoded strings, without converting them.            //
+//                                                                                      //
+//  A code_point_view<Codec> refers to a range of Codec units, such as a UTF-8 or       //
+//  UTF-16 string, and presents it as a sequence of code points:                        //
+//                                                                                      //
+//    code_point_view<utf8> v(s);                                                       //
+//    char32 c = v[1000];                  // the 1001st code point                     //
+//    std::string t = v.substr(10, 20);    // 20 code points from the 11th, as UTF-8    //
+//                                                                                      //
+//  The first random access scans the range once and records the unit offset of every   //
+//  64th code point. An access then starts from the nearest checkpoint and steps over   //
+//  at most 63 code points. For UTF-8 and UTF-16 the scan counts the units that start   //
+//  a code point a vector at a time (see detail/simd.hpp). UTF-32 and the single byte   //
+//  codecs have one unit per code point, so they need neither a scan nor checkpoints,   //
+//  and an access indexes the units directly. Iteration in either direction, with       //
+//  begin() and end() or rbegin() and rend(), does not build the index.                 //
+//                                                                                      //
+//  The view does not own the units, which must outlive it. The index is built by a     //
+//  const member function, so concurrent first accesses to one view must be             //
+//  synchronized. The range must be valid; an access that decodes an invalid sequence   //
+//  reports it with Codec::invalid_input().                                             //
+//                                                                                      //
+//--------------------------------------------------------------------------------------//
+
+#if !defined(BOOST_INTEROP_CODE_POINT_VIEW_HPP)
+# define BOOST_INTEROP_CODE_POINT_VIEW_HPP
+
+#include <boost/interop/string_interop.hpp>
+#include <cstddef>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/config/abi_prefix.hpp> // must be the last #include
+
+namespace boost
+{
+namespace interop
+{
+
+namespace detail
+{
+  //  code_point_index<Codec>::build(first, last, stride, offsets) appends the offset of
+  //  every stride'th code point of [first, last) to offsets and returns the number of
+  //  code points. A codec with one unit per code point appends nothing, and code point
+  //  i is then unit i. advance(p, last, n) returns p moved forward n code points. The
+  //  general case decodes; the specializations count or skip units directly.
+
+  template <class Codec>
+  struct code_point_index
+  {
+    typedef typename Codec::value_type unit_type;
+
+    static std::size_t build(const unit_type* first, const unit_type* last,
+      std::size_t stride, std::vector<std::size_t>& offsets)
+    {
+      std::size_t count = 0;
+      for (const unit_type* p = first; p != last; ++count)
+      {
+        if (count % stride == 0)
+          offsets.push_back(p - first);
+        char32 cp;
+        Codec::decode(p, last, cp);  // always consumes at least one unit
+      }
+      return count;
+    }
+
+    static const unit_type* advance(const unit_type* p, const unit_type* last,
+      std::size_t n)
+    {
+      for (char32 cp; n && p != last; --n)
+        Codec::decode(p, last, cp);
+      return p;
+    }
+  };
+
+  //  one unit per code point
+  template <class Codec>
+  struct fixed_width_index
+  {
+    typedef typename Codec::value_type unit_type;
+
+    static std::size_t build(const unit_type* first, const unit_type* last,
+      std::size_t, std::vector<std::size_t>&)
+      { return last - first; }
+
+    static const unit_type* advance(const unit_type* p, const unit_type* last,
+      std::size_t n)
+    {
+      return n < static_cast<std::size_t>(last - p) ? p + n : last;
+    }
+  };
+
+  template <class charT>
+  struct code_point_index<generic_utf32<charT> >
+    : fixed_width_index<generic_utf32<charT> > {};
+
+  template <class Table>
+  struct code_point_index<narrow_codec<Table> >
+    : fixed_width_index<narrow_codec<Table> > {};
+
+  template <>
+  struct code_point_index<utf8>
+  {
+    static std::size_t build(const char* first, const char* last, std::size_t stride,
+      std::vector<std::size_t>& offsets)
+    {
+      return simd::utf8_checkpoints(first, last - first, stride,
+        std::back_inserter(offsets));
+    }
+
+    static const char* advance(const char* p, const char* last, std::size_t n)
+    {
+      for (; n && p != last; --n)
+      {
+        ++p;
+        while (p != last && (static_cast<unsigned char>(*p) & 0xC0u) == 0x80u)
+          ++p;
+      }
+      return p;
+    }
+  };
+
+  template <class charT>
+  struct code_point_index<generic_utf16<charT> >
+  {
+    static std::size_t build(const charT* first, const charT* last, std::size_t stride,
+      std::vector<std::size_t>& offsets)
+    {
+      return simd::utf16_checkpoints(first, last - first, stride,
+        std::back_inserter(offsets));
+    }
+
+    static const charT* advance(const charT* p, const charT* last, std::size_t n)
+    {
+      for (; n && p != last; --n)
+      {
+        ++p;
+        if (p != last && (static_cast< ::boost::uint16_t>(*p) & 0xFC00u) == 0xDC00u)
+          ++p;
+      }
+      return p;
+    }
+  };
+
+#ifndef BOOST_WINDOWS_API
+  template <>
+  struct code_point_index<locale_narrow>
+  {
+    static std::size_t build(const char* first, const char* last, std::size_t stride,
+      std::vector<std::size_t>& offsets)
+      { return build(narrow_codepage(), first, last, stride, offsets); }
+
+    static std::size_t build(const codepage* table, const char* first,
+      const char* last, std::size_t stride, std::vector<std::size_t>& offsets)
+    {
+      return table
+        ? fixed_width_index<locale_narrow>::build(first, last, stride, offsets)
+        : code_point_index<utf8>::build(first, last, stride, offsets);
+    }
+
+    static const char* advance(const char* p, const char* last, std::size_t n)
+      { return advance(narrow_codepage(), p, last, n); }
+
+    static const char* advance(const codepage* table, const char* p,
+      const char* last, std::size_t n)
+    {
+      return table ? fixed_width_index<locale_narrow>::advance(p, last, n)
+        : code_point_index<utf8>::advance(p, last, n);
+    }
+  };
+#endif
+}  // namespace detail
+
+//--------------------------------------------------------------------------------------//
+//                                  code_point_view                                     //
+//--------------------------------------------------------------------------------------//
+
+template <class Codec>
+class code_point_view
+{
+public:
+  typedef typename Codec::value_type                                unit_type;
+  typedef char32                                                    value_type;
+  typedef std::size_t                                               size_type;
+  typedef typename Codec::template from_iterator<const unit_type*>  const_iterator;
+  typedef std::reverse_iterator<const_iterator>              const_reverse_iterator;
+  typedef std::basic_string<unit_type>                              string_type;
+
+  BOOST_STATIC_CONSTANT(size_type, npos = static_cast<size_type>(-1));
+
+  //  the index records the offset of every checkpoint_interval'th code point
+  BOOST_STATIC_CONSTANT(size_type, checkpoint_interval = 64);
+
+  code_point_view() : m_first(0), m_last(0), m_size(npos) {}
+  code_point_view(const unit_type* first, const unit_type* last)
+    : m_first(first), m_last(last), m_size(npos) {}
+  code_point_view(const unit_type* p, size_type n)
+    : m_first(p), m_last(p + n), m_size(npos) {}
+  template <class Traits, class Allocator>
+  explicit code_point_view(const std::basic_string<unit_type, Traits, Allocator>& s)
+    : m_first(s.data()), m_last(s.data() + s.size()), m_size(npos) {}
+
+  //  the units viewed
+  const unit_type* units_begin() const  { return m_first; }
+  const unit_type* units_end() const    { return m_last; }
+
+  //  sequential access; does not build the index
+  const_iterator begin() const  { return const_iterator(m_first, m_last); }
+  const_iterator end() const    { return const_iterator(m_first, m_last, m_last); }
+  const_reverse_iterator rbegin() const  { return const_reverse_iterator(end()); }
+  const_reverse_iterator rend() const    { return const_reverse_iterator(begin()); }
+  bool empty() const            { return m_first == m_last; }
+
+  //  the number of code points
+  size_type size() const
+  {
+    index();
+    return m_size;
+  }
+
+  //  Requires: i < size()
+  char32 operator[](size_type i) const
+  {
+    const unit_type* p = position(i);
+    BOOST_ASSERT_MSG(p != m_last, "code_point_view index out of range");
+    char32 cp;
+    if (Codec::decode(p, m_last, cp) != detail::decode_ok)
+      Codec::invalid_input(cp);
+    return cp;
+  }
+
+  char32 at(size_type i) const
+  {
+    if (i >= size())
+      throw std::out_of_range("code_point_view::at");
+    return (*this)[i];
+  }
+
+  //  the first unit of code point i, or units_end() if i >= size()
+  const unit_type* position(size_type i) const
+  {
+    index();
+    if (i >= m_size)
+      return m_last;
+    if (m_checkpoints.empty())  // one unit per code point
+      return m_first + i;
+    return detail::code_point_index<Codec>::advance(
+      m_first + m_checkpoints[i / checkpoint_interval], m_last,
+      i % checkpoint_interval);
+  }
+
+  //  the code points [pos, pos + n), or as many of them as there are
+  code_point_view subview(size_type pos, size_type n = npos) const
+  {
+    if (pos > size())
+      throw std::out_of_range("code_point_view::subview");
+    const unit_type* first = position(pos);
+    const unit_type* last = n >= m_size - pos ? m_last : position(pos + n);
+    return code_point_view(first, last);
+  }
+
+  //  the units of subview(pos, n)
+  string_type substr(size_type pos, size_type n = npos) const
+  {
+    code_point_view v(subview(pos, n));
+    return string_type(v.m_first, v.m_last);
+  }
+
+private:
+  const unit_type*                  m_first;
+  const unit_type*                  m_last;
+  mutable std::vector<std::size_t>  m_checkpoints;
+  mutable size_type                 m_size;  // npos until the index is built
+
+  void index() const
+  {
+    if (m_size == npos)
+      m_size = detail::code_point_index<Codec>::build(m_first, m_last,
+        checkpoint_interval, m_checkpoints);
+  }
+};
+
+}  // namespace interop
+}  // namespace boost
+
+#include <boost/config/abi_suffix.hpp> // pops abi_prefix.hpp pragmas
+
+#endif  // BOOST_INTEROP_CODE_POINT_VIEW_HPP
@@ -0,0 +1,142 @@
+//  boost/interop/codecvt.hpp  ---------------------------------------------------------//
+
+//  Copyright Beman Dawes 2012
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+//--------------------------------------------------------------------------------------//
+//                                                                                      //
+//  A std::codecvt facet that converts with the interop codecs.                         //
+//                                                                                      //
+//  codecvt_facet<InternCodec, ExternCodec> converts between the internal character     //
+//  type of a stream, such as wchar_t or char16, and an external char encoding, UTF-8   //
+//  by default. It replaces the deprecated std::codecvt_utf8 family:                   //
+//                                                                                      //
+//    std::wifstream in;                                                                //
+//    in.imbue(std::locale(in.getloc(), new codecvt_facet<wide>));                      //
+//                                                                                      //
+//  Each call to in() or out() converts the whole buffer it is given with the block     //
+//  kernels. The facet is stateless: a sequence left incomplete at the end of a buffer  //
+//  is reported as partial and not consumed, so the stream presents it again with       //
+//  more input.                                                                         //
+//                                                                                      //
+//  Both codecs must be BlockCodecs (see string_interop.hpp).                           //
+//                                                                                      //
+//--------------------------------------------------------------------------------------//
+
+#if !defined(BOOST_INTEROP_CODECVT_HPP)
+# define BOOST_INTEROP_CODECVT_HPP
+
+#include <boost/interop/string_interop.hpp>
+#include <boost/static_assert.hpp>
+#include <cstddef>
+#include <cwchar>
+#include <locale>
+
+#include <boost/config/abi_prefix.hpp> // must be the last #include
+
+namespace boost
+{
+namespace interop
+{
+
+template <class InternCodec, class ExternCodec = utf8>
+class codecvt_facet
+  : public std::codecvt<typename InternCodec::value_type,
+      typename ExternCodec::value_type, std::mbstate_t>
+{
+  BOOST_STATIC_ASSERT_MSG((detail::has_block_interface<InternCodec>::value
+    && detail::has_block_interface<ExternCodec>::value),
+    "codecvt_facet requires BlockCodecs");
+
+  typedef std::codecvt<typename InternCodec::value_type,
+    typename ExternCodec::value_type, std::mbstate_t>  base_type;
+
+public:
+  typedef typename InternCodec::value_type  intern_type;
+  typedef typename ExternCodec::value_type  extern_type;
+  typedef std::mbstate_t                    state_type;
+  typedef std::codecvt_base::result         result;
+
+  explicit codecvt_facet(std::size_t refs = 0) : base_type(refs) {}
+
+protected:
+  result do_out(state_type&, const intern_type* from, const intern_type* from_end,
+    const intern_type*& from_next, extern_type* to, extern_type* to_end,
+    extern_type*& to_next) const
+  {
+    return convert<ExternCodec, InternCodec>(from, from_end, from_next,
+      to, to_end, to_next);
+  }
+
+  result do_in(state_type&, const extern_type* from, const extern_type* from_end,
+    const extern_type*& from_next, intern_type* to, intern_type* to_end,
+    intern_type*& to_next) const
+  {
+    return convert<InternCodec, ExternCodec>(from, from_end, from_next,
+      to, to_end, to_next);
+  }
+
+  result do_unshift(state_type&, extern_type* to, extern_type*,
+    extern_type*& to_next) const
+  {
+    to_next = to;
+    return std::codecvt_base::noconv;
+  }
+
+  int do_encoding() const throw()       { return 0; }  // variable length
+  bool do_always_noconv() const throw() { return false; }
+
+  //  external units needed to produce one internal unit
+  int do_max_length() const throw()
+    { return static_cast<int>(ExternCodec::max_units); }
+
+  //  external units in [from, from_end) that convert to at most max internal units
+  int do_length(state_type&, const extern_type* from, const extern_type* from_end,
+    std::size_t max) const
+  {
+    const extern_type* p = from;
+    while (p != from_end)
+    {
+      const extern_type* next = p;
+      char32 cp;
+      if (ExternCodec::decode(next, from_end, cp) != detail::decode_ok)
+        break;
+      std::size_t n = InternCodec::encoded_length(cp);
+      if (n > max)
+        break;
+      max -= n;
+      p = next;
+    }
+    return static_cast<int>(p - from);
+  }
+
+private:
+  template <class ToCodec, class FromCodec>
+  static result convert(const typename FromCodec::value_type* from,
+    const typename FromCodec::value_type* from_end,
+    const typename FromCodec::value_type*& from_next,
+    typename ToCodec::value_type* to, typename ToCodec::value_type* to_end,
+    typename ToCodec::value_type*& to_next)
+  {
+    char32 cp = 0;
+    detail::block_status status = detail::block_converter<ToCodec, FromCodec>::convert(
+      from, from_end, to, to_end, cp);
+    from_next = from;
+    to_next = to;
+    switch (status)
+    {
+    case detail::block_ok:       return std::codecvt_base::ok;
+    case detail::block_invalid:  return std::codecvt_base::error;
+    default:                     return std::codecvt_base::partial;
+    }
+  }
+};
+
+}  // namespace interop
+}  // namespace boost
+
+#include <boost/config/abi_suffix.hpp> // pops abi_prefix.hpp pragmas
+
+#endif  // BOOST_INTEROP_CODECVT_HPP
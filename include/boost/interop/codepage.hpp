@@ -0,0 +1,104 @@
+//  boost/interop/codepage.hpp  --------------------------------------------------------//
+
+//  Copyright Beman Dawes 2012
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+//--------------------------------------------------------------------------------------//
+//                                                                                      //
+//  Run time selection of a single byte codepage.                                       //
+//                                                                                      //
+//  When the codepage is known at compile time, use narrow_codec<Table> with a table    //
+//  type from codepage_tables.hpp. When it is only known at run time, for example from  //
+//  a file header or a configuration setting, look it up in the registry:               //
+//                                                                                      //
+//    const codepage* cp = find_codepage("ISO-8859-5");                                 //
+//    if (cp)                                                                           //
+//      from_codepage<utf8>(*cp, data, data + size, result);                            //
+//                                                                                      //
+//  Names match ignoring case and punctuation, so "ISO-8859-5", "iso8859_5" and         //
+//  "ISO8859-5" are the same. Each codepage also has a common alias, such as "cp1252"   //
+//  or "latin1", and most have a Windows code page identifier.                          //
+//                                                                                      //
+//  A codepage refers to the same tables as its table type, so run time conversion is   //
+//  the same single table lookup per byte as narrow_codec<Table>.                       //
+//                                                                                      //
+//--------------------------------------------------------------------------------------//
+
+#if !defined(BOOST_INTEROP_CODEPAGE_HPP)
+# define BOOST_INTEROP_CODEPAGE_HPP
+
+#include <boost/interop/string_interop.hpp>
+#include <boost/interop/codepage_tables.hpp>
+#include <cstddef>
+#include <string>
+
+#include <boost/config/abi_prefix.hpp> // must be the last #include
+
+namespace boost
+{
+namespace interop
+{
+
+//  the codepage with the given name or alias, or 0 if there is none
+BOOST_INTEROP_DECL const codepage* find_codepage(const char* name);
+
+//  the codepage with the given Windows code page identifier, or 0 if there is none
+BOOST_INTEROP_DECL const codepage* find_codepage(unsigned number);
+
+//  the registered codepages are [codepages_begin(), codepages_end())
+BOOST_INTEROP_DECL const codepage* codepages_begin();
+BOOST_INTEROP_DECL const codepage* codepages_end();
+
+//  from_codepage<ToCodec>(cp, first, last, s) appends the conversion of [first, last),
+//  encoded as cp, to s. Bytes cp leaves undefined convert to U+FFFD.
+
+template <class ToCodec, class ToString>
+void from_codepage(const codepage& cp, const char* first, const char* last, ToString& s)
+{
+  if (first == last)
+    return;
+  std::size_t pos = s.size();
+  detail::resize_for_overwrite(s, pos + (last - first) * ToCodec::max_units);
+  typename ToCodec::value_type* const base = &s[0];
+  typename ToCodec::value_type* out = base + pos;
+  for (; first != last; ++first)
+    out = ToCodec::encode(cp.decode(*first), out);
+  s.resize(out - base);
+}
+
+//  to_codepage<FromCodec>(cp, first, last, s) appends the conversion of [first, last)
+//  to cp to s. Code points cp cannot represent convert to '?'. Invalid input is
+//  reported by FromCodec::invalid_input().
+
+template <class FromCodec, class String>
+void to_codepage(const codepage& cp, const typename FromCodec::value_type* first,
+  const typename FromCodec::value_type* last, String& s)
+{
+  if (first == last)
+    return;
+  std::size_t pos = s.size();
+  detail::resize_for_overwrite(s, pos + (last - first));  // one byte per code point
+  char* const base = &s[0];
+  char* out = base + pos;
+  while (first != last)
+  {
+    char32 c;
+    if (FromCodec::decode(first, last, c) != detail::decode_ok)
+    {
+      s.resize(out - base);
+      FromCodec::invalid_input(c);
+      return;
+    }
+    *out++ = cp.encode(c);
+  }
+  s.resize(out - base);
+}
+
+}  // namespace interop
+}  // namespace boost
+
+#include <boost/config/abi_suffix.hpp> // pops abi_prefix.hpp pragmas
+
+#endif  // BOOST_INTEROP_CODEPAGE_HPP
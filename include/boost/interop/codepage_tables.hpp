@@ -0,0 +1,117 @@
+//  boost/interop/codepage_tables.hpp  -------------------------------------------------//
+
+//  Copyright Beman Dawes 2011, 2012
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+//--------------------------------------------------------------------------------------//
+//                                                                                      //
+//  Single byte codepage tables for narrow_codec<Table> (see string_interop.hpp).       //
+//                                                                                      //
+//  Each table type has three static arrays, defined in src/<table>.cpp as generated    //
+//  by tools/table_generator.cpp from a unicode.org Format A mapping:                   //
+//                                                                                      //
+//    to_utf16[256]       the code point of each byte; U+FFFD for undefined bytes       //
+//    slice_index[512]    for each 128 code point slice of the BMP, the slice of        //
+//                        to_char holding it, or 0 if no code point in it is mapped     //
+//    to_char[]           slice 0 is all '?'; then 128 bytes per active slice           //
+//                                                                                      //
+//  so decoding a byte is one lookup in a 512 byte table, and encoding a code point is  //
+//  a lookup of its slice followed by a lookup of its byte. Every table is a superset   //
+//  of ASCII; table_generator refuses a mapping that is not.                            //
+//                                                                                      //
+//  The tables are in the library binary, not the header, so using one requires         //
+//  linking boost_interop. See codepage.hpp for selecting a table at run time.          //
+//                                                                                      //
+//--------------------------------------------------------------------------------------//
+
+#if !defined(BOOST_INTEROP_CODEPAGE_TABLES_HPP)
+# define BOOST_INTEROP_CODEPAGE_TABLES_HPP
+
+#include <boost/interop/detail/config.hpp>
+#include <boost/interop/cxx11_char_types.hpp>
+#include <boost/cstdint.hpp>
+
+#include <boost/config/abi_prefix.hpp> // must be the last #include
+
+namespace boost
+{
+namespace interop
+{
+
+#define BOOST_INTEROP_CODEPAGE_TABLE(NAME)                  \
+  struct BOOST_INTEROP_DECL NAME                             \
+  {                                                          \
+    static const boost::char16   to_utf16[256];              \
+    static const unsigned char   to_char[];                  \
+    static const boost::uint8_t  slice_index[512];           \
+  }
+
+  //  DOS
+  BOOST_INTEROP_CODEPAGE_TABLE(codepage_437);   // IBM PC, US
+  BOOST_INTEROP_CODEPAGE_TABLE(codepage_850);   // DOS Latin-1
+  BOOST_INTEROP_CODEPAGE_TABLE(codepage_866);   // DOS Cyrillic
+
+  //  Windows
+  BOOST_INTEROP_CODEPAGE_TABLE(codepage_1250);  // Central European
+  BOOST_INTEROP_CODEPAGE_TABLE(codepage_1251);  // Cyrillic
+  BOOST_INTEROP_CODEPAGE_TABLE(codepage_1252);  // Western European
+  BOOST_INTEROP_CODEPAGE_TABLE(codepage_1253);  // Greek
+  BOOST_INTEROP_CODEPAGE_TABLE(codepage_1254);  // Turkish
+  BOOST_INTEROP_CODEPAGE_TABLE(codepage_1255);  // Hebrew
+  BOOST_INTEROP_CODEPAGE_TABLE(codepage_1256);  // Arabic
+  BOOST_INTEROP_CODEPAGE_TABLE(codepage_1257);  // Baltic
+  BOOST_INTEROP_CODEPAGE_TABLE(codepage_1258);  // Vietnamese
+
+  //  ISO/IEC 8859 (there is no part 12)
+  BOOST_INTEROP_CODEPAGE_TABLE(iso_8859_1);     // Latin-1
+  BOOST_INTEROP_CODEPAGE_TABLE(iso_8859_2);     // Latin-2
+  BOOST_INTEROP_CODEPAGE_TABLE(iso_8859_3);     // Latin-3
+  BOOST_INTEROP_CODEPAGE_TABLE(iso_8859_4);     // Latin-4
+  BOOST_INTEROP_CODEPAGE_TABLE(iso_8859_5);     // Cyrillic
+  BOOST_INTEROP_CODEPAGE_TABLE(iso_8859_6);     // Arabic
+  BOOST_INTEROP_CODEPAGE_TABLE(iso_8859_7);     // Greek
+  BOOST_INTEROP_CODEPAGE_TABLE(iso_8859_8);     // Hebrew
+  BOOST_INTEROP_CODEPAGE_TABLE(iso_8859_9);     // Latin-5
+  BOOST_INTEROP_CODEPAGE_TABLE(iso_8859_10);    // Latin-6
+  BOOST_INTEROP_CODEPAGE_TABLE(iso_8859_11);    // Thai
+  BOOST_INTEROP_CODEPAGE_TABLE(iso_8859_13);    // Latin-7
+  BOOST_INTEROP_CODEPAGE_TABLE(iso_8859_14);    // Latin-8
+  BOOST_INTEROP_CODEPAGE_TABLE(iso_8859_15);    // Latin-9
+  BOOST_INTEROP_CODEPAGE_TABLE(iso_8859_16);    // Latin-10
+
+  //  KOI8
+  BOOST_INTEROP_CODEPAGE_TABLE(koi8_r);         // Russian
+  BOOST_INTEROP_CODEPAGE_TABLE(koi8_u);         // Ukrainian
+
+#undef BOOST_INTEROP_CODEPAGE_TABLE
+
+//  a table selected at run time; see codepage.hpp
+struct codepage
+{
+  const char*            name;         // IANA preferred name, e.g. "windows-1252"
+  const char*            alias;        // common alias, e.g. "cp1252"
+  unsigned               number;       // Windows code page identifier, or 0 if none
+  const boost::char16*   to_utf16;     // as for the table types above
+  const unsigned char*   to_char;
+  const boost::uint8_t*  slice_index;
+
+  char32 decode(char c) const
+  {
+    return static_cast<char32>(to_utf16[static_cast<unsigned char>(c)]);
+  }
+
+  char encode(char32 cp) const
+  {
+    return (cp & 0xFFFF0000U) ? '?'
+      : static_cast<char>(to_char[(slice_index[cp >> 7] << 7) | (cp & 0x7f)]);
+  }
+};
+
+}  // namespace interop
+}  // namespace boost
+
+#include <boost/config/abi_suffix.hpp> // pops abi_prefix.hpp pragmas
+
+#endif  // BOOST_INTEROP_CODEPAGE_TABLES_HPP
@@ -0,0 +1,127 @@
+//  boost/interop/conversion_stats.hpp  ------------------------------------------------//
+
+//  Copyright Beman Dawes 2012
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+//--------------------------------------------------------------------------------------//
+//                                                                                      //
+//  Conversion statistics, per codec pair.                                              //
+//                                                                                      //
+//  Compiled in only when BOOST_INTEROP_STATS is defined (see detail/config.hpp), in    //
+//  which case make_string() and conversion_iterator count, for each ToCodec and        //
+//  FromCodec pair:                                                                     //
+//                                                                                      //
+//    calls           make_string() and append_batch() calls, and conversion_iterators  //
+//                    constructed from a range, a size, or a null terminated sequence   //
+//    input_units     input units converted, where the input's length is known without  //
+//                    another pass over it: a size, or a range of forward iterators     //
+//    output_units    units produced by make_string(), append_batch(), and              //
+//                    copy_string(); a conversion_iterator used directly cannot count   //
+//                    its output without slowing every increment, so it does not        //
+//    errors          invalid sequences an ErrorPolicy was applied to                   //
+//    fast_path       calls on the block path, or fused conversion_iterators            //
+//    fallback_path   calls that convert one code point at a time through iterators     //
+//                                                                                      //
+//  Each thread counts into cache line sized counters of its own, so counting takes    //
+//  no locks and threads do not share cache lines. conversion_stats_snapshot() sums     //
+//  every thread's counters, including those of threads that have exited. Counters     //
+//  are never reset; to measure an interval, subtract one snapshot from another.        //
+//                                                                                      //
+//--------------------------------------------------------------------------------------//
+
+#if !defined(BOOST_INTEROP_CONVERSION_STATS_HPP)
+# define BOOST_INTEROP_CONVERSION_STATS_HPP
+
+#include <boost/interop/detail/config.hpp>
+#include <boost/interop/cxx11_char_types.hpp>
+#include <boost/cstdint.hpp>
+#include <cstddef>
+#include <vector>
+#ifndef BOOST_INTEROP_NO_THREADS
+# include <atomic>
+#endif
+
+#include <boost/config/abi_prefix.hpp> // must be the last #include
+
+namespace boost
+{
+namespace interop
+{
+
+//  the counts for one codec pair, or the totals over all of them
+struct conversion_stats
+{
+  const char*     to_codec;    // codec names, such as "utf8" or "ISO-8859-1"
+  const char*     from_codec;
+  boost::uint64_t calls;
+  boost::uint64_t input_units;
+  boost::uint64_t output_units;
+  boost::uint64_t errors;
+  boost::uint64_t fast_path;
+  boost::uint64_t fallback_path;
+};
+
+struct stats_snapshot
+{
+  std::vector<conversion_stats> pairs;   // in the order the pairs were first used
+  conversion_stats              totals;  // the sums over pairs; the names are ""
+};
+
+//  the counts so far of every thread
+BOOST_INTEROP_DECL stats_snapshot conversion_stats_snapshot();
+
+namespace detail
+{
+#ifndef BOOST_INTEROP_NO_THREADS
+  //  written only by the thread owning it, and read by conversion_stats_snapshot()
+  typedef std::atomic<boost::uint64_t> stats_count;
+
+  inline void stats_add(stats_count& count, boost::uint64_t n)
+  {
+    count.store(count.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+  }
+  inline boost::uint64_t stats_load(const stats_count& count)
+  {
+    return count.load(std::memory_order_relaxed);
+  }
+#else
+  typedef boost::uint64_t stats_count;
+
+  inline void stats_add(stats_count& count, boost::uint64_t n) { count += n; }
+  inline boost::uint64_t stats_load(const stats_count& count) { return count; }
+#endif
+
+  const std::size_t stats_line_size = 64;
+
+  //  one thread's counters for one codec pair, padded to a cache line
+  struct stats_counters
+  {
+    stats_count calls;
+    stats_count input_units;
+    stats_count output_units;
+    stats_count errors;
+    stats_count fast_path;
+    stats_count fallback_path;
+    char        padding[stats_line_size - 6 * sizeof(stats_count)];
+  };
+
+  //  Returns the index of the pair with the given codec names, registering it on first
+  //  use. The names must have static storage duration.
+  BOOST_INTEROP_DECL std::size_t register_codec_pair(const char* to_codec,
+    const char* from_codec);
+
+  //  the calling thread's counters for the pair with the given index
+  BOOST_INTEROP_DECL stats_counters& thread_counters(std::size_t pair);
+
+  //  the name of the registered codepage whose to_utf16 table is given, or "codepage"
+  BOOST_INTEROP_DECL const char* codepage_name(const boost::char16* to_utf16);
+} // namespace detail
+
+} // namespace interop
+} // namespace boost
+
+#include <boost/config/abi_suffix.hpp> // pops abi_prefix.hpp pragmas
+
+#endif  // BOOST_INTEROP_CONVERSION_STATS_HPP
@@ -13,6 +13,46 @@
 
 #  define BOOST_INTEROP_THROW(e) throw e
 
+//  SIMD instruction sets used by the block transcoding kernels. Define
+//  BOOST_INTEROP_NO_SIMD to restrict the kernels to portable code.
+#if !defined(BOOST_INTEROP_NO_SIMD)
+# if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   define BOOST_INTEROP_SSE2
+# endif
+# if defined(__SSSE3__) || defined(__AVX__)
+#   define BOOST_INTEROP_SSSE3
+# endif
+# if defined(__AVX2__)
+#   define BOOST_INTEROP_AVX2
+# endif
+#endif
+
+//  The null terminator search reads whole aligned vectors, which may extend past the
+//  terminator but never into another page. Address sanitizers report those reads, so
+//  under them, or when BOOST_INTEROP_NO_OVERREAD is defined, the search is scalar.
+#if !defined(BOOST_INTEROP_NO_OVERREAD)
+# if defined(__SANITIZE_ADDRESS__)
+#   define BOOST_INTEROP_NO_OVERREAD
+# elif defined(__has_feature)
+#   if __has_feature(address_sanitizer)
+#     define BOOST_INTEROP_NO_OVERREAD
+#   endif
+# endif
+#endif
+
+//  std::span overloads of transcode() when <span> is available
+#if !defined(BOOST_INTEROP_NO_SPAN) && defined(__has_include)
+# if __has_include(<span>) && __cplusplus > 201703L
+#   define BOOST_INTEROP_SPAN
+# endif
+#endif
+
+//  parallel_transcode() runs on std::thread when <thread> is available. Define
+//  BOOST_INTEROP_NO_THREADS to have it convert on the calling thread.
+#if !defined(BOOST_INTEROP_NO_THREADS) && defined(BOOST_NO_CXX11_HDR_THREAD)
+# define BOOST_INTEROP_NO_THREADS
+#endif
+
 //  For internal use only
 #ifdef BOOST_XOP_DEBUGGING_LOG
 #  define BOOST_XOP_LOG(MSG) std::cout << (MSG) << std::endl
@@ -27,6 +67,22 @@
 #  define BOOST_XOP_STRING_LOG(MSG)
 #endif
 
+//  Conversion statistics (see conversion_stats.hpp) are only counted when
+//  BOOST_INTEROP_STATS is defined; otherwise these expand to nothing. TO and FROM name
+//  the codecs; IN and OUT are unit counts, and FAST is true on the fast path.
+#ifdef BOOST_INTEROP_STATS
+#  define BOOST_INTEROP_STATS_CALL(TO, FROM, IN, OUT, FAST) \
+     ::boost::interop::detail::count_call<TO, FROM>((IN), (OUT), (FAST))
+#  define BOOST_INTEROP_STATS_UNITS(TO, FROM, IN, OUT) \
+     ::boost::interop::detail::count_units<TO, FROM>((IN), (OUT))
+#  define BOOST_INTEROP_STATS_ERROR(TO, FROM) \
+     ::boost::interop::detail::count_error<TO, FROM>()
+#else
+#  define BOOST_INTEROP_STATS_CALL(TO, FROM, IN, OUT, FAST)
+#  define BOOST_INTEROP_STATS_UNITS(TO, FROM, IN, OUT)
+#  define BOOST_INTEROP_STATS_ERROR(TO, FROM)
+#endif
+
 //----------------------------  separate compilation  ----------------------------------//
 
 //  This header implements separate compilation features as described in
@@ -0,0 +1,88 @@
+//  boost/interop/detail/is_contiguous.hpp  --------------------------------------------//
+
+//  Copyright Beman Dawes 2012
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+#if !defined(BOOST_INTEROP_IS_CONTIGUOUS_HPP)
+# define BOOST_INTEROP_IS_CONTIGUOUS_HPP
+
+#include <boost/interop/cxx11_char_types.hpp>
+#include <boost/type_traits/integral_constant.hpp>
+#include <boost/type_traits/is_pointer.hpp>
+#include <boost/type_traits/is_same.hpp>
+#include <boost/type_traits/remove_cv.hpp>
+#include <iterator>
+#include <string>
+#include <vector>
+
+//--------------------------------------------------------------------------------------//
+//                                                                                      //
+//  is_contiguous_iterator<T>::value is true if T is known to point into contiguous     //
+//  storage of character type elements, so that [&*first, &*first + n) is valid for     //
+//  a range [first, first + n). That is true of pointers and of the iterators of        //
+//  std::basic_string and std::vector with default allocators.                          //
+//                                                                                      //
+//  is_contiguous_container<T>::value is true if T is a std::basic_string or a          //
+//  std::vector, with any traits or allocator, of a character type.                     //
+//                                                                                      //
+//  Only the character types are considered, so that std::vector<bool> and other       //
+//  exotic element types never qualify.                                                 //
+//                                                                                      //
+//--------------------------------------------------------------------------------------//
+
+namespace boost
+{
+namespace interop
+{
+namespace detail
+{
+  template <class T> struct is_character : boost::false_type {};
+  template <> struct is_character<char> : boost::true_type {};
+  template <> struct is_character<wchar_t> : boost::true_type {};
+  template <> struct is_character<boost::char16> : boost::true_type {};
+  template <> struct is_character<boost::char32> : boost::true_type {};
+
+  template <class Iterator, class T, bool IsCharacter>
+  struct is_contiguous_iterator_helper : boost::false_type {};
+
+  template <class Iterator, class T>
+  struct is_contiguous_iterator_helper<Iterator, T, true>
+    : boost::integral_constant<bool,
+        boost::is_same<Iterator, typename std::basic_string<T>::const_iterator>::value
+        || boost::is_same<Iterator, typename std::basic_string<T>::iterator>::value
+        || boost::is_same<Iterator, typename std::vector<T>::const_iterator>::value
+        || boost::is_same<Iterator, typename std::vector<T>::iterator>::value>
+  {};
+
+  template <class Iterator, bool IsPointer = boost::is_pointer<Iterator>::value>
+  struct is_contiguous_iterator
+    : is_contiguous_iterator_helper<Iterator,
+        typename boost::remove_cv<
+          typename std::iterator_traits<Iterator>::value_type>::type,
+        is_character<typename boost::remove_cv<
+          typename std::iterator_traits<Iterator>::value_type>::type>::value>
+  {};
+
+  template <class Iterator>
+  struct is_contiguous_iterator<Iterator, true>
+    : is_character<typename boost::remove_cv<
+        typename std::iterator_traits<Iterator>::value_type>::type>
+  {};
+
+  template <class T> struct is_contiguous_container : boost::false_type {};
+
+  template <class charT, class Traits, class Allocator>
+  struct is_contiguous_container<std::basic_string<charT, Traits, Allocator> >
+    : is_character<charT> {};
+
+  template <class T, class Allocator>
+  struct is_contiguous_container<std::vector<T, Allocator> >
+    : is_character<T> {};
+
+} // namespace detail
+} // namespace interop
+} // namespace boost
+
+#endif  // BOOST_INTEROP_IS_CONTIGUOUS_HPP
@@ -0,0 +1,1184 @@
+//  boost/interop/detail/simd.hpp  -----------------------------------------------------//
+
+//  Copyright Beman Dawes 2012
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+//--------------------------------------------------------------------------------------//
+//                                                                                      //
+//  Vectorized helpers for the block transcoding kernels in string_interop.hpp.         //
+//                                                                                      //
+//  Everything here works on raw code units and knows nothing about codecs. Each        //
+//  function has a portable implementation; SSE2 and AVX2 versions are selected at      //
+//  compile time by BOOST_INTEROP_SSE2 and BOOST_INTEROP_AVX2 (see detail/config.hpp).  //
+//                                                                                      //
+//--------------------------------------------------------------------------------------//
+
+#if !defined(BOOST_INTEROP_SIMD_HPP)
+# define BOOST_INTEROP_SIMD_HPP
+
+#include <boost/interop/detail/config.hpp>
+#include <boost/interop/cxx11_char_types.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/static_assert.hpp>
+#include <algorithm>
+#include <cstddef>
+
+#ifdef BOOST_INTEROP_SSE2
+# include <emmintrin.h>
+#endif
+#ifdef BOOST_INTEROP_SSSE3
+# include <tmmintrin.h>
+#endif
+#ifdef BOOST_INTEROP_AVX2
+# include <immintrin.h>
+#endif
+#ifdef BOOST_MSVC
+# include <intrin.h>
+#endif
+
+namespace boost
+{
+namespace interop
+{
+namespace detail
+{
+namespace simd
+{
+
+#ifdef BOOST_INTEROP_SSE2
+
+  //  ascii_block<FromSize, ToSize>::run(in, out, n) converts whole blocks of 16 units
+  //  from the start of in to out while every unit in the block is ASCII, returning the
+  //  number of units converted. It stops before the first block containing a unit
+  //  >= 0x80 or with fewer than 16 units remaining; callers finish with scalar code.
+
+  //  load 16 units and test them; on success v holds them packed as 16 bytes
+  template <std::size_t FromSize> struct ascii_load;
+
+  template <> struct ascii_load<1>
+  {
+    static bool load(const void* in, __m128i& v)
+    {
+      v = _mm_loadu_si128(static_cast<const __m128i*>(in));
+      return _mm_movemask_epi8(v) == 0;
+    }
+  };
+
+  template <> struct ascii_load<2>
+  {
+    static bool load(const void* in, __m128i& v)
+    {
+      const __m128i* p = static_cast<const __m128i*>(in);
+      __m128i v0 = _mm_loadu_si128(p);
+      __m128i v1 = _mm_loadu_si128(p + 1);
+      __m128i high = _mm_and_si128(_mm_or_si128(v0, v1), _mm_set1_epi16(-0x80));
+      if (_mm_movemask_epi8(_mm_cmpeq_epi8(high, _mm_setzero_si128())) != 0xFFFF)
+        return false;
+      v = _mm_packus_epi16(v0, v1);
+      return true;
+    }
+  };
+
+  template <> struct ascii_load<4>
+  {
+    static bool load(const void* in, __m128i& v)
+    {
+      const __m128i* p = static_cast<const __m128i*>(in);
+      __m128i v0 = _mm_loadu_si128(p);
+      __m128i v1 = _mm_loadu_si128(p + 1);
+      __m128i v2 = _mm_loadu_si128(p + 2);
+      __m128i v3 = _mm_loadu_si128(p + 3);
+      __m128i high = _mm_and_si128(
+        _mm_or_si128(_mm_or_si128(v0, v1), _mm_or_si128(v2, v3)),
+        _mm_set1_epi32(-0x80));
+      if (_mm_movemask_epi8(_mm_cmpeq_epi8(high, _mm_setzero_si128())) != 0xFFFF)
+        return false;
+      v = _mm_packus_epi16(_mm_packs_epi32(v0, v1), _mm_packs_epi32(v2, v3));
+      return true;
+    }
+  };
+
+  //  store 16 ASCII bytes widened to ToSize units
+  template <std::size_t ToSize> struct ascii_store;
+
+  template <> struct ascii_store<1>
+  {
+    static void store(void* out, __m128i v)
+    {
+      _mm_storeu_si128(static_cast<__m128i*>(out), v);
+    }
+  };
+
+  template <> struct ascii_store<2>
+  {
+    static void store(void* out, __m128i v)
+    {
+      __m128i* p = static_cast<__m128i*>(out);
+      __m128i zero = _mm_setzero_si128();
+      _mm_storeu_si128(p, _mm_unpacklo_epi8(v, zero));
+      _mm_storeu_si128(p + 1, _mm_unpackhi_epi8(v, zero));
+    }
+  };
+
+  template <> struct ascii_store<4>
+  {
+    static void store(void* out, __m128i v)
+    {
+      __m128i* p = static_cast<__m128i*>(out);
+      __m128i zero = _mm_setzero_si128();
+      __m128i lo = _mm_unpacklo_epi8(v, zero);
+      __m128i hi = _mm_unpackhi_epi8(v, zero);
+      _mm_storeu_si128(p, _mm_unpacklo_epi16(lo, zero));
+      _mm_storeu_si128(p + 1, _mm_unpackhi_epi16(lo, zero));
+      _mm_storeu_si128(p + 2, _mm_unpacklo_epi16(hi, zero));
+      _mm_storeu_si128(p + 3, _mm_unpackhi_epi16(hi, zero));
+    }
+  };
+
+  template <std::size_t FromSize, std::size_t ToSize>
+  struct ascii_block
+  {
+    static std::size_t run(const void* in, void* out, std::size_t n)
+    {
+      const char* src = static_cast<const char*>(in);
+      char* dst = static_cast<char*>(out);
+      std::size_t i = 0;
+      __m128i v;
+      for (; i + 16 <= n && ascii_load<FromSize>::load(src, v); i += 16)
+      {
+        ascii_store<ToSize>::store(dst, v);
+        src += 16 * FromSize;
+        dst += 16 * ToSize;
+      }
+      return i;
+    }
+  };
+
+# ifdef BOOST_INTEROP_AVX2
+
+  //  for byte input, test 64 bytes per iteration and widen with vpmovzx
+
+  template <std::size_t ToSize> struct ascii_store64;
+
+  template <> struct ascii_store64<1>
+  {
+    static void store(char* out, __m256i a, __m256i b)
+    {
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), a);
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(out) + 1, b);
+    }
+  };
+
+  template <> struct ascii_store64<2>
+  {
+    static void store(char* out, __m256i a, __m256i b)
+    {
+      __m256i* p = reinterpret_cast<__m256i*>(out);
+      _mm256_storeu_si256(p, _mm256_cvtepu8_epi16(_mm256_castsi256_si128(a)));
+      _mm256_storeu_si256(p + 1, _mm256_cvtepu8_epi16(_mm256_extracti128_si256(a, 1)));
+      _mm256_storeu_si256(p + 2, _mm256_cvtepu8_epi16(_mm256_castsi256_si128(b)));
+      _mm256_storeu_si256(p + 3, _mm256_cvtepu8_epi16(_mm256_extracti128_si256(b, 1)));
+    }
+  };
+
+  template <> struct ascii_store64<4>
+  {
+    static void store4(__m256i* p, __m128i v)
+    {
+      _mm256_storeu_si256(p, _mm256_cvtepu8_epi32(v));
+      _mm256_storeu_si256(p + 1, _mm256_cvtepu8_epi32(_mm_srli_si128(v, 8)));
+    }
+    static void store(char* out, __m256i a, __m256i b)
+    {
+      __m256i* p = reinterpret_cast<__m256i*>(out);
+      store4(p, _mm256_castsi256_si128(a));
+      store4(p + 2, _mm256_extracti128_si256(a, 1));
+      store4(p + 4, _mm256_castsi256_si128(b));
+      store4(p + 6, _mm256_extracti128_si256(b, 1));
+    }
+  };
+
+  template <std::size_t ToSize>
+  struct ascii_block<1, ToSize>
+  {
+    static std::size_t run(const void* in, void* out, std::size_t n)
+    {
+      const char* src = static_cast<const char*>(in);
+      char* dst = static_cast<char*>(out);
+      std::size_t i = 0;
+      for (; i + 64 <= n; i += 64, src += 64, dst += 64 * ToSize)
+      {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src) + 1);
+        if (_mm256_movemask_epi8(_mm256_or_si256(a, b)) != 0)
+          break;
+        ascii_store64<ToSize>::store(dst, a, b);
+      }
+      __m128i v;
+      for (; i + 16 <= n && ascii_load<1>::load(src, v); i += 16)
+      {
+        ascii_store<ToSize>::store(dst, v);
+        src += 16;
+        dst += 16 * ToSize;
+      }
+      return i;
+    }
+  };
+
+# endif  // BOOST_INTEROP_AVX2
+#endif  // BOOST_INTEROP_SSE2
+
+  //  Converts the longest prefix of [in, in + n) consisting of ASCII units (values
+  //  below 0x80) to out, returning the number of units converted. From and To are
+  //  code unit types of any width; signed units with negative values are not ASCII.
+  template <class From, class To>
+  inline std::size_t copy_ascii(const From* in, To* out, std::size_t n)
+  {
+    std::size_t i = 0;
+#ifdef BOOST_INTEROP_SSE2
+    i = ascii_block<sizeof(From), sizeof(To)>::run(in, out, n);
+#endif
+    for (; i < n && static_cast< ::boost::uint32_t>(in[i]) < 0x80u; ++i)
+      out[i] = static_cast<To>(in[i]);
+    return i;
+  }
+
+  //  number of trailing zero bits in a non-zero mask
+  inline unsigned count_trailing_zeros(unsigned mask)
+  {
+#if defined(__GNUC__)
+    return static_cast<unsigned>(__builtin_ctz(mask));
+#elif defined(BOOST_MSVC)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return static_cast<unsigned>(index);
+#else
+    unsigned n = 0;
+    for (; !(mask & 1u); mask >>= 1)
+      ++n;
+    return n;
+#endif
+  }
+
+  //  number of one bits in mask
+  inline unsigned count_ones(unsigned mask)
+  {
+#if defined(__GNUC__)
+    return static_cast<unsigned>(__builtin_popcount(mask));
+#else
+    unsigned n = 0;
+    for (; mask; mask &= mask - 1)
+      ++n;
+    return n;
+#endif
+  }
+
+  //  Returns the number of leading bytes of [p, p + n) below 0x80
+  inline std::size_t ascii_prefix(const char* p, std::size_t n)
+  {
+    std::size_t i = 0;
+#ifdef BOOST_INTEROP_AVX2
+    for (; i + 32 <= n; i += 32)
+    {
+      unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i))));
+      if (mask)
+        return i + count_trailing_zeros(mask);
+    }
+#endif
+#ifdef BOOST_INTEROP_SSE2
+    for (; i + 16 <= n; i += 16)
+    {
+      unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i))));
+      if (mask)
+        return i + count_trailing_zeros(mask);
+    }
+#endif
+    for (; i < n && !(static_cast<unsigned char>(p[i]) & 0x80u); ++i) {}
+    return i;
+  }
+
+//-------------------------------  null terminators  -----------------------------------//
+
+#if defined(BOOST_INTEROP_SSE2) && !defined(BOOST_INTEROP_NO_OVERREAD)
+
+  //  one mask bit per byte, set for every byte of each zero unit of Size bytes
+  template <std::size_t Size> inline unsigned zero_units(__m128i v);
+  template <> inline unsigned zero_units<1>(__m128i v)
+    { return _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_setzero_si128())); }
+  template <> inline unsigned zero_units<2>(__m128i v)
+    { return _mm_movemask_epi8(_mm_cmpeq_epi16(v, _mm_setzero_si128())); }
+  template <> inline unsigned zero_units<4>(__m128i v)
+    { return _mm_movemask_epi8(_mm_cmpeq_epi32(v, _mm_setzero_si128())); }
+
+#endif
+
+  //  Returns the offset of the first zero unit of [p, p + n), or n if there is none.
+  //  Only the units up to the first zero unit need be readable, so p may point into a
+  //  null terminated string of unknown length. The vector loop reads aligned blocks of
+  //  16 bytes, which never cross a page boundary, and so never faults even when a block
+  //  extends past the terminator.
+  template <class T>
+  inline std::size_t find_null(const T* p, std::size_t n)
+  {
+    std::size_t i = 0;
+#if defined(BOOST_INTEROP_SSE2) && !defined(BOOST_INTEROP_NO_OVERREAD)
+    BOOST_STATIC_ASSERT(16 % sizeof(T) == 0);
+    std::size_t offset = reinterpret_cast<std::size_t>(p) & 15u;
+    if (n && offset % sizeof(T) == 0)
+    {
+      const __m128i* block = reinterpret_cast<const __m128i*>(
+        reinterpret_cast<const char*>(p) - offset);
+      //  ignore the bytes of the first block that precede p
+      unsigned mask = zero_units<sizeof(T)>(_mm_load_si128(block)) >> offset;
+      if (mask)
+        return (std::min)(count_trailing_zeros(mask) / sizeof(T), n);
+      for (i = (16 - offset) / sizeof(T); i < n; i += 16 / sizeof(T))
+      {
+        mask = zero_units<sizeof(T)>(_mm_load_si128(++block));
+        if (mask)
+          return (std::min)(i + count_trailing_zeros(mask) / sizeof(T), n);
+      }
+      return n;
+    }
+#endif
+    for (; i < n && p[i] != T(); ++i) {}
+    return i;
+  }
+
+//-------------------------------  UTF-8 validation  -----------------------------------//
+
+  //  Returns the offset of the first byte of the first sequence in [p + i, p + n) that
+  //  is invalid UTF-8, or is truncated by the end of the range, or n if there is none.
+  //  i must be at a sequence boundary. Rejects overlong forms, surrogates, and code
+  //  points beyond U+10FFFF.
+  inline std::size_t validate_utf8_scalar(const char* p, std::size_t i, std::size_t n)
+  {
+    const unsigned char* u = reinterpret_cast<const unsigned char*>(p);
+    while (i < n)
+    {
+      unsigned char c = u[i];
+      if (c < 0x80u)
+      {
+        i += ascii_prefix(p + i, n - i);
+        continue;
+      }
+      if (c < 0xC2u)  // continuation byte, or overlong two byte lead
+        return i;
+      if (c < 0xE0u)
+      {
+        if (i + 1 >= n || (u[i+1] & 0xC0u) != 0x80u)
+          return i;
+        i += 2;
+      }
+      else if (c < 0xF0u)
+      {
+        if (i + 2 >= n || (u[i+1] & 0xC0u) != 0x80u || (u[i+2] & 0xC0u) != 0x80u
+          || (c == 0xE0u && u[i+1] < 0xA0u)     // overlong
+          || (c == 0xEDu && u[i+1] >= 0xA0u))   // surrogate
+          return i;
+        i += 3;
+      }
+      else if (c < 0xF5u)
+      {
+        if (i + 3 >= n || (u[i+1] & 0xC0u) != 0x80u || (u[i+2] & 0xC0u) != 0x80u
+          || (u[i+3] & 0xC0u) != 0x80u
+          || (c == 0xF0u && u[i+1] < 0x90u)     // overlong
+          || (c == 0xF4u && u[i+1] >= 0x90u))   // beyond U+10FFFF
+          return i;
+        i += 4;
+      }
+      else
+        return i;
+    }
+    return n;
+  }
+
+#if defined(BOOST_INTEROP_SSSE3) || defined(BOOST_INTEROP_AVX2)
+
+  //  The vectorized validator is the lookup algorithm of John Keiser and Daniel Lemire,
+  //  "Validating UTF-8 In Less Than One Instruction Per Byte", Software: Practice and
+  //  Experience 51(5), 2021. Three 16 entry tables, indexed by the high and low nibbles
+  //  of the previous byte and the high nibble of the current byte, classify every pair
+  //  of adjacent bytes; the AND of the three lookups is non-zero only for an invalid
+  //  pair. Missing or excess third and fourth bytes are found by comparing the pair
+  //  classification with the bytes two and three positions back.
+
+  namespace utf8_lookup
+  {
+    const char too_short = 1 << 0;   // 11______ 0_______
+    const char too_long = 1 << 1;    // 0_______ 10______
+    const char overlong_3 = 1 << 2;  // 11100000 100_____
+    const char too_large = 1 << 3;   // 11110100 1001____ and above
+    const char surrogate = 1 << 4;   // 11101101 101_____
+    const char overlong_2 = 1 << 5;  // 1100000_ 10______
+    const char too_large_1000 = 1 << 6;  // 11110101 1000____ and above
+    const char overlong_4 = 1 << 6;  // 11110000 1000____
+    const char two_conts = static_cast<char>(1 << 7);  // 10______ 10______
+    const char carry = too_short | too_long | two_conts;
+  }
+
+  //  Checker supplies the vector operations; see utf8_checker_128 and utf8_checker_256.
+  //  Returns a block-aligned offset b such that no error was found before b, and either
+  //  the block at b contains an error or fewer than a full block remains.
+  template <class Checker>
+  std::size_t validate_utf8_blocks(const char* p, std::size_t n)
+  {
+    using namespace utf8_lookup;
+    typedef typename Checker::vector vector;
+
+    const vector byte_1_high = Checker::table(
+      too_long, too_long, too_long, too_long, too_long, too_long, too_long, too_long,
+      two_conts, two_conts, two_conts, two_conts,
+      too_short | overlong_2,
+      too_short,
+      too_short | overlong_3 | surrogate,
+      too_short | too_large | too_large_1000 | overlong_4);
+    const vector byte_1_low = Checker::table(
+      carry | overlong_3 | overlong_2 | overlong_4,
+      carry | overlong_2,
+      carry,
+      carry,
+      carry | too_large,
+      carry | too_large | too_large_1000,
+      carry | too_large | too_large_1000,
+      carry | too_large | too_large_1000,
+      carry | too_large | too_large_1000,
+      carry | too_large | too_large_1000,
+      carry | too_large | too_large_1000,
+      carry | too_large | too_large_1000,
+      carry | too_large | too_large_1000,
+      carry | too_large | too_large_1000 | surrogate,
+      carry | too_large | too_large_1000,
+      carry | too_large | too_large_1000);
+    const vector byte_2_high = Checker::table(
+      too_short, too_short, too_short, too_short,
+      too_short, too_short, too_short, too_short,
+      too_long | overlong_2 | two_conts | overlong_3 | too_large_1000 | overlong_4,
+      too_long | overlong_2 | two_conts | overlong_3 | too_large,
+      too_long | overlong_2 | two_conts | surrogate | too_large,
+      too_long | overlong_2 | two_conts | surrogate | too_large,
+      too_short, too_short, too_short, too_short);
+
+    vector prev_input = Checker::zero();
+    vector prev_incomplete = Checker::zero();
+    std::size_t i = 0;
+    for (; i + Checker::size <= n; i += Checker::size)
+    {
+      vector input = Checker::load(p + i);
+      vector error;
+      if (Checker::is_ascii(input))
+        error = prev_incomplete;
+      else
+      {
+        vector prev1 = Checker::template prev<1>(input, prev_input);
+        vector special = Checker::and_(
+          Checker::and_(Checker::lookup(byte_1_high, Checker::high_nibble(prev1)),
+                        Checker::lookup(byte_1_low, Checker::low_nibble(prev1))),
+          Checker::lookup(byte_2_high, Checker::high_nibble(input)));
+        vector third = Checker::subs(Checker::template prev<2>(input, prev_input),
+          Checker::splat(static_cast<char>(0xE0u - 0x80u)));
+        vector fourth = Checker::subs(Checker::template prev<3>(input, prev_input),
+          Checker::splat(static_cast<char>(0xF0u - 0x80u)));
+        vector must_be_continuation = Checker::and_(Checker::or_(third, fourth),
+          Checker::splat(static_cast<char>(0x80u)));
+        error = Checker::xor_(must_be_continuation, special);
+        prev_incomplete = Checker::subs(input, Checker::incomplete_limits());
+      }
+      if (Checker::any(error))
+        break;
+      prev_input = input;
+    }
+    return i;
+  }
+
+#endif
+
+#ifdef BOOST_INTEROP_SSSE3
+
+  struct utf8_checker_128
+  {
+    typedef __m128i vector;
+    BOOST_STATIC_CONSTANT(std::size_t, size = 16);
+
+    static vector load(const char* p)
+      { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+    static vector zero() { return _mm_setzero_si128(); }
+    static vector splat(char c) { return _mm_set1_epi8(c); }
+    static vector table(char t0, char t1, char t2, char t3, char t4, char t5,
+      char t6, char t7, char t8, char t9, char t10, char t11, char t12, char t13,
+      char t14, char t15)
+    {
+      return _mm_setr_epi8(t0, t1, t2, t3, t4, t5, t6, t7, t8, t9, t10, t11, t12, t13,
+        t14, t15);
+    }
+    static vector incomplete_limits()
+    {
+      return _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        static_cast<char>(0xF0u - 1), static_cast<char>(0xE0u - 1),
+        static_cast<char>(0xC0u - 1));
+    }
+    static vector lookup(vector table, vector index)
+      { return _mm_shuffle_epi8(table, index); }
+    static vector high_nibble(vector v)
+      { return _mm_and_si128(_mm_srli_epi16(v, 4), _mm_set1_epi8(0x0F)); }
+    static vector low_nibble(vector v) { return _mm_and_si128(v, _mm_set1_epi8(0x0F)); }
+    template <int N> static vector prev(vector input, vector prev_input)
+      { return _mm_alignr_epi8(input, prev_input, 16 - N); }
+    static vector and_(vector a, vector b) { return _mm_and_si128(a, b); }
+    static vector or_(vector a, vector b) { return _mm_or_si128(a, b); }
+    static vector xor_(vector a, vector b) { return _mm_xor_si128(a, b); }
+    static vector subs(vector a, vector b) { return _mm_subs_epu8(a, b); }
+    static bool is_ascii(vector v) { return _mm_movemask_epi8(v) == 0; }
+    static bool any(vector v)
+      { return _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_setzero_si128())) != 0xFFFF; }
+  };
+
+#endif
+
+#ifdef BOOST_INTEROP_AVX2
+
+  struct utf8_checker_256
+  {
+    typedef __m256i vector;
+    BOOST_STATIC_CONSTANT(std::size_t, size = 32);
+
+    static vector load(const char* p)
+      { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+    static vector zero() { return _mm256_setzero_si256(); }
+    static vector splat(char c) { return _mm256_set1_epi8(c); }
+    static vector table(char t0, char t1, char t2, char t3, char t4, char t5,
+      char t6, char t7, char t8, char t9, char t10, char t11, char t12, char t13,
+      char t14, char t15)
+    {
+      return _mm256_setr_epi8(t0, t1, t2, t3, t4, t5, t6, t7, t8, t9, t10, t11, t12,
+        t13, t14, t15, t0, t1, t2, t3, t4, t5, t6, t7, t8, t9, t10, t11, t12, t13, t14,
+        t15);
+    }
+    static vector incomplete_limits()
+    {
+      return _mm256_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        static_cast<char>(0xF0u - 1), static_cast<char>(0xE0u - 1),
+        static_cast<char>(0xC0u - 1));
+    }
+    static vector lookup(vector table, vector index)
+      { return _mm256_shuffle_epi8(table, index); }
+    static vector high_nibble(vector v)
+      { return _mm256_and_si256(_mm256_srli_epi16(v, 4), _mm256_set1_epi8(0x0F)); }
+    static vector low_nibble(vector v)
+      { return _mm256_and_si256(v, _mm256_set1_epi8(0x0F)); }
+    template <int N> static vector prev(vector input, vector prev_input)
+    {
+      return _mm256_alignr_epi8(input,
+        _mm256_permute2x128_si256(prev_input, input, 0x21), 16 - N);
+    }
+    static vector and_(vector a, vector b) { return _mm256_and_si256(a, b); }
+    static vector or_(vector a, vector b) { return _mm256_or_si256(a, b); }
+    static vector xor_(vector a, vector b) { return _mm256_xor_si256(a, b); }
+    static vector subs(vector a, vector b) { return _mm256_subs_epu8(a, b); }
+    static bool is_ascii(vector v) { return _mm256_movemask_epi8(v) == 0; }
+    static bool any(vector v) { return !_mm256_testz_si256(v, v); }
+  };
+
+#endif
+
+  //  Returns the offset of the first byte of the first invalid or truncated sequence in
+  //  [p, p + n), or n if the whole range is valid UTF-8.
+  inline std::size_t validate_utf8(const char* p, std::size_t n)
+  {
+    std::size_t i = 0;
+#if defined(BOOST_INTEROP_AVX2)
+    i = validate_utf8_blocks<utf8_checker_256>(p, n);
+#elif defined(BOOST_INTEROP_SSSE3)
+    i = validate_utf8_blocks<utf8_checker_128>(p, n);
+#endif
+    //  the sequence containing byte i - 1 may be truncated or continue past i, so
+    //  restart the scalar check at its lead byte; everything before that was valid
+    for (std::size_t k = 1; k <= 4 && k <= i; ++k)
+    {
+      if ((static_cast<unsigned char>(p[i - k]) & 0xC0u) != 0x80u)
+      {
+        i -= k;
+        break;
+      }
+    }
+    return validate_utf8_scalar(p, i, n);
+  }
+
+//-------------------------  UTF-16 and UTF-32 validation  -----------------------------//
+
+  //  Returns the offset of the first unpaired surrogate in [p, p + n), or n if there is
+  //  none. A high surrogate in the last unit is unpaired. The vector loop skips blocks
+  //  without surrogates; a block with any goes through the scalar check.
+  template <class T>
+  std::size_t validate_utf16(const T* p, std::size_t n)
+  {
+    std::size_t i = 0;
+    while (i < n)
+    {
+#ifdef BOOST_INTEROP_SSE2
+      for (; sizeof(T) == 2 && i + 8 <= n; i += 8)
+      {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi16(
+              _mm_and_si128(v, _mm_set1_epi16(-0x800)),
+              _mm_set1_epi16(-0x2800))))  // 0xD800
+          break;
+      }
+      if (i == n)
+        break;
+#endif
+      ::boost::uint32_t u = static_cast< ::boost::uint16_t>(p[i]);
+      if ((u & 0xF800u) == 0xD800u)
+      {
+        if (u >= 0xDC00u || i + 1 == n
+          || (static_cast< ::boost::uint16_t>(p[i + 1]) & 0xFC00u) != 0xDC00u)
+          return i;
+        ++i;
+      }
+      ++i;
+    }
+    return n;
+  }
+
+  //  Returns the offset of the first unit of [p, p + n) that is a surrogate or above
+  //  U+10FFFF, or n if there is none
+  template <class T>
+  std::size_t validate_utf32(const T* p, std::size_t n)
+  {
+    std::size_t i = 0;
+#ifdef BOOST_INTEROP_SSE2
+    for (; sizeof(T) == 4 && i + 4 <= n; i += 4)
+    {
+      __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+      //  units of 0x80000000 and above compare as negative
+      __m128i bad = _mm_or_si128(
+        _mm_or_si128(_mm_cmpgt_epi32(v, _mm_set1_epi32(0x10FFFF)),
+          _mm_cmplt_epi32(v, _mm_setzero_si128())),
+        _mm_cmpeq_epi32(_mm_and_si128(v, _mm_set1_epi32(-0x800)),
+          _mm_set1_epi32(0xD800)));
+      if (_mm_movemask_epi8(bad))
+        break;
+    }
+#endif
+    for (; i < n; ++i)
+    {
+      ::boost::uint32_t u = static_cast< ::boost::uint32_t>(p[i]);
+      if (u > 0x10FFFFu || (u & 0xFFFFF800u) == 0xD800u)
+        return i;
+    }
+    return n;
+  }
+
+//----------------------------  single byte codepages  ---------------------------------//
+
+  //  The tables are those of narrow_codec<Table> (see codepage_tables.hpp), which are
+  //  always ASCII compatible, so bytes below 0x80 pass straight through and only the
+  //  upper half of the codepage needs a lookup.
+
+#ifdef BOOST_INTEROP_AVX2
+
+  //  store 8 code points, one per 32 bit lane, as ToSize units
+  template <std::size_t ToSize> struct dword_store;
+
+  template <> struct dword_store<2>
+  {
+    static void store(void* out, __m256i v)
+    {
+      __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi32(v, v), 0x08);
+      _mm_storeu_si128(static_cast<__m128i*>(out), _mm256_castsi256_si128(packed));
+    }
+  };
+
+  template <> struct dword_store<4>
+  {
+    static void store(void* out, __m256i v)
+      { _mm256_storeu_si256(static_cast<__m256i*>(out), v); }
+  };
+
+  //  look up 8 bytes; each gather reads entries index - 1 and index as one 32 bit
+  //  value, which stays inside the table because only bytes 0x80 and above are
+  //  gathered, and lanes below 0x80 keep their index
+  template <std::size_t ToSize>
+  inline void decode_codepage_8(const char* in, void* out, const int* table)
+  {
+    __m256i index = _mm256_cvtepu8_epi32(
+      _mm_loadl_epi64(reinterpret_cast<const __m128i*>(in)));
+    __m256i upper = _mm256_cmpgt_epi32(index, _mm256_set1_epi32(0x7F));
+    __m256i v = _mm256_mask_i32gather_epi32(_mm256_slli_epi32(index, 16), table,
+      _mm256_sub_epi32(index, _mm256_set1_epi32(1)), upper, 2);
+    dword_store<ToSize>::store(out, _mm256_srli_epi32(v, 16));
+  }
+
+#endif
+
+  //  Converts the n bytes at in to n units at out, table being the to_utf16 table of
+  //  the codepage. T is a 16 or 32 bit code unit type. Blocks of 16 ASCII bytes are
+  //  widened without lookups; with AVX2 other blocks are looked up by gathers.
+  template <class T>
+  void decode_codepage(const char* in, T* out, std::size_t n,
+    const ::boost::char16* table)
+  {
+    BOOST_STATIC_ASSERT(sizeof(T) == 2 || sizeof(T) == 4);
+    std::size_t i = 0;
+#ifdef BOOST_INTEROP_SSE2
+    for (; i + 16 <= n; i += 16)
+    {
+      __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+      if (_mm_movemask_epi8(v) == 0)
+        ascii_store<sizeof(T)>::store(out + i, v);
+      else
+      {
+# ifdef BOOST_INTEROP_AVX2
+        const int* base = reinterpret_cast<const int*>(table);
+        decode_codepage_8<sizeof(T)>(in + i, out + i, base);
+        decode_codepage_8<sizeof(T)>(in + i + 8, out + i + 8, base);
+# else
+        for (std::size_t j = i; j < i + 16; ++j)
+          out[j] = static_cast<T>(table[static_cast<unsigned char>(in[j])]);
+# endif
+      }
+    }
+#endif
+    for (; i < n; ++i)
+      out[i] = static_cast<T>(table[static_cast<unsigned char>(in[i])]);
+  }
+
+#ifdef BOOST_INTEROP_SSE2
+
+  //  load 16 units and test them; on success v holds them packed as 16 bytes
+  template <std::size_t FromSize> struct latin1_load;
+
+  template <> struct latin1_load<2>
+  {
+    static bool load(const void* in, __m128i& v)
+    {
+      const __m128i* p = static_cast<const __m128i*>(in);
+      __m128i v0 = _mm_loadu_si128(p);
+      __m128i v1 = _mm_loadu_si128(p + 1);
+      __m128i high = _mm_and_si128(_mm_or_si128(v0, v1), _mm_set1_epi16(-0x100));
+      if (_mm_movemask_epi8(_mm_cmpeq_epi8(high, _mm_setzero_si128())) != 0xFFFF)
+        return false;
+      v = _mm_packus_epi16(v0, v1);
+      return true;
+    }
+  };
+
+  template <> struct latin1_load<4>
+  {
+    static bool load(const void* in, __m128i& v)
+    {
+      const __m128i* p = static_cast<const __m128i*>(in);
+      __m128i v0 = _mm_loadu_si128(p);
+      __m128i v1 = _mm_loadu_si128(p + 1);
+      __m128i v2 = _mm_loadu_si128(p + 2);
+      __m128i v3 = _mm_loadu_si128(p + 3);
+      __m128i high = _mm_and_si128(
+        _mm_or_si128(_mm_or_si128(v0, v1), _mm_or_si128(v2, v3)),
+        _mm_set1_epi32(-0x100));
+      if (_mm_movemask_epi8(_mm_cmpeq_epi8(high, _mm_setzero_si128())) != 0xFFFF)
+        return false;
+      v = _mm_packus_epi16(_mm_packs_epi32(v0, v1), _mm_packs_epi32(v2, v3));
+      return true;
+    }
+  };
+
+  //  latin1_encoder<FromSize>::run(in, out, n) converts whole blocks of 16 units while
+  //  every unit in the block is below U+0100, returning the number converted. With
+  //  SSSE3 the upper half is looked up in the 128 byte to_char slice for U+0080 to
+  //  U+00FF held as eight 16 byte shuffle tables: adding 0x70 with saturation leaves
+  //  bit 7 of the index clear only in the lanes the current table covers.
+  template <std::size_t FromSize>
+  class latin1_encoder
+  {
+  public:
+    explicit latin1_encoder(const unsigned char* latin1)
+    {
+# ifdef BOOST_INTEROP_SSSE3
+      for (int k = 0; k < 8; ++k)
+        m_tables[k] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(latin1 + 16 * k));
+# else
+      m_latin1 = latin1;
+# endif
+    }
+
+    std::size_t run(const void* in, char* out, std::size_t n) const
+    {
+      const char* src = static_cast<const char*>(in);
+      std::size_t i = 0;
+      __m128i v;
+      for (; i + 16 <= n && latin1_load<FromSize>::load(src, v); i += 16)
+      {
+        if (_mm_movemask_epi8(v) == 0)
+          _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), v);
+        else
+        {
+# ifdef BOOST_INTEROP_SSSE3
+          __m128i index = _mm_sub_epi8(v, _mm_set1_epi8(static_cast<char>(0x80u)));
+          __m128i result = _mm_andnot_si128(
+            _mm_cmplt_epi8(v, _mm_setzero_si128()), v);  // the ASCII lanes
+          for (int k = 0; k < 8; ++k)
+          {
+            result = _mm_or_si128(result, _mm_shuffle_epi8(m_tables[k],
+              _mm_adds_epu8(index, _mm_set1_epi8(0x70))));
+            index = _mm_sub_epi8(index, _mm_set1_epi8(16));
+          }
+          _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), result);
+# else
+          unsigned char bytes[16];
+          _mm_storeu_si128(reinterpret_cast<__m128i*>(bytes), v);
+          for (int j = 0; j < 16; ++j)
+            out[i + j] = static_cast<char>(bytes[j] < 0x80u
+              ? bytes[j] : m_latin1[bytes[j] - 0x80u]);
+# endif
+        }
+        src += 16 * FromSize;
+      }
+      return i;
+    }
+
+  private:
+# ifdef BOOST_INTEROP_SSSE3
+    __m128i m_tables[8];
+# else
+    const unsigned char* m_latin1;
+# endif
+  };
+
+#endif  // BOOST_INTEROP_SSE2
+
+  //  Converts the longest prefix of [in, in + n) that holds neither surrogates nor
+  //  code points beyond the BMP to out, returning its length; those are left to the
+  //  caller. to_char and slice_index are the codepage's tables. Blocks of 16 units
+  //  below U+0100 are converted by latin1_encoder, and others a unit at a time.
+  template <class T>
+  std::size_t encode_codepage(const T* in, char* out, std::size_t n,
+    const unsigned char* to_char, const ::boost::uint8_t* slice_index)
+  {
+    BOOST_STATIC_ASSERT(sizeof(T) == 2 || sizeof(T) == 4);
+#ifdef BOOST_INTEROP_SSE2
+    const latin1_encoder<sizeof(T)> latin1(to_char + (slice_index[1] << 7));
+#endif
+    std::size_t i = 0;
+    while (i != n)
+    {
+#ifdef BOOST_INTEROP_SSE2
+      i += latin1.run(in + i, out + i, n - i);
+#endif
+      for (std::size_t block_end = (std::min)(n, i + 16); i != block_end; ++i)
+      {
+        ::boost::uint32_t u = static_cast< ::boost::uint32_t>(in[i]);
+        if (u - 0xD800u < 0x800u || u > 0xFFFFu)
+          return i;
+        out[i] = static_cast<char>(to_char[(slice_index[u >> 7] << 7) | (u & 0x7Fu)]);
+      }
+    }
+    return n;
+  }
+
+//--------------------------------  output lengths  ------------------------------------//
+
+  //  Each function returns the number of units that converting the valid input
+  //  [p, p + n) produces. They do not validate; for invalid input the result is only an
+  //  estimate. Counts are accumulated from per-lane comparison masks. The vector loops
+  //  only run when T has the width of the encoding's code unit.
+
+#ifdef BOOST_INTEROP_SSE2
+  //  the sum of the 16 unsigned bytes of v
+  inline std::size_t sum_bytes(__m128i v)
+  {
+    __m128i sums = _mm_sad_epu8(v, _mm_setzero_si128());  // two 64 bit sums
+    return static_cast<std::size_t>(_mm_cvtsi128_si32(sums))
+      + static_cast<std::size_t>(_mm_cvtsi128_si32(_mm_srli_si128(sums, 8)));
+  }
+#endif
+
+#ifdef BOOST_INTEROP_AVX2
+  inline std::size_t sum_bytes(__m256i v)
+  {
+    __m256i sums = _mm256_sad_epu8(v, _mm256_setzero_si256());  // four 64 bit sums
+    __m128i pairs = _mm_add_epi32(_mm256_castsi256_si128(sums),
+      _mm256_extracti128_si256(sums, 1));
+    return static_cast<std::size_t>(_mm_cvtsi128_si32(pairs))
+      + static_cast<std::size_t>(_mm_cvtsi128_si32(_mm_srli_si128(pairs, 8)));
+  }
+#endif
+
+  //  UTF-8 to UTF-32: one code point per byte that is not a continuation byte
+  //  UTF-8 to UTF-16: as for UTF-32, plus one for each four byte lead (0xF0 and above)
+  //
+  //  The comparison masks, -1 per matching byte, are subtracted from per-byte counters,
+  //  which are summed every 255 blocks, before any can overflow.
+  template <bool CountFourByteLeads>
+  std::size_t length_from_utf8(const char* p, std::size_t n)
+  {
+    std::size_t i = 0;
+    std::size_t count = 0;
+#if defined(BOOST_INTEROP_AVX2)
+    const __m256i continuation_max = _mm256_set1_epi8(-65);  // 0xBF
+    const __m256i four_byte_min = _mm256_set1_epi8(-17);     // 0xEF
+    while (i + 32 <= n)
+    {
+      std::size_t blocks = (std::min)((n - i) / 32, static_cast<std::size_t>(255));
+      __m256i starts = _mm256_setzero_si256();
+      __m256i fours = _mm256_setzero_si256();
+      for (; blocks; --blocks, i += 32)
+      {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+        starts = _mm256_sub_epi8(starts, _mm256_cmpgt_epi8(v, continuation_max));
+        if (CountFourByteLeads)
+          fours = _mm256_sub_epi8(fours, _mm256_and_si256(
+            _mm256_cmpgt_epi8(v, four_byte_min),
+            _mm256_cmpgt_epi8(_mm256_setzero_si256(), v)));
+      }
+      count += sum_bytes(starts);
+      if (CountFourByteLeads)
+        count += sum_bytes(fours);
+    }
+#elif defined(BOOST_INTEROP_SSE2)
+    const __m128i continuation_max = _mm_set1_epi8(-65);
+    const __m128i four_byte_min = _mm_set1_epi8(-17);
+    while (i + 16 <= n)
+    {
+      std::size_t blocks = (std::min)((n - i) / 16, static_cast<std::size_t>(255));
+      __m128i starts = _mm_setzero_si128();
+      __m128i fours = _mm_setzero_si128();
+      for (; blocks; --blocks, i += 16)
+      {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        starts = _mm_sub_epi8(starts, _mm_cmpgt_epi8(v, continuation_max));
+        if (CountFourByteLeads)
+          fours = _mm_sub_epi8(fours, _mm_and_si128(_mm_cmpgt_epi8(v, four_byte_min),
+            _mm_cmplt_epi8(v, _mm_setzero_si128())));
+      }
+      count += sum_bytes(starts);
+      if (CountFourByteLeads)
+        count += sum_bytes(fours);
+    }
+#endif
+    for (; i < n; ++i)
+    {
+      unsigned char c = static_cast<unsigned char>(p[i]);
+      count += (c & 0xC0u) != 0x80u;
+      if (CountFourByteLeads)
+        count += c >= 0xF0u;
+    }
+    return count;
+  }
+
+  //  UTF-16 to UTF-8: 1 unit below U+0080, 2 below U+0800, 3 otherwise, and 2 for each
+  //  half of a surrogate pair
+  template <class T>
+  std::size_t utf8_length_from_utf16(const T* p, std::size_t n)
+  {
+    std::size_t i = 0;
+    std::size_t count = 0;
+#ifdef BOOST_INTEROP_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    for (; sizeof(T) == 2 && i + 8 <= n; i += 8)
+    {
+      __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+      //  each mask has two bits per unit
+      unsigned ascii = static_cast<unsigned>(_mm_movemask_epi8(
+        _mm_cmpeq_epi16(_mm_and_si128(v, _mm_set1_epi16(-0x80)), zero)));
+      unsigned two_byte = static_cast<unsigned>(_mm_movemask_epi8(
+        _mm_cmpeq_epi16(_mm_and_si128(v, _mm_set1_epi16(-0x800)), zero)));
+      unsigned surrogate = static_cast<unsigned>(_mm_movemask_epi8(
+        _mm_cmpeq_epi16(_mm_and_si128(v, _mm_set1_epi16(-0x800)),
+          _mm_set1_epi16(-0x2800))));  // 0xD800
+      count += 24 - (count_ones(ascii) + count_ones(two_byte)
+        + count_ones(surrogate)) / 2;
+    }
+#endif
+    for (; i < n; ++i)
+    {
+      ::boost::uint32_t u = static_cast< ::boost::uint16_t>(p[i]);
+      count += u < 0x80u ? 1 : u < 0x800u ? 2 : (u & 0xF800u) == 0xD800u ? 2 : 3;
+    }
+    return count;
+  }
+
+  //  UTF-16 to UTF-32: one code point per unit that is not a low surrogate
+  template <class T>
+  std::size_t utf32_length_from_utf16(const T* p, std::size_t n)
+  {
+    std::size_t i = 0;
+    std::size_t count = 0;
+#ifdef BOOST_INTEROP_AVX2
+    for (; sizeof(T) == 2 && i + 16 <= n; i += 16)
+    {
+      __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+      unsigned low = static_cast<unsigned>(_mm256_movemask_epi8(
+        _mm256_cmpeq_epi16(_mm256_and_si256(v, _mm256_set1_epi16(-0x400)),
+          _mm256_set1_epi16(-0x2400))));  // 0xDC00
+      count += 16 - count_ones(low) / 2;
+    }
+#endif
+#ifdef BOOST_INTEROP_SSE2
+    for (; sizeof(T) == 2 && i + 8 <= n; i += 8)
+    {
+      __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+      unsigned low = static_cast<unsigned>(_mm_movemask_epi8(
+        _mm_cmpeq_epi16(_mm_and_si128(v, _mm_set1_epi16(-0x400)),
+          _mm_set1_epi16(-0x2400))));  // 0xDC00
+      count += 8 - count_ones(low) / 2;
+    }
+#endif
+    for (; i < n; ++i)
+      count += (static_cast< ::boost::uint16_t>(p[i]) & 0xFC00u) != 0xDC00u;
+    return count;
+  }
+
+  //  UTF-32 to UTF-8: 1 unit, plus one more at each of U+0080, U+0800, and U+10000
+  template <class T>
+  std::size_t utf8_length_from_utf32(const T* p, std::size_t n)
+  {
+    std::size_t i = 0;
+    std::size_t count = n;
+#ifdef BOOST_INTEROP_SSE2
+    for (; sizeof(T) == 4 && i + 4 <= n; i += 4)
+    {
+      __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+      //  each mask has four bits per unit
+      unsigned extra = count_ones(static_cast<unsigned>(_mm_movemask_epi8(
+          _mm_cmpgt_epi32(v, _mm_set1_epi32(0x7F)))))
+        + count_ones(static_cast<unsigned>(_mm_movemask_epi8(
+          _mm_cmpgt_epi32(v, _mm_set1_epi32(0x7FF)))))
+        + count_ones(static_cast<unsigned>(_mm_movemask_epi8(
+          _mm_cmpgt_epi32(v, _mm_set1_epi32(0xFFFF)))));
+      count += extra / 4;
+    }
+#endif
+    for (; i < n; ++i)
+    {
+      ::boost::uint32_t u = static_cast< ::boost::uint32_t>(p[i]);
+      count += (u >= 0x80u) + (u >= 0x800u) + (u >= 0x10000u);
+    }
+    return count;
+  }
+
+  //  UTF-32 to UTF-16: one unit, plus one for each code point beyond the BMP
+  template <class T>
+  std::size_t utf16_length_from_utf32(const T* p, std::size_t n)
+  {
+    std::size_t i = 0;
+    std::size_t count = n;
+#ifdef BOOST_INTEROP_SSE2
+    for (; sizeof(T) == 4 && i + 4 <= n; i += 4)
+    {
+      __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+      count += count_ones(static_cast<unsigned>(_mm_movemask_epi8(
+        _mm_cmpgt_epi32(v, _mm_set1_epi32(0xFFFF))))) / 4;
+    }
+#endif
+    for (; i < n; ++i)
+      count += static_cast< ::boost::uint32_t>(p[i]) >= 0x10000u;
+    return count;
+  }
+
+//---------------------------  code point checkpoints  ---------------------------------//
+
+  //  Each function appends to out the offset of every stride'th code point of the
+  //  valid input [p, p + n), starting with code point 0, and returns the number of code
+  //  points. A code point starts at each unit that is not a continuation: a UTF-8 byte
+  //  outside 0x80 to 0xBF, or a UTF-16 unit that is not a low surrogate. Blocks of
+  //  units are reduced to a mask of the starts, whose popcount is added to the count;
+  //  a block is only searched bit by bit when a checkpoint falls inside it.
+
+  //  record the checkpoints among the starts in mask, the block at offset i
+  template <class OutputIterator>
+  inline void checkpoint_block(unsigned mask, std::size_t i, std::size_t stride,
+    std::size_t& count, std::size_t& next, OutputIterator& out)
+  {
+    std::size_t starts = count_ones(mask);
+    for (; next - count < starts; next += stride)
+    {
+      unsigned m = mask;
+      for (std::size_t k = next - count; k; --k)
+        m &= m - 1;  // clear the lowest set bit
+      *out++ = i + count_trailing_zeros(m);
+    }
+    count += starts;
+  }
+
+  template <class OutputIterator>
+  std::size_t utf8_checkpoints(const char* p, std::size_t n, std::size_t stride,
+    OutputIterator out)
+  {
+    std::size_t i = 0;
+    std::size_t count = 0;
+    std::size_t next = 0;  // the next code point to record
+#if defined(BOOST_INTEROP_AVX2)
+    const __m256i continuation_max = _mm256_set1_epi8(-65);  // 0xBF
+    for (; i + 32 <= n; i += 32)
+    {
+      __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+      checkpoint_block(static_cast<unsigned>(_mm256_movemask_epi8(
+        _mm256_cmpgt_epi8(v, continuation_max))), i, stride, count, next, out);
+    }
+#elif defined(BOOST_INTEROP_SSE2)
+    const __m128i continuation_max = _mm_set1_epi8(-65);
+    for (; i + 16 <= n; i += 16)
+    {
+      __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+      checkpoint_block(static_cast<unsigned>(_mm_movemask_epi8(
+        _mm_cmpgt_epi8(v, continuation_max))), i, stride, count, next, out);
+    }
+#endif
+    for (; i < n; ++i)
+    {
+      if ((static_cast<unsigned char>(p[i]) & 0xC0u) == 0x80u)
+        continue;
+      if (count++ == next)
+      {
+        *out++ = i;
+        next += stride;
+      }
+    }
+    return count;
+  }
+
+  template <class T, class OutputIterator>
+  std::size_t utf16_checkpoints(const T* p, std::size_t n, std::size_t stride,
+    OutputIterator out)
+  {
+    std::size_t i = 0;
+    std::size_t count = 0;
+    std::size_t next = 0;
+#ifdef BOOST_INTEROP_SSE2
+    const __m128i surrogate_bits = _mm_set1_epi16(-0x400);  // 0xFC00
+    const __m128i low_surrogate = _mm_set1_epi16(-0x2400);  // 0xDC00
+    for (; sizeof(T) == 2 && i + 16 <= n; i += 16)
+    {
+      __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+      __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i + 8));
+      //  pack the two 8 unit comparisons into one 16 bit mask
+      unsigned low = static_cast<unsigned>(_mm_movemask_epi8(_mm_packs_epi16(
+        _mm_cmpeq_epi16(_mm_and_si128(a, surrogate_bits), low_surrogate),
+        _mm_cmpeq_epi16(_mm_and_si128(b, surrogate_bits), low_surrogate))));
+      checkpoint_block(~low & 0xFFFFu, i, stride, count, next, out);
+    }
+#endif
+    for (; i < n; ++i)
+    {
+      if ((static_cast< ::boost::uint16_t>(p[i]) & 0xFC00u) == 0xDC00u)
+        continue;
+      if (count++ == next)
+      {
+        *out++ = i;
+        next += stride;
+      }
+    }
+    return count;
+  }
+
+} // namespace simd
+} // namespace detail
+} // namespace interop
+} // namespace boost
+
+#endif  // BOOST_INTEROP_SIMD_HPP
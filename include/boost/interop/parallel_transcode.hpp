@@ -0,0 +1,301 @@
+//  boost/interop/parallel_transcode.hpp  ----------------------------------------------//
+
+//  Copyright Beman Dawes 2012
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+//--------------------------------------------------------------------------------------//
+//                                                                                      //
+//  Multi-threaded conversion of large buffers.                                         //
+//                                                                                      //
+//  parallel_transcode<ToCodec, FromCodec>() splits the input into one chunk per        //
+//  thread at boundaries where no sequence is split: a UTF-8 split skips forward over   //
+//  continuation bytes, and a UTF-16 split never separates a surrogate pair. Each       //
+//  thread counts its chunk's output with converted_length(), the counts are            //
+//  prefix-summed, and each thread then converts its chunk directly into its own slot   //
+//  of the output.                                                                      //
+//                                                                                      //
+//  Inputs shorter than parallel_min_units per thread are converted on the calling      //
+//  thread, as is everything when BOOST_INTEROP_NO_THREADS is defined. Results,         //
+//  including the position of any invalid input, are the same as transcode()'s.        //
+//                                                                                      //
+//  Both codecs must be BlockCodecs (see string_interop.hpp).                           //
+//                                                                                      //
+//--------------------------------------------------------------------------------------//
+
+#if !defined(BOOST_INTEROP_PARALLEL_TRANSCODE_HPP)
+# define BOOST_INTEROP_PARALLEL_TRANSCODE_HPP
+
+#include <boost/interop/string_interop.hpp>
+#include <boost/interop/string_operators.hpp>
+#include <boost/interop/transcoder.hpp>
+#include <boost/static_assert.hpp>
+#include <cstddef>
+#include <vector>
+#ifndef BOOST_INTEROP_NO_THREADS
+# include <thread>
+#endif
+
+#include <boost/config/abi_prefix.hpp> // must be the last #include
+
+namespace boost
+{
+namespace interop
+{
+
+//  the smallest chunk, in input units, worth handing to a thread of its own
+const std::size_t parallel_min_units = 256 * 1024;
+
+namespace detail
+{
+  //  safe_split<Codec>::adjust(p, last) moves a split point p forward to the start of
+  //  a sequence. Single unit encodings need no adjustment.
+
+  template <class Codec>
+  struct safe_split
+  {
+    template <class T>
+    static const T* adjust(const T* p, const T*) { return p; }
+  };
+
+  template <>
+  struct safe_split<utf8>
+  {
+    static const char* adjust(const char* p, const char* last)
+    {
+      //  a valid sequence has at most three continuation bytes
+      for (int i = 0; i < 3 && p != last
+        && (static_cast<unsigned char>(*p) & 0xC0) == 0x80; ++i)
+        ++p;
+      return p;
+    }
+  };
+
+#ifndef BOOST_WINDOWS_API
+  //  in a table codeset any split is safe, and the UTF-8 adjustment merely moves it
+  template <>
+  struct safe_split<locale_narrow> : safe_split<utf8> {};
+#endif
+
+  template <class charT>
+  struct safe_split<generic_utf16<charT> >
+  {
+    static const charT* adjust(const charT* p, const charT* last)
+    {
+      if (p != last && *p >= 0xDC00u && *p <= 0xDFFFu)
+        ++p;
+      return p;
+    }
+  };
+
+  //  the chunks of a parallel conversion; chunk i is [bounds[i], bounds[i + 1]), and
+  //  converts to [offsets[i], offsets[i + 1]) of the output
+  template <class ToCodec, class FromCodec>
+  struct parallel_plan
+  {
+    typedef typename FromCodec::value_type  from_type;
+    typedef typename ToCodec::value_type    to_type;
+
+    std::vector<const from_type*>  bounds;
+    std::vector<std::size_t>       offsets;
+    std::vector<char>              converted;  // one element per chunk, so no races
+    to_type*                       out;
+
+    std::size_t chunks() const { return bounds.size() - 1; }
+
+    parallel_plan(const from_type* first, const from_type* last, std::size_t n)
+      : out(0)
+    {
+      std::size_t size = (last - first) / n;
+      bounds.push_back(first);
+      for (std::size_t i = 1; i < n; ++i)
+      {
+        const from_type* p = safe_split<FromCodec>::adjust(first + i * size, last);
+        if (p > bounds.back())
+          bounds.push_back(p);
+      }
+      bounds.push_back(last);
+      offsets.resize(bounds.size(), 0);
+      converted.resize(chunks(), 0);
+    }
+
+    void count(std::size_t i)
+    {
+      offsets[i + 1] = converted_length<ToCodec, FromCodec>(bounds[i],
+        bounds[i + 1] - bounds[i]);
+    }
+
+    //  the chunk fails unless it converts exactly into its slot
+    void convert(std::size_t i)
+    {
+      const from_type* first = bounds[i];
+      to_type* p = out + offsets[i];
+      to_type* const p_last = out + offsets[i + 1];
+      char32 cp = 0;
+      converted[i] = block_converter<ToCodec, FromCodec>::convert(first, bounds[i + 1],
+        p, p_last, cp) == block_ok && p == p_last;
+    }
+  };
+
+  template <class Plan>
+  struct count_chunk
+  {
+    Plan* plan;
+    void operator()(std::size_t i) const { plan->count(i); }
+  };
+
+  template <class Plan>
+  struct convert_chunk
+  {
+    Plan* plan;
+    void operator()(std::size_t i) const { plan->convert(i); }
+  };
+
+  //  calls f(i) for each i in [0, n), concurrently where threads allow
+  template <class Function>
+  void parallel_for(std::size_t n, Function f)
+  {
+#ifndef BOOST_INTEROP_NO_THREADS
+    std::vector<std::thread> threads;
+    threads.reserve(n);
+    std::size_t i = 1;
+    try
+    {
+      for (; i < n; ++i)
+        threads.push_back(std::thread(f, i));
+    }
+    catch (...) {}  // run whatever could not be started here
+    for (std::size_t j = i; j < n; ++j)
+      f(j);
+    f(0);
+    for (std::size_t j = 0; j < threads.size(); ++j)
+      threads[j].join();
+#else
+    for (std::size_t i = 0; i < n; ++i)
+      f(i);
+#endif
+  }
+
+  inline std::size_t parallel_chunks(std::size_t units, unsigned threads)
+  {
+#ifndef BOOST_INTEROP_NO_THREADS
+    if (threads == 0)
+      threads = std::thread::hardware_concurrency();
+    std::size_t n = units / parallel_min_units;
+    if (n > threads)
+      n = threads;
+    return n ? n : 1;
+#else
+    (void)units;
+    (void)threads;
+    return 1;
+#endif
+  }
+
+  //  counts the chunks of plan and returns the total output length
+  template <class Plan>
+  std::size_t parallel_count(Plan& plan)
+  {
+    count_chunk<Plan> f = {&plan};
+    parallel_for(plan.chunks(), f);
+    for (std::size_t i = 1; i < plan.offsets.size(); ++i)
+      plan.offsets[i] += plan.offsets[i - 1];
+    return plan.offsets.back();
+  }
+
+  //  converts the chunks of plan into out, and returns the first that failed or, if
+  //  none did, the number of chunks
+  template <class Plan>
+  std::size_t parallel_convert(Plan& plan, typename Plan::to_type* out)
+  {
+    plan.out = out;
+    convert_chunk<Plan> f = {&plan};
+    parallel_for(plan.chunks(), f);
+    std::size_t i = 0;
+    while (i < plan.chunks() && plan.converted[i])
+      ++i;
+    return i;
+  }
+
+}  // namespace detail
+
+//  Converts [first, last) into [out, out_last), with the same result as transcode().
+//  threads is the number of threads to use, or 0 for one per hardware thread.
+template <class ToCodec, class FromCodec>
+transcode_result parallel_transcode(const typename FromCodec::value_type* first,
+  const typename FromCodec::value_type* last, typename ToCodec::value_type* out,
+  typename ToCodec::value_type* out_last, unsigned threads = 0)
+{
+  BOOST_STATIC_ASSERT_MSG((detail::has_block_interface<ToCodec>::value
+    && detail::has_block_interface<FromCodec>::value),
+    "parallel_transcode requires BlockCodecs");
+
+  std::size_t n = detail::parallel_chunks(last - first, threads);
+  if (n > 1)
+  {
+    detail::parallel_plan<ToCodec, FromCodec> plan(first, last, n);
+    std::size_t total = detail::parallel_count(plan);
+    if (total <= static_cast<std::size_t>(out_last - out))
+    {
+      std::size_t failed = detail::parallel_convert(plan, out);
+      if (failed == plan.chunks())
+      {
+        transcode_result result = {static_cast<std::size_t>(last - first), total,
+          transcode_status::ok};
+        return result;
+      }
+
+      //  the chunks before the failed one converted; find where the failure is
+      transcode_result result = transcode<ToCodec, FromCodec>(plan.bounds[failed], last,
+        out + plan.offsets[failed], out_last);
+      result.consumed += plan.bounds[failed] - first;
+      result.written += plan.offsets[failed];
+      return result;
+    }
+  }
+  return transcode<ToCodec, FromCodec>(first, last, out, out_last);
+}
+
+//  Appends the conversion of [first, last) to s, sized exactly. Returns ok, or else
+//  invalid or incomplete_input, with s holding the conversion of the input before the
+//  error.
+template <class ToCodec, class FromCodec, class ToString>
+transcode_status::type parallel_transcode(const typename FromCodec::value_type* first,
+  const typename FromCodec::value_type* last, ToString& s, unsigned threads = 0)
+{
+  BOOST_STATIC_ASSERT_MSG((detail::has_block_interface<ToCodec>::value
+    && detail::has_block_interface<FromCodec>::value),
+    "parallel_transcode requires BlockCodecs");
+
+  std::size_t pos = s.size();
+  std::size_t n = detail::parallel_chunks(last - first, threads);
+  if (n > 1)
+  {
+    detail::parallel_plan<ToCodec, FromCodec> plan(first, last, n);
+    std::size_t total = detail::parallel_count(plan);
+    //  invalid input can count as no output; the transcoder below then reports it
+    if (total != 0)
+    {
+      detail::resize_for_overwrite(s, pos + total);
+      std::size_t failed = detail::parallel_convert(plan, &s[0] + pos);
+      if (failed == plan.chunks())
+        return transcode_status::ok;
+      s.resize(pos + plan.offsets[failed]);
+      first = plan.bounds[failed];
+    }
+  }
+
+  transcoder<ToCodec, FromCodec> converter;
+  transcode_status::type status = converter.feed(first, last, s);
+  if (status == transcode_status::ok)
+    status = converter.finish();
+  return status;
+}
+
+}  // namespace interop
+}  // namespace boost
+
+#include <boost/config/abi_suffix.hpp> // pops abi_prefix.hpp pragmas
+
+#endif  // BOOST_INTEROP_PARALLEL_TRANSCODE_HPP
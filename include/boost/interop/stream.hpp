@@ -10,14 +10,19 @@
 
 #include <boost/interop/cxx11_char_types.hpp>
 #include <boost/interop/string_interop.hpp>
+#include <boost/interop/transcoder.hpp>
 #include <boost/interop/detail/is_iterator.hpp>
 #include <boost/interop/detail/iterator_value.hpp>
 #include <boost/utility/enable_if.hpp>
 #include <boost/mpl/logical.hpp>
 #include <boost/type_traits/is_same.hpp>
 #include <boost/type_traits/remove_const.hpp>
+#include <cstddef>
+#include <ios>
+#include <istream>
+#include <locale>
 #include <ostream>
-#include <iterator>
+#include <streambuf>
 
 #include <boost/config/abi_prefix.hpp> // must be the last #include
 
@@ -28,21 +33,271 @@ namespace interop
 namespace detail
 {
 
-template <class Ostream, class InputIterator>
-Ostream& inserter(Ostream& os, InputIterator begin)
+//  The inserters convert into a chunk of stream_buffer_size units on the stack and write
+//  each chunk with a single sputn(), rather than inserting one character at a time,
+//  since each insertion constructs a sentry and makes a virtual call.
+
+const std::size_t stream_buffer_size = 256;
+
+template <class ToCodec, class FromCodec, class Streambuf>
+bool write_converted(Streambuf& sb, const typename FromCodec::value_type* first,
+  const typename FromCodec::value_type* last)
+{
+  typedef typename ToCodec::value_type to_type;
+
+  to_type buffer[stream_buffer_size];
+  while (first != last)
+  {
+    to_type* out = buffer;
+    char32 cp = 0;
+    block_status status = block_converter<ToCodec, FromCodec>::convert(
+      first, last, out, buffer + stream_buffer_size, cp);
+    std::streamsize n = out - buffer;
+    if (sb.sputn(buffer, n) != n)
+      return false;
+    if (status == block_invalid || status == block_incomplete)
+      FromCodec::invalid_input(cp);  // throws
+  }
+  return true;
+}
+
+template <class charT, class traits>
+bool write_fill(std::basic_ostream<charT, traits>& os, std::streamsize n)
+{
+  for (; n > 0; --n)
+    if (traits::eq_int_type(os.rdbuf()->sputc(os.fill()), traits::eof()))
+      return false;
+  return true;
+}
+
+//  Formatted output of the conversion of [first, last), padded to os.width() with
+//  os.fill() as placement by os.flags() requires
+template <class charT, class traits, class FromCharT>
+std::basic_ostream<charT, traits>& inserter(std::basic_ostream<charT, traits>& os,
+  const FromCharT* first, const FromCharT* last)
+{
+  typedef typename select_codec<charT>::type      to_codec;
+  typedef typename select_codec<FromCharT>::type  from_codec;
+
+  typename std::basic_ostream<charT, traits>::sentry ok(os);
+  if (!ok)
+    return os;
+
+  std::streamsize pad = 0;
+  if (os.width() > 0)
+    pad = os.width() - static_cast<std::streamsize>(
+      converted_length<to_codec, from_codec>(first, last - first));
+  bool left = (os.flags() & std::ios_base::adjustfield) == std::ios_base::left;
+
+  bool good = (left || write_fill(os, pad))
+    && write_converted<to_codec, from_codec>(*os.rdbuf(), first, last)
+    && (!left || write_fill(os, pad));
+  os.width(0);
+  if (!good)
+    os.setstate(std::ios_base::badbit);
+  return os;
+}
+
+//  Formatted output of the conversion of the null terminated p. Without padding, the
+//  terminator is found a chunk at a time as the input is converted (see null_chunk() in
+//  string_interop.hpp), so p is read once.
+template <class charT, class traits, class FromCharT>
+std::basic_ostream<charT, traits>& inserter(std::basic_ostream<charT, traits>& os,
+  const FromCharT* p)
 {
-  typedef boost::interop::conversion_iterator<
-    typename boost::interop::select_codec<typename Ostream::char_type>::type,
-    typename boost::interop::select_codec<
-      typename std::iterator_traits<InputIterator>::value_type>::type,
-    InputIterator>
-      iter_type;
+  typedef typename select_codec<charT>::type      to_codec;
+  typedef typename select_codec<FromCharT>::type  from_codec;
+
+  if (os.width() > 0)  // the padding depends on the length, so find the end first
+  {
+    const FromCharT* last = p;
+    for (bool terminated = false; !terminated;)
+      last = null_chunk<from_codec>(last, terminated);
+    return inserter(os, p, last);
+  }
 
-  for (iter_type itr(begin); itr != iter_type(); ++itr)
-    os << *itr;
+  typename std::basic_ostream<charT, traits>::sentry ok(os);
+  if (!ok)
+    return os;
+
+  bool good = true;
+  for (bool terminated = false; good && !terminated;)
+  {
+    const FromCharT* last = null_chunk<from_codec>(p, terminated);
+    good = write_converted<to_codec, from_codec>(*os.rdbuf(), p, last);
+    p = last;
+  }
+  os.width(0);
+  if (!good)
+    os.setstate(std::ios_base::badbit);
   return os;
 }
 
+//  The extractors decode directly from the streambuf's get area, a run of units at a
+//  time, into the target string. A sequence split across refills of the get area is
+//  held by a transcoder until it is completed.
+
+//  gives access to the protected get area members of any basic_streambuf
+template <class charT, class traits>
+struct get_area : std::basic_streambuf<charT, traits>
+{
+  typedef std::basic_streambuf<charT, traits> streambuf_type;
+
+  static charT* begin(streambuf_type& sb) { return (sb.*&get_area::gptr)(); }
+  static charT* end(streambuf_type& sb)   { return (sb.*&get_area::egptr)(); }
+  static void bump(streambuf_type& sb, std::ptrdiff_t n)
+    { (sb.*&get_area::gbump)(static_cast<int>(n)); }
+};
+
+//  stop at whitespace, as classified by the stream's locale
+template <class charT>
+class space_finder
+{
+public:
+  explicit space_finder(const std::locale& loc)
+    : m_ctype(std::use_facet<std::ctype<charT> >(loc)) {}
+  const charT* operator()(const charT* first, const charT* last) const
+    { return m_ctype.scan_is(std::ctype_base::space, first, last); }
+private:
+  const std::ctype<charT>& m_ctype;
+};
+
+//  stop at the delimiter
+template <class charT, class traits>
+class delimiter_finder
+{
+public:
+  explicit delimiter_finder(charT delim) : m_delim(delim) {}
+  const charT* operator()(const charT* first, const charT* last) const
+  {
+    const charT* p = traits::find(first, last - first, m_delim);
+    return p ? p : last;
+  }
+private:
+  charT m_delim;
+};
+
+//  Appends the conversion of up to max units from is to str, stopping before the first
+//  unit for which find() stops, or at end-of-file. If max ends in the middle of a
+//  sequence, the sequence is completed. Returns the number of units extracted, and
+//  sets state to reflect end-of-file and invalid input; stopped is set if extraction
+//  stopped at a unit found by find().
+template <class ToCodec, class charT, class traits, class String, class Finder>
+std::size_t extract_converted(std::basic_istream<charT, traits>& is, String& str,
+  std::size_t max, Finder find, std::ios_base::iostate& state, bool& stopped)
+{
+  typedef get_area<charT, traits> area;
+  typedef typename traits::int_type int_type;
+
+  std::basic_streambuf<charT, traits>& sb = *is.rdbuf();
+  transcoder<ToCodec, typename select_codec<charT>::type> converter;
+  std::size_t count = 0;
+  stopped = false;
+
+  for (;;)
+  {
+    std::size_t room = count < max ? max - count : converter.pending() ? 1 : 0;
+    if (room == 0)
+      break;
+    int_type c = sb.sgetc();  // refills the get area if it is empty
+    if (traits::eq_int_type(c, traits::eof()))
+    {
+      state |= std::ios_base::eofbit;
+      break;
+    }
+
+    charT ch = traits::to_char_type(c);
+    const charT* first = area::begin(sb);
+    const charT* last = area::end(sb);
+    bool unbuffered = first == last;
+    if (unbuffered)
+    {
+      first = &ch;
+      last = first + 1;
+    }
+    if (static_cast<std::size_t>(last - first) > room)
+      last = first + room;
+
+    const charT* p = find(first, last);
+    if (p != first)
+    {
+      if (unbuffered)
+        sb.sbumpc();
+      else
+        area::bump(sb, p - first);
+      count += p - first;
+      if (converter.feed(first, p, str) != transcode_status::ok)
+      {
+        state |= std::ios_base::failbit;
+        return count;
+      }
+    }
+    if (p != last)
+    {
+      stopped = true;
+      break;
+    }
+  }
+
+  if (converter.finish() != transcode_status::ok)
+    state |= std::ios_base::failbit;
+  return count;
+}
+
+//  Formatted input of a whitespace delimited word, converted to str
+template <class charT, class traits, class String>
+void extractor(std::basic_istream<charT, traits>& is, String& str)
+{
+  typedef typename select_codec<typename String::value_type>::type to_codec;
+
+  std::ios_base::iostate state = std::ios_base::goodbit;
+  typename std::basic_istream<charT, traits>::sentry ok(is);
+  if (ok)
+  {
+    str.erase();
+    std::size_t max = is.width() > 0 ? static_cast<std::size_t>(is.width())
+      : static_cast<std::size_t>(-1);
+    bool stopped;
+    if (extract_converted<to_codec>(is, str, max,
+      space_finder<charT>(is.getloc()), state, stopped) == 0)
+      state |= std::ios_base::failbit;
+    is.width(0);
+  }
+  else
+    state |= std::ios_base::failbit;
+  if (state)
+    is.setstate(state);
+}
+
+//  Unformatted input of a line ending in delim, converted to str
+template <class charT, class traits, class String>
+void line_extractor(std::basic_istream<charT, traits>& is, String& str, charT delim)
+{
+  typedef typename select_codec<typename String::value_type>::type to_codec;
+
+  std::ios_base::iostate state = std::ios_base::goodbit;
+  typename std::basic_istream<charT, traits>::sentry ok(is, true);
+  if (ok)
+  {
+    str.erase();
+    bool stopped;
+    std::size_t count = extract_converted<to_codec>(is, str,
+      static_cast<std::size_t>(-1), delimiter_finder<charT, traits>(delim), state,
+      stopped);
+    if (stopped)
+    {
+      is.rdbuf()->sbumpc();  // the delimiter is extracted, but not stored
+      ++count;
+    }
+    if (count == 0)
+      state |= std::ios_base::failbit;
+  }
+  else
+    state |= std::ios_base::failbit;
+  if (state)
+    is.setstate(state);
+}
+
 } // namespace detail
 } // namespace interop
 } // namespace boost
@@ -66,18 +321,38 @@ typename boost::enable_if_c<!boost::is_same<charT, typename Ostream::char_type>:
   Ostream&>::type
 operator<<(Ostream& os, const basic_string<charT, Traits, Allocator>& str)
 {
-  typedef const basic_string<charT, Traits, Allocator> string_type;
+  boost::interop::detail::inserter(os, str.data(), str.data() + str.size());
+  return os;
+}
 
-  typedef boost::interop::conversion_iterator<
-    typename boost::interop::select_codec<typename Ostream::char_type>::type,
-    typename boost::interop::select_codec<charT>::type,
-    typename string_type::const_iterator>
-      iter_type;
+//  basic_string extractor and getline() overloads
 
-  iter_type itr(str.begin(), str.end());
-  for (; itr != iter_type(); ++itr)
-    os << *itr;
-  return os;
+template <class Istream, class charT, class Traits, class Allocator>
+typename boost::enable_if_c<!boost::is_same<charT, typename Istream::char_type>::value,
+  Istream&>::type
+operator>>(Istream& is, basic_string<charT, Traits, Allocator>& str)
+{
+  boost::interop::detail::extractor(is, str);
+  return is;
+}
+
+template <class Istream, class charT, class Traits, class Allocator>
+typename boost::enable_if_c<!boost::is_same<charT, typename Istream::char_type>::value,
+  Istream&>::type
+getline(Istream& is, basic_string<charT, Traits, Allocator>& str,
+  typename Istream::char_type delim)
+{
+  boost::interop::detail::line_extractor(is, str, delim);
+  return is;
+}
+
+template <class Istream, class charT, class Traits, class Allocator>
+typename boost::enable_if_c<!boost::is_same<charT, typename Istream::char_type>::value,
+  Istream&>::type
+getline(Istream& is, basic_string<charT, Traits, Allocator>& str)
+{
+  boost::interop::detail::line_extractor(is, str, is.widen('\n'));
+  return is;
 }
 
 //  Character pointer overloads
@@ -91,17 +366,17 @@ operator<<(Ostream& os, const basic_string<charT, Traits, Allocator>& str)
 //
 //  As a fix, supply individual overloads for the ostreams and pointers we care about
 
-basic_ostream<char>& operator<<(basic_ostream<char>& os, const wchar_t* p)
+inline basic_ostream<char>& operator<<(basic_ostream<char>& os, const wchar_t* p)
 {
   return boost::interop::detail::inserter(os, p);
 }
 
-basic_ostream<char>& operator<<(basic_ostream<char>& os, const boost::char16* p)
+inline basic_ostream<char>& operator<<(basic_ostream<char>& os, const boost::char16* p)
 {
   return boost::interop::detail::inserter(os, p);
 }
 
-basic_ostream<char>& operator<<(basic_ostream<char>& os, const boost::char32* p)
+inline basic_ostream<char>& operator<<(basic_ostream<char>& os, const boost::char32* p)
 {
   return boost::interop::detail::inserter(os, p);
 }
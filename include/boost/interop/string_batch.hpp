@@ -0,0 +1,268 @@
+//  boost/interop/string_batch.hpp  ----------------------------------------------------//
+
+//  Copyright Beman Dawes 2012
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+//--------------------------------------------------------------------------------------//
+//                                                                                      //
+//  Conversion of many strings into one contiguous buffer.                              //
+//                                                                                      //
+//  A string_batch<ToCodec> holds any number of converted strings end to end in a       //
+//  single buffer of ToCodec units, with an array of size() + 1 offsets into it, so that//
+//  string i is [data() + offsets()[i], data() + offsets()[i + 1]). This is the layout  //
+//  of an Apache Arrow variable length binary column.                                   //
+//                                                                                      //
+//  append_batch<ToCodec, FromCodec>() counts the output of every source string with    //
+//  converted_length() in one pass, sizes the buffer once for the total, and then       //
+//  converts each string directly into its own slot; same encoding pairs are validated  //
+//  and copied. Invalid input may not fit the slot counted for it, so the string that   //
+//  holds it, and every string after it, is instead appended as make_string() would     //
+//  convert it, applying the same ErrorPolicy.                                          //
+//                                                                                      //
+//  A batch that is cleared keeps its capacity, so reusing one for input of a similar   //
+//  size allocates nothing at all.                                                      //
+//                                                                                      //
+//  Both codecs must be BlockCodecs, and the source strings contiguous (see             //
+//  string_interop.hpp).                                                                //
+//                                                                                      //
+//--------------------------------------------------------------------------------------//
+
+#if !defined(BOOST_INTEROP_STRING_BATCH_HPP)
+# define BOOST_INTEROP_STRING_BATCH_HPP
+
+#include <boost/interop/string_interop.hpp>
+#include <boost/static_assert.hpp>
+#include <boost/type_traits/is_same.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <boost/config/abi_prefix.hpp> // must be the last #include
+
+namespace boost
+{
+namespace interop
+{
+
+namespace detail
+{
+  template <class ToCodec, class FromCodec> struct batch_appender;
+}
+
+//--------------------------------------------------------------------------------------//
+//                                    string_batch                                      //
+//--------------------------------------------------------------------------------------//
+
+template <class ToCodec>
+class string_batch
+{
+public:
+  typedef typename ToCodec::value_type   value_type;
+  typedef std::basic_string<value_type>  string_type;
+
+  string_batch() : m_offsets(1, 0) {}
+
+  std::size_t size() const  { return m_offsets.size() - 1; }  // number of strings
+  bool empty() const        { return size() == 0; }
+  std::size_t units() const { return m_data.size(); }  // of all strings together
+
+  //  the units of all strings, end to end
+  const value_type* data() const { return m_data.data(); }
+
+  //  size() + 1 offsets into data(); the first is 0 and the last units()
+  const std::size_t* offsets() const { return &m_offsets[0]; }
+
+  //  string i, for i < size()
+  const value_type* begin(std::size_t i) const { return data() + m_offsets[i]; }
+  const value_type* end(std::size_t i) const   { return data() + m_offsets[i + 1]; }
+  std::size_t length(std::size_t i) const { return m_offsets[i + 1] - m_offsets[i]; }
+  string_type str(std::size_t i) const { return string_type(begin(i), end(i)); }
+
+  void reserve(std::size_t strings, std::size_t units)
+  {
+    m_offsets.reserve(strings + 1);
+    m_data.reserve(units);
+  }
+
+  //  removes every string, keeping the capacity
+  void clear()
+  {
+    m_offsets.resize(1);
+    m_data.clear();
+  }
+
+  void swap(string_batch& other)
+  {
+    m_offsets.swap(other.m_offsets);
+    m_data.swap(other.m_data);
+  }
+
+private:
+  template <class, class> friend struct detail::batch_appender;
+
+  std::vector<std::size_t>  m_offsets;
+  string_type               m_data;
+};
+
+//--------------------------------------------------------------------------------------//
+//                                    implementation                                    //
+//--------------------------------------------------------------------------------------//
+
+namespace detail
+{
+  template <class ToCodec, class FromCodec>
+  struct batch_appender
+  {
+    typedef typename ToCodec::value_type    to_type;
+    typedef typename FromCodec::value_type  from_type;
+
+    template <class String>
+    static const from_type* first_of(const String& s)
+    {
+      return s.empty() ? 0 : &*s.begin();
+    }
+
+    //  converts [first, last) into exactly [out, out_last), or returns false
+    template <class ErrorPolicy>
+    static bool convert(const from_type* first, const from_type* last, to_type* out,
+      to_type* out_last, ErrorPolicy, boost::false_type)
+    {
+      char32 cp = 0;
+      return block_converter<ToCodec, FromCodec>::convert(first, last, out, out_last,
+        cp) == block_ok && out == out_last;
+    }
+
+    template <class ErrorPolicy>
+    static bool convert(const from_type* first, const from_type* last, to_type* out,
+      to_type* out_last, ErrorPolicy policy, boost::true_type)
+    {
+      if (!copies_as_is<ToCodec, FromCodec>())
+        return convert(first, last, out, out_last, policy, boost::false_type());
+      if (last - first != out_last - out
+        || valid_end<FromCodec>(first, last, policy) != last)
+        return false;
+      std::copy(first, last, out);
+      return true;
+    }
+
+    template <class ForwardIterator, class ErrorPolicy>
+    static void append(ForwardIterator first, ForwardIterator last,
+      string_batch<ToCodec>& batch, ErrorPolicy policy)
+    {
+      typedef typename std::iterator_traits<ForwardIterator>::value_type from_string;
+
+      std::vector<std::size_t>& offsets = batch.m_offsets;
+      typename string_batch<ToCodec>::string_type& data = batch.m_data;
+      const std::size_t old_strings = batch.size();
+      const std::size_t old_units = data.size();
+
+      try
+      {
+        //  count the output of every string, and lay the slots out end to end
+        offsets.reserve(offsets.size() + std::distance(first, last));
+        std::size_t input_units = 0;
+        for (ForwardIterator it = first; it != last; ++it)
+        {
+          const from_string& s = *it;
+          const from_type* p = first_of(s);
+          offsets.push_back(offsets.back()
+            + length_counter<ToCodec, FromCodec>::count(p, p + s.size()));
+          input_units += s.size();
+        }
+
+        //  one allocation for all of them, then convert each into its slot
+        resize_for_overwrite(data, offsets.back());
+        to_type* base = data.empty() ? 0 : &data[0];
+        std::size_t i = old_strings;
+        for (; first != last; ++first, ++i)
+        {
+          const from_string& s = *first;
+          const from_type* p = first_of(s);
+          if (!convert(p, p + s.size(), base + offsets[i], base + offsets[i + 1],
+            policy, typename is_same_encoding<ToCodec, FromCodec>::type()))
+            break;
+        }
+
+        //  invalid input; append it and the strings after it as make_string() would
+        if (first != last)
+        {
+          data.resize(offsets[i]);
+          offsets.resize(i + 1);
+          for (; first != last; ++first)
+          {
+            const from_string& s = *first;
+            const from_type* p = first_of(s);
+            block_append<ToCodec, FromCodec>(p, p + s.size(), data, policy);
+            offsets.push_back(data.size());
+          }
+        }
+        BOOST_INTEROP_STATS_CALL(ToCodec, FromCodec, input_units,
+          data.size() - old_units, true);
+      }
+      catch (...)
+      {
+        offsets.resize(old_strings + 1);
+        data.resize(old_units);
+        throw;
+      }
+    }
+  };
+} // namespace detail
+
+//--------------------------------------------------------------------------------------//
+//                                    append_batch                                      //
+//--------------------------------------------------------------------------------------//
+
+//  Appends the conversion of each string in [first, last) to batch. The strings are
+//  FromCodec encoded and contiguous, such as std::basic_string or std::vector. policy
+//  applies to each string as it would to make_string(); stop_on_error, which reports
+//  how much of one string was converted, is not supported. If an exception is thrown,
+//  batch is left as it was.
+
+template <class ToCodec, class FromCodec, class ForwardIterator, class ErrorPolicy>
+inline void append_batch(ForwardIterator first, ForwardIterator last,
+  string_batch<ToCodec>& batch, ErrorPolicy policy)
+{
+  BOOST_STATIC_ASSERT_MSG((detail::has_block_interface<ToCodec>::value
+    && detail::has_block_interface<FromCodec>::value),
+    "append_batch requires BlockCodecs");
+  BOOST_STATIC_ASSERT_MSG((is_error_policy<ErrorPolicy>::value
+    && !boost::is_same<ErrorPolicy, stop_on_error>::value),
+    "append_batch requires an ErrorPolicy other than stop_on_error");
+  detail::batch_appender<ToCodec, FromCodec>::append(first, last, batch, policy);
+}
+
+template <class ToCodec, class FromCodec, class ForwardIterator>
+inline void append_batch(ForwardIterator first, ForwardIterator last,
+  string_batch<ToCodec>& batch)
+{
+  append_batch<ToCodec, FromCodec>(first, last, batch, throw_on_error());
+}
+
+//  Returns a batch of the conversions of each string in [first, last)
+
+template <class ToCodec, class FromCodec, class ForwardIterator, class ErrorPolicy>
+inline string_batch<ToCodec> make_batch(ForwardIterator first, ForwardIterator last,
+  ErrorPolicy policy)
+{
+  string_batch<ToCodec> batch;
+  append_batch<ToCodec, FromCodec>(first, last, batch, policy);
+  return batch;
+}
+
+template <class ToCodec, class FromCodec, class ForwardIterator>
+inline string_batch<ToCodec> make_batch(ForwardIterator first, ForwardIterator last)
+{
+  return make_batch<ToCodec, FromCodec>(first, last, throw_on_error());
+}
+
+}  // namespace interop
+}  // namespace boost
+
+#include <boost/config/abi_suffix.hpp> // pops abi_prefix.hpp pragmas
+
+#endif  // BOOST_INTEROP_STRING_BATCH_HPP
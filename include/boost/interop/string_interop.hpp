@@ -22,10 +22,6 @@
 /*
    TODO
 
-   * Add error handling options
-
-   * make_string needs to add a (defaulted) allocator arguments for the output string.
-
    * Add make_ or to_* alias functions. See commented out experiments at end of this
      header and at end of smoke_test2.cpp.
 
@@ -33,7 +29,7 @@
 
      Codec    Windows    POSIX
      ------   -------    -----
-     narrow   hack       hack    Windows assume codepage 437, POSIX assume UTF-8 
+     narrow   hack       done    Windows assume codepage 437, POSIX from nl_langinfo
      wide     done       hack    POSIX assume wchar_t is UTF-16 or UTF-32
      utf8     done       done
      utf16    done       done
@@ -49,17 +45,31 @@
 #include <boost/assert.hpp>
 #include <stdexcept>
 #include <boost/interop/cxx11_char_types.hpp>
+#include <boost/interop/codepage_tables.hpp>
 #include <boost/interop/detail/is_iterator.hpp>
+#include <boost/interop/detail/is_contiguous.hpp>
+#include <boost/interop/detail/simd.hpp>
+#ifdef BOOST_INTEROP_STATS
+# include <boost/interop/conversion_stats.hpp>
+#endif
 //#include <boost/cstdint.hpp>
 #include <boost/iterator/iterator_facade.hpp>
 #include <boost/static_assert.hpp>
 #include <boost/utility/enable_if.hpp>
 #include <boost/type_traits/is_same.hpp>
 #include <boost/type_traits/decay.hpp>
+#include <boost/type_traits/integral_constant.hpp>
+#include <boost/type_traits/conditional.hpp>
+#include <boost/type_traits/is_convertible.hpp>
+#include <boost/type_traits/remove_cv.hpp>
+#include <boost/type_traits/declval.hpp>
 #include <stdexcept>
 #include <sstream>
 #include <iterator>
 #include <algorithm>
+#include <memory>
+#include <string>
+#include <utility>
 #include <limits.h> // CHAR_BIT
 
 #include <boost/config/abi_prefix.hpp> // must be the last #include
@@ -88,12 +98,14 @@ template <class charT>
 
   //  codecs
   class utf8;                                        // UTF-8 encoding for char
+  template <class Table>
+    class narrow_codec;                              // single byte codepage for char
 #ifdef BOOST_WINDOWS_API
-  class narrow;                                      // native encoding for char
+  typedef narrow_codec<codepage_437>       narrow;   // native encoding for char
   typedef detail::generic_utf16<wchar_t>  wide;      // UTF-16 encoding for wchar_t
 #else
-  // hack: assume POSIX narrow encoding is UTF-8 
-  typedef utf8 narrow;
+  class locale_narrow;                               // locale encoding for char
+  typedef locale_narrow                   narrow;    // native encoding for char
   // hack: assume POSIX wide encoding is UTF-16 or UTF-32
 # if WCHAR_MAX == 0xffff
   typedef detail::generic_utf16<wchar_t>  wide;      // UTF-16 encoding for wchar_t
@@ -133,7 +145,16 @@ template <class charT>
   template <class ToCodec, class FromCodec, class InputIterator>
     class conversion_iterator;
 
+  //  error policies
+  struct throw_on_error;
+  struct replace_on_error;
+  struct skip_on_error;
+  class stop_on_error;
+  struct assume_valid;
+  template <class T> struct is_error_policy;
+
 //  see make_string() functions below
+//  see validate_utf8(), converted_length(), and count_code_points() below
 
 //---------------------------------  Requirements  -------------------------------------//
 //
@@ -145,10 +166,29 @@ template <class charT>
 //
 //  from_iterator meets the DefaultCtorEndIterator requirements.
 //  iterator_traits<from_iterator>::value_type is char32_t.
+//  from_iterator(first, last, position) constructs an iterator at position in the range
+//  [first, last). If InputIterator is bidirectional, so is from_iterator, and one so
+//  constructed can be decremented towards first.
 //
 //  to_iterator meets the DefaultCtorEndIterator requirements.
 //  InputIterator must meet the DefaultCtorEndIterator requirements.
 //  iterator_traits<InputIterator>::value_type must be char32_t.
+//
+//  BlockCodec:
+//
+//  A Codec that also supplies the static members below, and for which
+//  detail::has_block_interface is specialized to true_type. make_string() uses them to
+//  convert contiguous ranges a whole buffer at a time rather than via iterators.
+//
+//  max_units                  maximum number of value_type units per code point.
+//  decode(first, last, cp)    decode one code point from [first, last) into cp,
+//                             advancing first. Returns a detail::decode_status.
+//  encode(cp, out)            write the units for valid code point cp to out, returning
+//                             the advanced out.
+//  encoded_length(cp)         number of units encode(cp, out) writes.
+//  sequence_start(first, p)   the start of the sequence containing the unit at p, which
+//                             is first or later.
+//  invalid_input(cp)          report the invalid input unit cp set by decode().
 
 //--------------------------------------------------------------------------------------//
 //                                  Implementation                                      //
@@ -199,11 +239,64 @@ inline unsigned utf8_trailing_byte_count(boost::uint8_t c)
    return utf8_byte_count(c) - 1;
 }
 
+inline bool is_continuation_byte(boost::uint8_t c)
+{
+   return (c & 0xC0u) == 0x80u;
+}
+
+//  decode() results for the BlockCodec interface
+enum decode_status
+{
+  decode_ok,          // a valid code point was decoded
+  decode_incomplete,  // the range ended in the middle of a sequence
+  decode_invalid      // an invalid sequence was encountered
+};
+
+//  null_terminated<InputIterator>::end(begin) returns the end of the null terminated
+//  sequence at begin, and at_end(p, end) whether p is at that end. For a pointer, end()
+//  does not scan: it returns a null pointer, which no position compares equal to, and
+//  at_end() instead tests for the terminator as it is reached. decode() needs no other
+//  change, since no encoding continues a sequence with a zero unit. Other iterators
+//  are scanned up front.
+template <class InputIterator>
+struct null_terminated
+{
+  static InputIterator end(InputIterator begin)
+  {
+    for (;
+         *begin != typename std::iterator_traits<InputIterator>::value_type();
+         ++begin) {}
+    return begin;
+  }
+  static bool at_end(const InputIterator& p, const InputIterator& end)
+    { return p == end; }
+};
+
+template <class T>
+struct null_terminated<T*>
+{
+  static T* end(T*) { return 0; }
+  static bool at_end(T* p, T* end) { return p == end || (!end && *p == T()); }
+};
+
+//  bidirectional_category<InputIterator>::type is std::bidirectional_iterator_tag if
+//  InputIterator is at least bidirectional, and otherwise std::input_iterator_tag. The
+//  from_iterators, and the conversion_iterators built from them, can then be decremented
+//  over a bidirectional range.
+template <class InputIterator>
+struct bidirectional_category
+  : boost::conditional<boost::is_convertible<
+      typename std::iterator_traits<InputIterator>::iterator_category,
+      std::bidirectional_iterator_tag>::value,
+    std::bidirectional_iterator_tag, std::input_iterator_tag>
+{};
+
 #ifdef BOOST_MSVC
 # pragma warning(push)
 # pragma warning(disable:4100)
 #endif
-inline void invalid_utf32_code_point(::boost::uint32_t val)
+//  never inlined, keeping the stringstream and throw out of the conversion loops
+BOOST_NOINLINE inline void invalid_utf32_code_point(::boost::uint32_t val)
 {
    std::stringstream ss;
    ss << "Invalid UTF-32 code point U+" << std::showbase << std::hex << val
@@ -211,6 +304,20 @@ inline void invalid_utf32_code_point(::boost::uint32_t val)
    std::out_of_range e(ss.str());
    BOOST_INTEROP_THROW(e);
 }
+BOOST_NOINLINE inline void invalid_utf16_code_point(::boost::uint16_t val)
+{
+   std::stringstream ss;
+   ss << "Misplaced UTF-16 surrogate U+" << std::showbase << std::hex << val
+      << " encountered while trying to encode UTF-32 sequence";
+   std::out_of_range e(ss.str());
+   BOOST_INTEROP_THROW(e);
+}
+BOOST_NOINLINE inline void invalid_utf8_sequence()
+{
+   std::out_of_range e(
+     "Invalid UTF-8 sequence encountered while trying to encode UTF-32 character");
+   BOOST_INTEROP_THROW(e);
+}
 #ifdef BOOST_MSVC
 # pragma warning(pop)
 #endif
@@ -231,7 +338,7 @@ public:
   template <class InputIterator>
   class from_iterator
     : public boost::iterator_facade<from_iterator<InputIterator>,
-        charT, std::input_iterator_tag, const charT> 
+        charT, typename detail::bidirectional_category<InputIterator>::type, const charT> 
   {
     BOOST_STATIC_ASSERT_MSG((boost::is_same<typename std::iterator_traits<InputIterator>::value_type,
       charT>::value),
@@ -239,6 +346,10 @@ public:
     InputIterator  m_begin;
     InputIterator  m_end;
     bool             m_default_end;
+    InputIterator  m_first;  // start of the range, for decrement()
+
+    bool at_end() const
+      { return detail::null_terminated<InputIterator>::at_end(m_begin, m_end); }
 
   public:
 
@@ -246,50 +357,57 @@ public:
     from_iterator() : m_default_end(true) {}
 
     // by_null
-    from_iterator(InputIterator begin) : m_begin(begin), m_end(begin),
-      m_default_end(false) 
-    {
-      for (;
-           *m_end != typename std::iterator_traits<InputIterator>::value_type();
-           ++m_end) {}
-    }
+    from_iterator(InputIterator begin) : m_begin(begin),
+      m_end(detail::null_terminated<InputIterator>::end(begin)), m_default_end(false),
+      m_first(begin) {}
 
     // by range
     template <class T>
     from_iterator(InputIterator begin, T end,
       // enable_if ensures 2nd argument of 0 is treated as size, not range end
       typename boost::enable_if<boost::is_same<InputIterator, T>, void* >::type =0)
-      : m_begin(begin), m_end(end), m_default_end(false) {}
+      : m_begin(begin), m_end(end), m_default_end(false), m_first(begin) {}
 
     // by_size
     from_iterator(InputIterator begin, std::size_t sz)
-      : m_begin(begin), m_end(begin), m_default_end(false)
+      : m_begin(begin), m_end(begin), m_default_end(false), m_first(begin)
     {
       std::advance(m_end, sz);
     }
 
+    // by range, at position
+    from_iterator(InputIterator first, InputIterator last, InputIterator position)
+      : m_begin(position), m_end(last), m_default_end(false), m_first(first) {}
+
     charT dereference() const
     {
-      BOOST_ASSERT_MSG(!m_default_end && m_begin != m_end,
+      BOOST_ASSERT_MSG(!m_default_end && !at_end(),
         "Attempt to dereference end iterator");
       return *m_begin;
     }
 
     bool equal(const from_iterator& that) const
     {
-      if (m_default_end || m_begin == m_end)
-        return that.m_default_end || that.m_begin == that.m_end;
-      if (that.m_default_end || that.m_begin == that.m_end)
+      if (m_default_end || at_end())
+        return that.m_default_end || that.at_end();
+      if (that.m_default_end || that.at_end())
         return false;
       return m_begin == that.m_begin;
     }
 
     void increment()
     {
-      BOOST_ASSERT_MSG(!m_default_end && m_begin != m_end,
+      BOOST_ASSERT_MSG(!m_default_end && !at_end(),
         "Attempt to increment end iterator");
       ++m_begin;
     }
+
+    void decrement()
+    {
+      BOOST_ASSERT_MSG(!m_default_end && m_begin != m_first,
+        "Attempt to decrement begin iterator");
+      --m_begin;
+    }
   };
 
   //  generic_utf32::::to_iterator  ---------------------------------------------------//
@@ -308,6 +426,44 @@ public:
     void increment() { ++m_itr; }
   };
 
+  //  generic_utf32 block interface  ---------------------------------------------------//
+
+  BOOST_STATIC_CONSTANT(std::size_t, max_units = 1);
+
+  template <class InputIterator>
+  static decode_status decode(InputIterator& first, InputIterator, char32& cp)
+  {
+    cp = static_cast<char32>(*first);
+    ++first;
+    if (cp > 0x10FFFFu || detail::is_surrogate(cp))
+      return decode_invalid;
+    return decode_ok;
+  }
+
+  template <class OutputIterator>
+  static OutputIterator encode(char32 cp, OutputIterator out)
+  {
+    *out = static_cast<charT>(cp);
+    return ++out;
+  }
+
+  static std::size_t encoded_length(char32) { return 1; }
+
+  template <class BidirectionalIterator>
+  static BidirectionalIterator sequence_start(BidirectionalIterator,
+    BidirectionalIterator p)
+  {
+    return p;
+  }
+
+  static void invalid_input(char32 cp) { detail::invalid_utf32_code_point(cp); }
+
+  //  Returns a pointer to the first surrogate or out of range unit in [first, last), or
+  //  last if there is none
+  static const charT* validate(const charT* first, const charT* last)
+  {
+    return first + detail::simd::validate_utf32(first, last - first);
+  }
 };
 
 //--------------------------------------------------------------------------------------//
@@ -326,10 +482,11 @@ public:
   template <class InputIterator>
   class from_iterator
    : public boost::iterator_facade<from_iterator<InputIterator>,
-       char32, std::input_iterator_tag, const char32>
+       char32, typename detail::bidirectional_category<InputIterator>::type, const char32>
   {
      typedef boost::iterator_facade<from_iterator<InputIterator>,
-       char32, std::input_iterator_tag, const char32> base_type;
+       char32, typename detail::bidirectional_category<InputIterator>::type,
+       const char32> base_type;
      // special values for pending iterator reads:
      BOOST_STATIC_CONSTANT(char32, read_pending = 0xffffffffu);
 
@@ -343,7 +500,12 @@ public:
      InputIterator  m_begin;   // current position
      InputIterator  m_end;  
      mutable char32    m_value;     // current value or read_pending
+     mutable InputIterator  m_next;  // end of current sequence, valid unless read_pending
      bool             m_default_end;
+     InputIterator  m_first;  // start of the range, for decrement()
+
+     bool at_end() const
+       { return detail::null_terminated<InputIterator>::at_end(m_begin, m_end); }
 
    public:
 
@@ -351,34 +513,36 @@ public:
     from_iterator() : m_default_end(true) {}
 
     // by_null
-    from_iterator(InputIterator begin) : m_begin(begin), m_end(begin),
-      m_default_end(false) 
-    {
-      for (;
-           *m_end != typename std::iterator_traits<InputIterator>::value_type();
-           ++m_end) {}
-      m_value = read_pending;
-    }
+    from_iterator(InputIterator begin) : m_begin(begin),
+      m_end(detail::null_terminated<InputIterator>::end(begin)), m_default_end(false),
+      m_first(begin)
+      { m_value = read_pending; }
 
     // by range
     template <class T>
     from_iterator(InputIterator begin, T end,
       // enable_if ensures 2nd argument of 0 is treated as size, not range end
       typename boost::enable_if<boost::is_same<InputIterator, T>, void* >::type = 0)
-      : m_begin(begin), m_end(end), m_default_end(false) { m_value = read_pending; }
+      : m_begin(begin), m_end(end), m_default_end(false),
+        m_first(begin) { m_value = read_pending; }
 
     // by_size
     from_iterator(InputIterator begin, std::size_t sz)
-      : m_begin(begin), m_end(begin), m_default_end(false)
+      : m_begin(begin), m_end(begin), m_default_end(false), m_first(begin)
     {
       std::advance(m_end, sz);
       m_value = read_pending;
     }
 
+    // by range, at position
+    from_iterator(InputIterator first, InputIterator last, InputIterator position)
+      : m_begin(position), m_end(last), m_default_end(false), m_first(first)
+      { m_value = read_pending; }
+
      typename base_type::reference
         dereference() const
      {
-        BOOST_ASSERT_MSG(!m_default_end && m_begin != m_end,
+        BOOST_ASSERT_MSG(!m_default_end && !at_end(),
           "Attempt to dereference end iterator");
         if (m_value == read_pending)
            extract_current();
@@ -387,57 +551,54 @@ public:
 
      bool equal(const from_iterator& that) const 
      {
-       if (m_default_end || m_begin == m_end)
-         return that.m_default_end || that.m_begin == that.m_end;
-       if (that.m_default_end || that.m_begin == that.m_end)
+       if (m_default_end || at_end())
+         return that.m_default_end || that.at_end();
+       if (that.m_default_end || that.at_end())
          return false;
        return m_begin == that.m_begin;
      }
 
      void increment()
      {
-       BOOST_ASSERT_MSG(!m_default_end && m_begin != m_end,
+       BOOST_ASSERT_MSG(!m_default_end && !at_end(),
          "Attempt to increment end iterator");
-       // skip high surrogate first if there is one:
-       if(detail::is_high_surrogate(*m_begin))
-         ++m_begin;
-       ++m_begin;
+       // the sequence length is only known once it has been decoded, and decoding
+       // never reads past m_end
+       if (m_value == read_pending)
+         extract_current();
+       m_begin = m_next;
        m_value = read_pending;
      }
 
-  private:
-     static void invalid_code_point(::boost::uint16_t val)
+     void decrement()
      {
-        std::stringstream ss;
-        ss << "Misplaced UTF-16 surrogate U+" << std::showbase << std::hex << val
-           << " encountered while trying to encode UTF-32 sequence";
-        std::out_of_range e(ss.str());
-        BOOST_INTEROP_THROW(e);
+       BOOST_ASSERT_MSG(!m_default_end && m_begin != m_first,
+         "Attempt to decrement begin iterator");
+       // the sequence before m_begin must decode to exactly the units stepped back over
+       InputIterator last(m_begin);
+       --m_begin;
+       m_begin = generic_utf16::sequence_start(m_first, m_begin);
+       m_next = m_begin;
+       char32 cp;
+       if (generic_utf16::decode(m_next, last, cp) != detail::decode_ok || m_next != last)
+         invalid_code_point(static_cast< ::boost::uint16_t>(cp));
+       m_value = cp;
      }
-     static void invalid_sequence()
+
+  private:
+     static void invalid_code_point(::boost::uint16_t val)
      {
-        std::out_of_range e(
-          "Invalid UTF-16 sequence encountered while trying to encode UTF-32 character");
-        BOOST_INTEROP_THROW(e);
+        detail::invalid_utf16_code_point(val);
      }
      void extract_current() const
      {
-        m_value = static_cast<char32>(static_cast< ::boost::uint16_t>(*m_begin));
-        // if the last value is a high surrogate then adjust m_begin and m_value as needed:
-        if(detail::is_high_surrogate(*m_begin))
-        {
-           // precondition; next value must have be a low-surrogate:
-           InputIterator next(m_begin);
-           char16 t = *++next;
-           if((t & 0xFC00u) != 0xDC00u)
-              invalid_code_point(t);
-           m_value = (m_value - detail::high_surrogate_base) << 10;
-           m_value |= (static_cast<char32>(
-             static_cast<char16>(t)) & detail::ten_bit_mask);
-        }
-        // postcondition; result must not be a surrogate:
-        if(detail::is_surrogate(m_value))
-           invalid_code_point(static_cast<char16>(m_value));
+        // a high surrogate must be followed, within the range, by a low surrogate,
+        // and a low surrogate must not appear on its own
+        m_next = m_begin;
+        char32 cp;
+        if (generic_utf16::decode(m_next, m_end, cp) != decode_ok)
+           invalid_code_point(static_cast< ::boost::uint16_t>(cp));
+        m_value = cp;
      }
   };
 
@@ -544,6 +705,69 @@ public:
      }
   };
 
+  //  generic_utf16 block interface  ---------------------------------------------------//
+
+  BOOST_STATIC_CONSTANT(std::size_t, max_units = 2);
+
+  template <class InputIterator>
+  static decode_status decode(InputIterator& first, InputIterator last, char32& cp)
+  {
+    ::boost::uint16_t u = static_cast< ::boost::uint16_t>(*first);
+    ++first;
+    cp = u;
+    if (!detail::is_surrogate(u))
+      return decode_ok;
+    if (!detail::is_high_surrogate(u))
+      return decode_invalid;
+    if (first == last)
+      return decode_incomplete;
+    ::boost::uint16_t t = static_cast< ::boost::uint16_t>(*first);
+    if (!detail::is_low_surrogate(t))
+      return decode_invalid;  // t is not consumed; it may start the next code point
+    ++first;
+    cp = ((cp - detail::high_surrogate_base) << 10)
+      | (static_cast<char32>(t) & detail::ten_bit_mask);
+    return decode_ok;
+  }
+
+  template <class OutputIterator>
+  static OutputIterator encode(char32 cp, OutputIterator out)
+  {
+    if (cp >= 0x10000u)
+    {
+      *out = static_cast<charT>((cp >> 10) + detail::high_surrogate_base);
+      *++out = static_cast<charT>((cp & detail::ten_bit_mask)
+        + detail::low_surrogate_base);
+    }
+    else
+      *out = static_cast<charT>(cp);
+    return ++out;
+  }
+
+  static std::size_t encoded_length(char32 cp) { return cp >= 0x10000u ? 2 : 1; }
+
+  //  a low surrogate after a high surrogate is the second unit of a pair
+  template <class BidirectionalIterator>
+  static BidirectionalIterator sequence_start(BidirectionalIterator first,
+    BidirectionalIterator p)
+  {
+    if (p == first || !detail::is_low_surrogate(static_cast< ::boost::uint16_t>(*p)))
+      return p;
+    BidirectionalIterator q(p);
+    return detail::is_high_surrogate(static_cast< ::boost::uint16_t>(*--q)) ? q : p;
+  }
+
+  static void invalid_input(char32 cp)
+  {
+    detail::invalid_utf16_code_point(static_cast< ::boost::uint16_t>(cp));
+  }
+
+  //  Returns a pointer to the first unpaired surrogate in [first, last), or last if
+  //  there is none
+  static const charT* validate(const charT* first, const charT* last)
+  {
+    return first + detail::simd::validate_utf16(first, last - first);
+  }
 };
 
 } // namespace detail
@@ -552,34 +776,46 @@ public:
 //                                    narrow codec                                      //
 //--------------------------------------------------------------------------------------//
 
-#ifdef BOOST_WINDOWS_API
-namespace detail
-{
-  //  for this proof-of-concept implementation, use codepage 437 tables at end of header
-  BOOST_INTEROP_DECL extern const boost::char16  to_utf16[];  
-  BOOST_INTEROP_DECL extern const unsigned char to_char[];
-  BOOST_INTEROP_DECL extern const boost::uint8_t slice_index[];
-}
+//  narrow_codec<Table> encodes char as the single byte codepage Table, one of the table
+//  types in codepage_tables.hpp; for example narrow_codec<codepage_1252> or
+//  narrow_codec<koi8_r>. Decoding a byte is a single lookup in Table::to_utf16, and
+//  encoding a code point is a lookup of its slice in Table::slice_index followed by a
+//  lookup in Table::to_char. Bytes the codepage leaves undefined decode to U+FFFD, and
+//  code points it cannot represent encode to '?', so there is no invalid input.
 
-class narrow
+template <class Table>
+class narrow_codec
 {
 public:
   typedef char value_type;
+  typedef Table table_type;
 
   template <class charT>
-  struct codec { typedef narrow type; };
+  struct codec { typedef narrow_codec type; };
+
+  static char32 to_code_point(char c)
+  {
+    return static_cast<char32>(Table::to_utf16[static_cast<unsigned char>(c)]);
+  }
+
+  static char from_code_point(char32 cp)
+  {
+    return (cp & 0xFFFF0000U) ? '?' : static_cast<char>(Table::to_char
+      [(Table::slice_index[cp >> 7] << 7) | (cp & 0x7f)]);
+  }
 
-  //  narrow::from_iterator  -----------------------------------------------------------//
+  //  narrow_codec::from_iterator  -----------------------------------------------------//
   //
   //  meets the DefaultCtorEndIterator requirements
 
   template <class InputIterator>  
   class from_iterator
    : public boost::iterator_facade<from_iterator<InputIterator>,
-       char32, std::input_iterator_tag, const char32>
+       char32, typename detail::bidirectional_category<InputIterator>::type, const char32>
   {
     typedef boost::iterator_facade<from_iterator<InputIterator>,
-      char32, std::input_iterator_tag, const char32> base_type;
+      char32, typename detail::bidirectional_category<InputIterator>::type,
+      const char32> base_type;
 
     typedef typename std::iterator_traits<InputIterator>::value_type base_value_type;
 
@@ -591,6 +827,10 @@ public:
     InputIterator  m_begin;
     InputIterator  m_end;
     bool             m_default_end;
+    InputIterator  m_first;  // start of the range, for decrement()
+
+    bool at_end() const
+      { return detail::null_terminated<InputIterator>::at_end(m_begin, m_end); }
 
   public:
 
@@ -598,51 +838,58 @@ public:
     from_iterator() : m_default_end(true) {}
 
     // by_null
-    from_iterator(InputIterator begin) : m_begin(begin), m_end(begin),
-      m_default_end(false) 
-    {
-      for (;
-           *m_end != typename std::iterator_traits<InputIterator>::value_type();
-           ++m_end) {}
-    }
+    from_iterator(InputIterator begin) : m_begin(begin),
+      m_end(detail::null_terminated<InputIterator>::end(begin)), m_default_end(false),
+      m_first(begin) {}
 
     // by range
     template <class T>
     from_iterator(InputIterator begin, T end,
       // enable_if ensures 2nd argument of 0 is treated as size, not range end
       typename boost::enable_if<boost::is_same<InputIterator, T>, void* >::type =0)
-      : m_begin(begin), m_end(end), m_default_end(false) {}
+      : m_begin(begin), m_end(end), m_default_end(false), m_first(begin) {}
 
     // by_size
     from_iterator(InputIterator begin, std::size_t sz)
-      : m_begin(begin), m_end(begin), m_default_end(false) {std::advance(m_end, sz);}
+      : m_begin(begin), m_end(begin), m_default_end(false),
+        m_first(begin) {std::advance(m_end, sz);}
+
+    // by range, at position
+    from_iterator(InputIterator first, InputIterator last, InputIterator position)
+      : m_begin(position), m_end(last), m_default_end(false), m_first(first) {}
 
     char32 dereference() const
     {
-      BOOST_ASSERT_MSG(!m_default_end && m_begin != m_end,
+      BOOST_ASSERT_MSG(!m_default_end && !at_end(),
         "Attempt to dereference end iterator");
-      unsigned char c = static_cast<unsigned char>(*m_begin);
-      return static_cast<char32>(interop::detail::to_utf16[c]);
+      return to_code_point(*m_begin);
     }
 
     bool equal(const from_iterator& that) const
     {
-      if (m_default_end || m_begin == m_end)
-        return that.m_default_end || that.m_begin == that.m_end;
-      if (that.m_default_end || that.m_begin == that.m_end)
+      if (m_default_end || at_end())
+        return that.m_default_end || that.at_end();
+      if (that.m_default_end || that.at_end())
         return false;
       return m_begin == that.m_begin;
     }
 
     void increment()
     { 
-      BOOST_ASSERT_MSG(!m_default_end && m_begin != m_end,
+      BOOST_ASSERT_MSG(!m_default_end && !at_end(),
         "Attempt to increment end iterator");
       ++m_begin;
     }
+
+    void decrement()
+    {
+      BOOST_ASSERT_MSG(!m_default_end && m_begin != m_first,
+        "Attempt to decrement begin iterator");
+      --m_begin;
+    }
   };
 
-  //  narrow::to_iterator  -------------------------------------------------------------//
+  //  narrow_codec::to_iterator  -------------------------------------------------------//
   //
   //  meets the DefaultCtorEndIterator requirements
 
@@ -672,16 +919,7 @@ public:
     {
       BOOST_ASSERT_MSG(m_begin != InputIterator(),
         "Attempt to dereference end iterator");
-      char32 c = *m_begin;
-      if (c & 0xFFFF0000U)
-        return '?';
-      //cout << "*** c is " << hex << c << '\n';
-      //cout << "    to_slice[c >> 7] << 7 is "
-      //  << unsigned int(interop::detail::slice_index[c >> 7] << 7) << '\n';
-      return static_cast<char>(interop::detail::to_char
-        [
-          (interop::detail::slice_index[c >> 7] << 7) | (c & 0x7f)
-        ]);
+      return from_code_point(*m_begin);
     }
 
     bool equal(const to_iterator& that) const
@@ -697,9 +935,37 @@ public:
     }
 
   };  // to_iterator
-};  // narrow
 
-#endif
+  //  narrow_codec block interface  ----------------------------------------------------//
+
+  BOOST_STATIC_CONSTANT(std::size_t, max_units = 1);
+
+  template <class InputIterator>
+  static detail::decode_status decode(InputIterator& first, InputIterator, char32& cp)
+  {
+    cp = to_code_point(*first);
+    ++first;
+    return detail::decode_ok;
+  }
+
+  template <class OutputIterator>
+  static OutputIterator encode(char32 cp, OutputIterator out)
+  {
+    *out = from_code_point(cp);
+    return ++out;
+  }
+
+  static std::size_t encoded_length(char32) { return 1; }
+
+  template <class BidirectionalIterator>
+  static BidirectionalIterator sequence_start(BidirectionalIterator,
+    BidirectionalIterator p)
+  {
+    return p;
+  }
+
+  static void invalid_input(char32) {}  // every byte is valid
+};  // narrow_codec
 
 //--------------------------------------------------------------------------------------//
 //                                     utf8 codec                                       //
@@ -718,10 +984,11 @@ public:
   template <class InputIterator>
   class from_iterator
    : public boost::iterator_facade<from_iterator<InputIterator>,
-       char32, std::input_iterator_tag, const char32>
+       char32, typename detail::bidirectional_category<InputIterator>::type, const char32>
   {
      typedef boost::iterator_facade<from_iterator<InputIterator>,
-       char32, std::input_iterator_tag, const char32> base_type;
+       char32, typename detail::bidirectional_category<InputIterator>::type,
+       const char32> base_type;
      // special values for pending iterator reads:
      BOOST_STATIC_CONSTANT(char32, read_pending = 0xffffffffu);
 
@@ -735,7 +1002,12 @@ public:
      InputIterator  m_begin;  // current position
      InputIterator  m_end;
      mutable char32    m_value;    // current value or read_pending
+     mutable InputIterator  m_next;  // end of current sequence, valid unless read_pending
      bool             m_default_end;
+     InputIterator  m_first;  // start of the range, for decrement()
+
+     bool at_end() const
+       { return detail::null_terminated<InputIterator>::at_end(m_begin, m_end); }
 
    public:
 
@@ -743,34 +1015,36 @@ public:
     from_iterator() : m_default_end(true) {}
 
     // by_null
-    from_iterator(InputIterator begin) : m_begin(begin), m_end(begin),
-      m_default_end(false) 
-    {
-      for (;
-           *m_end != typename std::iterator_traits<InputIterator>::value_type();
-           ++m_end) {}
-      m_value = read_pending;
-    }
+    from_iterator(InputIterator begin) : m_begin(begin),
+      m_end(detail::null_terminated<InputIterator>::end(begin)), m_default_end(false),
+      m_first(begin)
+      { m_value = read_pending; }
 
     // by range
     template <class T>
     from_iterator(InputIterator begin, T end,
       // enable_if ensures 2nd argument of 0 is treated as size, not range end
       typename boost::enable_if<boost::is_same<InputIterator, T>, void* >::type =0)
-      : m_begin(begin), m_end(end), m_default_end(false) { m_value = read_pending; }
+      : m_begin(begin), m_end(end), m_default_end(false),
+        m_first(begin) { m_value = read_pending; }
 
     // by_size
     from_iterator(InputIterator begin, std::size_t sz)
-      : m_begin(begin), m_end(begin), m_default_end(false)
+      : m_begin(begin), m_end(begin), m_default_end(false), m_first(begin)
     {
       std::advance(m_end, sz);
       m_value = read_pending;
     }
 
+    // by range, at position
+    from_iterator(InputIterator first, InputIterator last, InputIterator position)
+      : m_begin(position), m_end(last), m_default_end(false), m_first(first)
+      { m_value = read_pending; }
+
      typename base_type::reference
         dereference() const
      {
-        BOOST_ASSERT_MSG(!m_default_end && m_begin != m_end,
+        BOOST_ASSERT_MSG(!m_default_end && !at_end(),
           "Attempt to dereference end iterator");
         if (m_value == read_pending)
            extract_current();
@@ -779,59 +1053,55 @@ public:
 
      bool equal(const from_iterator& that) const
      {
-       if (m_default_end || m_begin == m_end)
-         return that.m_default_end || that.m_begin == that.m_end;
-       if (that.m_default_end || that.m_begin == that.m_end)
+       if (m_default_end || at_end())
+         return that.m_default_end || that.at_end();
+       if (that.m_default_end || that.at_end())
          return false;
        return m_begin == that.m_begin;
      }
 
      void increment()
      {
-        BOOST_ASSERT_MSG(!m_default_end && m_begin != m_end,
+        BOOST_ASSERT_MSG(!m_default_end && !at_end(),
           "Attempt to increment end iterator");
-        unsigned count = detail::utf8_byte_count(*m_begin);
-        std::advance(m_begin, count);
+        // the sequence length is only known once it has been decoded, and decoding
+        // never reads past m_end
+        if (m_value == read_pending)
+           extract_current();
+        m_begin = m_next;
         m_value = read_pending;
      }
+
+     void decrement()
+     {
+       BOOST_ASSERT_MSG(!m_default_end && m_begin != m_first,
+         "Attempt to decrement begin iterator");
+       // the sequence before m_begin must decode to exactly the units stepped back over
+       InputIterator last(m_begin);
+       --m_begin;
+       m_begin = utf8::sequence_start(m_first, m_begin);
+       m_next = m_begin;
+       char32 cp;
+       if (utf8::decode(m_next, last, cp) != detail::decode_ok || m_next != last)
+         invalid_sequence();
+       m_value = cp;
+     }
   private:
      static void invalid_sequence()
      {
-        std::out_of_range e(
-          "Invalid UTF-8 sequence encountered while trying to encode UTF-32 character");
-        BOOST_INTEROP_THROW(e);
+        detail::invalid_utf8_sequence();
      }
      void extract_current()const
      {
-        BOOST_ASSERT_MSG(m_begin != m_end,
+        BOOST_ASSERT_MSG(!at_end(),
           "Internal logic error: extracting from end iterator");
-        m_value = static_cast<char32>(static_cast< ::boost::uint8_t>(*m_begin));
-        // we must not have a continuation character:
-        if((m_value & 0xC0u) == 0x80u)
-           invalid_sequence();
-        // see how many extra byts we have:
-        unsigned extra = detail::utf8_trailing_byte_count(*m_begin);
-        // extract the extra bits, 6 from each extra byte:
-        InputIterator next(m_begin);
-        for(unsigned c = 0; c < extra; ++c)
-        {
-           ++next;
-           m_value <<= 6;
-           m_value += static_cast<boost::uint8_t>(*next) & 0x3Fu;
-        }
-        // we now need to remove a few of the leftmost bits, but how many depends
-        // upon how many extra bytes we've extracted:
-        static const boost::uint32_t masks[4] = 
-        {
-           0x7Fu,
-           0x7FFu,
-           0xFFFFu,
-           0x1FFFFFu,
-        };
-        m_value &= masks[extra];
-        // check the result:
-        if(m_value > static_cast<char32>(0x10FFFFu))
+        // overlong forms, encoded surrogates, values beyond U+10FFFF, and sequences
+        // truncated by the end of the range are all rejected
+        m_next = m_begin;
+        char32 cp;
+        if (utf8::decode(m_next, m_end, cp) != detail::decode_ok)
            invalid_sequence();
+        m_value = cp;
      }
   };
 
@@ -953,165 +1223,2436 @@ public:
      }
   };
 
-};
-
-//--------------------------------------------------------------------------------------//
-//                                 conversion_iterator                                  //
-//--------------------------------------------------------------------------------------//
-
-//  A conversion_iterator composes a ToCodec's to_iterator and a FromCodec's from_iterator
-//  into a single iterator that adapts an InputIterator to FromCodec's value_type to 
-//  behave as an iterator to the ToCodec's value_type.
+  //  utf8 block interface  ------------------------------------------------------------//
+  //
+  //  decode() rejects overlong forms, encoded surrogates, and sequences truncated by
+  //  the end of the range. from_iterator decodes through it, so it rejects them too.
 
-template <class ToCodec, class FromCodec, class InputIterator>
-class conversion_iterator
-  : public ToCodec::template to_iterator<
-      typename FromCodec::template from_iterator<InputIterator> >
-{
-public:
-  typedef typename FromCodec::template from_iterator<InputIterator>  from_iterator_type;
-  typedef typename ToCodec::template to_iterator<from_iterator_type>   to_iterator_type;
+  BOOST_STATIC_CONSTANT(std::size_t, max_units = 4);
 
-  conversion_iterator() BOOST_DEFAULTED
+  template <class InputIterator>
+  static detail::decode_status decode(InputIterator& first, InputIterator last,
+    char32& cp)
+  {
+    cp = static_cast< ::boost::uint8_t>(*first);
+    ++first;
+    if (cp < 0x80u)
+      return detail::decode_ok;
+    unsigned extra;
+    char32 min_value;
+    if ((cp & 0xE0u) == 0xC0u)      { extra = 1; cp &= 0x1Fu; min_value = 0x80u; }
+    else if ((cp & 0xF0u) == 0xE0u) { extra = 2; cp &= 0x0Fu; min_value = 0x800u; }
+    else if ((cp & 0xF8u) == 0xF0u) { extra = 3; cp &= 0x07u; min_value = 0x10000u; }
+    else
+      return detail::decode_invalid;  // continuation byte or 0xF8-0xFF
+    for (; extra; --extra)
+    {
+      if (first == last)
+        return detail::decode_incomplete;
+      ::boost::uint8_t c = static_cast< ::boost::uint8_t>(*first);
+      if ((c & 0xC0u) != 0x80u)
+        return detail::decode_invalid;  // c is not consumed
+      ++first;
+      cp = (cp << 6) | (c & 0x3Fu);
+    }
+    if (cp < min_value || cp > 0x10FFFFu || detail::is_surrogate(cp))
+      return detail::decode_invalid;
+    return detail::decode_ok;
+  }
 
-  conversion_iterator(InputIterator begin)
-    : to_iterator_type(from_iterator_type(begin)) {}
+  template <class OutputIterator>
+  static OutputIterator encode(char32 cp, OutputIterator out)
+  {
+    if (cp < 0x80u)
+      *out = static_cast<char>(cp);
+    else if (cp < 0x800u)
+    {
+      *out = static_cast<char>(0xC0u + (cp >> 6));
+      *++out = static_cast<char>(0x80u + (cp & 0x3Fu));
+    }
+    else if (cp < 0x10000u)
+    {
+      *out = static_cast<char>(0xE0u + (cp >> 12));
+      *++out = static_cast<char>(0x80u + ((cp >> 6) & 0x3Fu));
+      *++out = static_cast<char>(0x80u + (cp & 0x3Fu));
+    }
+    else
+    {
+      *out = static_cast<char>(0xF0u + (cp >> 18));
+      *++out = static_cast<char>(0x80u + ((cp >> 12) & 0x3Fu));
+      *++out = static_cast<char>(0x80u + ((cp >> 6) & 0x3Fu));
+      *++out = static_cast<char>(0x80u + (cp & 0x3Fu));
+    }
+    return ++out;
+  }
 
-  template <class U>
-  conversion_iterator(InputIterator begin, U end,
-    // enable_if ensures 2nd argument of 0 is treated as size, not range end
-    typename boost::enable_if<boost::is_same<InputIterator, U>, void* >::type = 0)
-    : to_iterator_type(from_iterator_type(begin, end)) {}
+  static std::size_t encoded_length(char32 cp)
+  {
+    return cp < 0x80u ? 1 : cp < 0x800u ? 2 : cp < 0x10000u ? 3 : 4;
+  }
+
+  //  a continuation byte belongs to the nearest lead byte at most three bytes back
+  //  whose sequence reaches it; one that no lead byte reaches is a sequence of its own
+  template <class BidirectionalIterator>
+  static BidirectionalIterator sequence_start(BidirectionalIterator first,
+    BidirectionalIterator p)
+  {
+    BidirectionalIterator q(p);
+    unsigned back = 0;
+    for (; back < 3 && q != first
+      && detail::is_continuation_byte(static_cast< ::boost::uint8_t>(*q)); ++back)
+      --q;
+    ::boost::uint8_t lead = static_cast< ::boost::uint8_t>(*q);
+    return !detail::is_continuation_byte(lead) && detail::utf8_byte_count(lead) > back
+      ? q : p;
+  }
+
+  static void invalid_input(char32) { detail::invalid_utf8_sequence(); }
+
+  //  Returns a pointer to the first invalid or truncated sequence in [first, last), or
+  //  last if there is none; see validate_utf8().
+  static const char* validate(const char* first, const char* last)
+  {
+    return first + detail::simd::validate_utf8(first, last - first);
+  }
 
-  conversion_iterator(InputIterator begin, std::size_t sz)
-    : to_iterator_type(from_iterator_type(begin, sz)) {}
+  //  Requires: first points to a sequence that validate() has accepted
+  template <class InputIterator>
+  static void decode_unchecked(InputIterator& first, char32& cp)
+  {
+    cp = static_cast< ::boost::uint8_t>(*first);
+    ++first;
+    if (cp < 0x80u)
+      return;
+    unsigned extra;
+    if (cp < 0xE0u)      { extra = 1; cp &= 0x1Fu; }
+    else if (cp < 0xF0u) { extra = 2; cp &= 0x0Fu; }
+    else                 { extra = 3; cp &= 0x07u; }
+    for (; extra; --extra, ++first)
+      cp = (cp << 6) | (static_cast< ::boost::uint8_t>(*first) & 0x3Fu);
+  }
 };
 
+#ifndef BOOST_WINDOWS_API
+
 //--------------------------------------------------------------------------------------//
-//                               make_string function                                   //
+//                                locale_narrow codec                                   //
 //--------------------------------------------------------------------------------------//
 
-//  container
-template <class ToCodec,
-# ifndef BOOST_NO_FUNCTION_TEMPLATE_DEFAULT_ARGS
-          class FromCodec = default_codec,
-          class ToString = std::basic_string<typename ToCodec::value_type>,
-# else
-          class FromCodec,
-          class ToString,
-# endif
-          class FromString> inline
-  // enable_if resolves ambiguity with single iterator overload
-typename boost::disable_if<boost::is_iterator<typename boost::decay<FromString>::type>,
-ToString>::type make_string(const FromString& s)
+//  locale_narrow, the POSIX narrow codec, encodes char as the codeset of the locale
+//  named by the environment (LC_ALL, LC_CTYPE, LANG), which is read once, on first use,
+//  by narrow_codepage(). A UTF-8 codeset, and also ASCII and any codeset without a
+//  table, select UTF-8; a single byte codeset with a table in codepage_tables.hpp, such
+//  as ISO-8859-1 or KOI8-R, selects that table. The per code point functions test the
+//  cached selection each time, but the block converters test it once per call and then
+//  run the utf8 or codepage kernels, so to_narrow() costs the same as to_utf8() when the
+//  locale is UTF-8.
+//
+//  Each block interface function, and each detail specialization for locale_narrow,
+//  also has a form taking the selection as its first argument, a table or 0 for UTF-8;
+//  the other form passes it narrow_codepage(). The tests use these to cover both
+//  encodings in whatever locale they run in.
+
+namespace detail
 {
-  typedef conversion_iterator<ToCodec,
-    typename FromCodec::template codec<typename FromString::value_type>::type,
-    typename FromString::const_iterator>
-      iter_type;
+  //  the codepage for the environment's locale codeset, or 0 for UTF-8
+  BOOST_INTEROP_DECL const codepage* detect_narrow_codepage();
 
-  return ToString(iter_type(s.begin(), s.end()), iter_type());
+  //  the codepage for codeset, an nl_langinfo(CODESET) value, or 0 for UTF-8
+  BOOST_INTEROP_DECL const codepage* codeset_codepage(const char* codeset);
 }
 
-//  null terminated iterator
-template <class ToCodec,
-# ifndef BOOST_NO_FUNCTION_TEMPLATE_DEFAULT_ARGS
-          class FromCodec = default_codec,
-          class ToString = std::basic_string<typename ToCodec::value_type>,
-# else
-          class FromCodec,
-          class ToString,
-# endif
-          class InputIterator> inline
-  // enable_if resolves ambiguity with FromString overload
-typename boost::enable_if<boost::is_iterator<InputIterator>,
-ToString>::type make_string(InputIterator begin)
+//  the codepage locale_narrow uses, or 0 if it uses UTF-8
+inline const codepage* narrow_codepage()
 {
-  typedef conversion_iterator<ToCodec,
-    typename FromCodec::template
-      codec<typename std::iterator_traits<InputIterator>::value_type>::type,
-    InputIterator>
-      iter_type;
-
-  return ToString(iter_type(begin), iter_type());
+  static const codepage* const table = detail::detect_narrow_codepage();
+  return table;
 }
 
-//  iterator, size
-template <class ToCodec,
-# ifndef BOOST_NO_FUNCTION_TEMPLATE_DEFAULT_ARGS
-          class FromCodec = default_codec,
-          class ToString = std::basic_string<typename ToCodec::value_type>,
-# else
-          class FromCodec,
-          class ToString,
-# endif
-          class InputIterator> inline
-ToString make_string(InputIterator begin, std::size_t sz)
+class locale_narrow
 {
-  typedef conversion_iterator<ToCodec,
-    typename FromCodec::template
-      codec<typename std::iterator_traits<InputIterator>::value_type>::type,
-    InputIterator>
-      iter_type;
+public:
+  typedef char value_type;
+  template <class charT> struct codec { typedef locale_narrow type; };
 
-  return ToString(iter_type(begin, sz), iter_type());
-}
+  //  locale_narrow::from_iterator  ----------------------------------------------------//
+  //
+  //  meets the DefaultCtorEndIterator requirements
 
-//  iterator range
-template <class ToCodec,
-# ifndef BOOST_NO_FUNCTION_TEMPLATE_DEFAULT_ARGS
-          class FromCodec = default_codec,
-          class ToString = std::basic_string<typename ToCodec::value_type>,
-# else
-          class FromCodec,
-          class ToString,
-# endif
-          class InputIterator, class InputIterator2>
-  // enable_if ensures 2nd argument of 0 is treated as size, not range end
-typename boost::enable_if<boost::is_iterator<InputIterator2>,
-ToString>::type make_string(InputIterator begin, InputIterator2 end)
-{
-  typedef conversion_iterator<ToCodec,
-    typename FromCodec::template
-      codec<typename std::iterator_traits<InputIterator>::value_type>::type,
-    InputIterator>
-      iter_type;
+  template <class InputIterator>
+  class from_iterator
+   : public boost::iterator_facade<from_iterator<InputIterator>,
+       char32, typename detail::bidirectional_category<InputIterator>::type, const char32>
+  {
+    typedef boost::iterator_facade<from_iterator<InputIterator>,
+      char32, typename detail::bidirectional_category<InputIterator>::type,
+      const char32> base_type;
+    // special value for pending iterator reads:
+    BOOST_STATIC_CONSTANT(char32, read_pending = 0xffffffffu);
 
-  return ToString(iter_type(begin, end), iter_type());
-}
+    typedef typename std::iterator_traits<InputIterator>::value_type base_value_type;
 
-//--------------------------------------------------------------------------------------//
-//                               make_string aliases                                    //
-//--------------------------------------------------------------------------------------//
+    BOOST_STATIC_ASSERT(sizeof(base_value_type)*CHAR_BIT == 8);
+    BOOST_STATIC_ASSERT(sizeof(char32)*CHAR_BIT == 32);
 
-//--------------------------------  to_narrow()  -------------------------------------//
-//  container
-template <
-# ifndef BOOST_NO_FUNCTION_TEMPLATE_DEFAULT_ARGS
-          class FromCodec = default_codec,
-          class ToString = std::basic_string<char>,
-# else
-          class FromCodec, class ToString,
-# endif
-          class FromString> inline
-  // disable_if resolves ambiguity with single iterator overload
-typename boost::disable_if<boost::is_iterator<typename boost::decay<FromString>::type>,
-ToString>::type
-to_narrow(const FromString& s) {return make_string<narrow, FromCodec, ToString>(s);}
+    InputIterator           m_begin;  // current position
+    InputIterator           m_end;
+    mutable char32          m_value;  // current value or read_pending
+    mutable InputIterator   m_next;   // end of current sequence unless read_pending
+    bool                    m_default_end;
+    InputIterator           m_first;  // start of the range, for decrement()
 
-//  null terminated iterator
-template <
-# ifndef BOOST_NO_FUNCTION_TEMPLATE_DEFAULT_ARGS
-          class FromCodec = default_codec,
-          class ToString = std::basic_string<char>,
-# else
-          class FromCodec, class ToString,
-# endif
-          class InputIterator> inline
-  // enable_if resolves ambiguity with FromString overload
-typename boost::enable_if<boost::is_iterator<InputIterator>,
-ToString>::type
-to_narrow(InputIterator begin) {return make_string<narrow, FromCodec, ToString>(begin);}
+    bool at_end() const
+      { return detail::null_terminated<InputIterator>::at_end(m_begin, m_end); }
+
+  public:
+
+    // end iterator
+    from_iterator() : m_default_end(true) {}
+
+    // by_null
+    from_iterator(InputIterator begin) : m_begin(begin),
+      m_end(detail::null_terminated<InputIterator>::end(begin)),
+      m_value(read_pending), m_default_end(false), m_first(begin) {}
+
+    // by range
+    template <class T>
+    from_iterator(InputIterator begin, T end,
+      // enable_if ensures 2nd argument of 0 is treated as size, not range end
+      typename boost::enable_if<boost::is_same<InputIterator, T>, void* >::type =0)
+      : m_begin(begin), m_end(end), m_value(read_pending), m_default_end(false),
+        m_first(begin) {}
+
+    // by_size
+    from_iterator(InputIterator begin, std::size_t sz)
+      : m_begin(begin), m_end(begin), m_value(read_pending), m_default_end(false),
+        m_first(begin)
+      { std::advance(m_end, sz); }
+
+    // by range, at position
+    from_iterator(InputIterator first, InputIterator last, InputIterator position)
+      : m_begin(position), m_end(last), m_value(read_pending), m_default_end(false),
+        m_first(first) {}
+
+    typename base_type::reference dereference() const
+    {
+      BOOST_ASSERT_MSG(!m_default_end && !at_end(),
+        "Attempt to dereference end iterator");
+      if (m_value == read_pending)
+        extract_current();
+      return m_value;
+    }
+
+    bool equal(const from_iterator& that) const
+    {
+      if (m_default_end || at_end())
+        return that.m_default_end || that.at_end();
+      if (that.m_default_end || that.at_end())
+        return false;
+      return m_begin == that.m_begin;
+    }
+
+    void increment()
+    {
+      BOOST_ASSERT_MSG(!m_default_end && !at_end(),
+        "Attempt to increment end iterator");
+      if (m_value == read_pending)
+        extract_current();
+      m_begin = m_next;
+      m_value = read_pending;
+    }
+
+    void decrement()
+    {
+      BOOST_ASSERT_MSG(!m_default_end && m_begin != m_first,
+        "Attempt to decrement begin iterator");
+      // the sequence before m_begin must decode to exactly the units stepped back over
+      InputIterator last(m_begin);
+      --m_begin;
+      m_begin = locale_narrow::sequence_start(m_first, m_begin);
+      m_next = m_begin;
+      char32 cp;
+      if (locale_narrow::decode(m_next, last, cp) != detail::decode_ok || m_next != last)
+        locale_narrow::invalid_input(cp);
+      m_value = cp;
+    }
+
+  private:
+    void extract_current() const
+    {
+      m_next = m_begin;
+      char32 cp;
+      if (locale_narrow::decode(m_next, m_end, cp) != detail::decode_ok)
+        locale_narrow::invalid_input(cp);
+      m_value = cp;
+    }
+  };
+
+  //  locale_narrow::to_iterator  ------------------------------------------------------//
+  //
+  //  meets the DefaultCtorEndIterator requirements
+
+  template <class InputIterator>
+  class to_iterator
+   : public boost::iterator_facade<to_iterator<InputIterator>,
+       char, std::input_iterator_tag, const char>
+  {
+    typedef boost::iterator_facade<to_iterator<InputIterator>,
+      char, std::input_iterator_tag, const char> base_type;
+
+    typedef typename std::iterator_traits<InputIterator>::value_type base_value_type;
+
+    BOOST_STATIC_ASSERT(sizeof(base_value_type)*CHAR_BIT == 32);
+    BOOST_STATIC_ASSERT(sizeof(char)*CHAR_BIT == 8);
+
+    InputIterator     m_begin;
+    mutable char      m_units[4];
+    mutable unsigned  m_size;     // units in m_units, or 0 if a read is pending
+    mutable unsigned  m_current;
+
+  public:
+    // construct:
+    to_iterator() : m_begin(InputIterator()), m_size(0), m_current(0) {}
+    to_iterator(InputIterator begin) : m_begin(begin), m_size(0), m_current(0) {}
+
+    typename base_type::reference dereference() const
+    {
+      if (!m_size)
+        extract_current();
+      return m_units[m_current];
+    }
+
+    bool equal(const to_iterator& that) const
+    {
+      return m_begin == that.m_begin && m_current == that.m_current;
+    }
+
+    void increment()
+    {
+      if (!m_size)
+        extract_current();
+      if (++m_current == m_size)
+      {
+        m_size = 0;
+        m_current = 0;
+        ++m_begin;  // may change m_begin to end iterator
+      }
+    }
+
+  private:
+    void extract_current() const
+    {
+      char32 c = *m_begin;
+      if (c > 0x10FFFFu)
+        detail::invalid_utf32_code_point(c);
+      m_size = static_cast<unsigned>(locale_narrow::encode(c, m_units) - m_units);
+    }
+  };
+
+  //  locale_narrow block interface  ---------------------------------------------------//
+
+  BOOST_STATIC_CONSTANT(std::size_t, max_units = utf8::max_units);
+
+  template <class InputIterator>
+  static detail::decode_status decode(InputIterator& first, InputIterator last,
+    char32& cp)
+    { return decode(narrow_codepage(), first, last, cp); }
+
+  template <class InputIterator>
+  static detail::decode_status decode(const codepage* table, InputIterator& first,
+    InputIterator last, char32& cp)
+  {
+    if (table)
+    {
+      cp = table->decode(*first);
+      ++first;
+      return detail::decode_ok;
+    }
+    return utf8::decode(first, last, cp);
+  }
+
+  template <class OutputIterator>
+  static OutputIterator encode(char32 cp, OutputIterator out)
+    { return encode(narrow_codepage(), cp, out); }
+
+  template <class OutputIterator>
+  static OutputIterator encode(const codepage* table, char32 cp, OutputIterator out)
+  {
+    if (table)
+    {
+      *out = table->encode(cp);
+      return ++out;
+    }
+    return utf8::encode(cp, out);
+  }
+
+  static std::size_t encoded_length(char32 cp)
+    { return encoded_length(narrow_codepage(), cp); }
+
+  static std::size_t encoded_length(const codepage* table, char32 cp)
+  {
+    return table ? 1 : utf8::encoded_length(cp);
+  }
+
+  template <class BidirectionalIterator>
+  static BidirectionalIterator sequence_start(BidirectionalIterator first,
+    BidirectionalIterator p)
+    { return sequence_start(narrow_codepage(), first, p); }
+
+  template <class BidirectionalIterator>
+  static BidirectionalIterator sequence_start(const codepage* table,
+    BidirectionalIterator first, BidirectionalIterator p)
+  {
+    return table ? p : utf8::sequence_start(first, p);
+  }
+
+  static void invalid_input(char32 cp) { invalid_input(narrow_codepage(), cp); }
+
+  static void invalid_input(const codepage* table, char32 cp)
+  {
+    if (!table)
+      utf8::invalid_input(cp);
+  }
+
+  static const char* validate(const char* first, const char* last)
+    { return validate(narrow_codepage(), first, last); }
+
+  static const char* validate(const codepage* table, const char* first,
+    const char* last)
+  {
+    return table ? last : utf8::validate(first, last);
+  }
+
+  template <class InputIterator>
+  static void decode_unchecked(InputIterator& first, char32& cp)
+    { decode_unchecked(narrow_codepage(), first, cp); }
+
+  template <class InputIterator>
+  static void decode_unchecked(const codepage* table, InputIterator& first,
+    char32& cp)
+  {
+    if (table)
+    {
+      cp = table->decode(*first);
+      ++first;
+    }
+    else
+      utf8::decode_unchecked(first, cp);
+  }
+};  // locale_narrow
+
+#endif  // BOOST_WINDOWS_API
+
+//--------------------------------------------------------------------------------------//
+//                                conversion statistics                                 //
+//--------------------------------------------------------------------------------------//
+
+//  With BOOST_INTEROP_STATS defined, the BOOST_INTEROP_STATS_* macros (see
+//  detail/config.hpp) count into the calling thread's counters for the codec pair; see
+//  conversion_stats.hpp.
+
+#ifdef BOOST_INTEROP_STATS
+namespace detail
+{
+  //  the name of Codec in conversion_stats
+  template <class Codec>
+  struct codec_name { static const char* name() { return "codec"; } };
+  template <>
+  struct codec_name<utf8> { static const char* name() { return "utf8"; } };
+  template <class charT>
+  struct codec_name<generic_utf16<charT> >
+    { static const char* name() { return "utf16"; } };
+  template <class charT>
+  struct codec_name<generic_utf32<charT> >
+    { static const char* name() { return "utf32"; } };
+  template <class Table>
+  struct codec_name<narrow_codec<Table> >
+    { static const char* name() { return codepage_name(Table::to_utf16); } };
+#ifndef BOOST_WINDOWS_API
+  template <>
+  struct codec_name<locale_narrow> { static const char* name() { return "narrow"; } };
+#endif
+
+  template <class ToCodec, class FromCodec>
+  inline stats_counters& pair_counters()
+  {
+    static const std::size_t pair = register_codec_pair(codec_name<ToCodec>::name(),
+      codec_name<FromCodec>::name());
+    return thread_counters(pair);
+  }
+
+  template <class ToCodec, class FromCodec>
+  inline void count_call(std::size_t input_units, std::size_t output_units, bool fast)
+  {
+    stats_counters& counters = pair_counters<ToCodec, FromCodec>();
+    stats_add(counters.calls, 1);
+    stats_add(counters.input_units, input_units);
+    stats_add(counters.output_units, output_units);
+    stats_add(fast ? counters.fast_path : counters.fallback_path, 1);
+  }
+
+  template <class ToCodec, class FromCodec>
+  inline void count_units(std::size_t input_units, std::size_t output_units)
+  {
+    stats_counters& counters = pair_counters<ToCodec, FromCodec>();
+    stats_add(counters.input_units, input_units);
+    stats_add(counters.output_units, output_units);
+  }
+
+  template <class ToCodec, class FromCodec>
+  inline void count_error()
+  {
+    stats_add(pair_counters<ToCodec, FromCodec>().errors, 1);
+  }
+
+  //  the length of [first, last), or 0 if it cannot be measured without consuming it
+  template <class InputIterator>
+  inline std::size_t stats_distance(InputIterator, InputIterator,
+    std::input_iterator_tag)
+  {
+    return 0;
+  }
+
+  template <class ForwardIterator>
+  inline std::size_t stats_distance(ForwardIterator first, ForwardIterator last,
+    std::forward_iterator_tag)
+  {
+    return std::distance(first, last);
+  }
+
+  template <class InputIterator>
+  inline std::size_t stats_distance(InputIterator first, InputIterator last)
+  {
+    return stats_distance(first, last,
+      typename std::iterator_traits<InputIterator>::iterator_category());
+  }
+} // namespace detail
+#endif
+
+//--------------------------------------------------------------------------------------//
+//                                 conversion_iterator                                  //
+//--------------------------------------------------------------------------------------//
+
+//  A conversion_iterator composes a ToCodec's to_iterator and a FromCodec's from_iterator
+//  into a single iterator that adapts an InputIterator to FromCodec's value_type to 
+//  behave as an iterator to the ToCodec's value_type.
+//
+//  For codec pairs where detail::has_fused_conversion is true, it instead derives from
+//  detail::fused_conversion_iterator, which converts each code point straight from
+//  FromCodec units into a small buffer of ToCodec units in one step, rather than through
+//  two layers of iterators that each track a pending read. Both codecs must then be
+//  BlockCodecs. The mechanism is open: specialize has_fused_conversion to enable it for
+//  another pair, and codec_pair_step to replace the default decode() then encode().
+//
+//  When InputIterator is bidirectional, the from_iterators are bidirectional, and so is
+//  conversion_iterator for any pair of BlockCodecs, which then always uses the fused
+//  form. Stepping back finds the start of the previous sequence with
+//  FromCodec::sequence_start() and decodes it forward, so invalid input is reported in
+//  either direction. The end iterator T() cannot be decremented; construct the end
+//  with conversion_iterator(first, last, last) for std::reverse_iterator and similar
+//  algorithms.
+
+namespace detail
+{
+  template <class Codec> struct has_block_interface : boost::false_type {};
+  template <> struct has_block_interface<utf8> : boost::true_type {};
+  template <class charT>
+    struct has_block_interface<generic_utf16<charT> > : boost::true_type {};
+  template <class charT>
+    struct has_block_interface<generic_utf32<charT> > : boost::true_type {};
+  template <class Table>
+    struct has_block_interface<narrow_codec<Table> > : boost::true_type {};
+#ifndef BOOST_WINDOWS_API
+  template <> struct has_block_interface<locale_narrow> : boost::true_type {};
+#endif
+
+  template <class ToCodec, class FromCodec>
+  struct has_fused_conversion : boost::false_type {};
+
+  template <class charT>
+    struct has_fused_conversion<generic_utf16<charT>, utf8> : boost::true_type {};
+  template <class charT>
+    struct has_fused_conversion<utf8, generic_utf16<charT> > : boost::true_type {};
+  template <class charT>  // wide on POSIX
+    struct has_fused_conversion<generic_utf32<charT>, utf8> : boost::true_type {};
+  template <class charT>
+    struct has_fused_conversion<utf8, generic_utf32<charT> > : boost::true_type {};
+  template <class Table>
+    struct has_fused_conversion<narrow_codec<Table>, utf8> : boost::true_type {};
+  template <class Table>
+    struct has_fused_conversion<utf8, narrow_codec<Table> > : boost::true_type {};
+#ifndef BOOST_WINDOWS_API
+  template <class charT>
+    struct has_fused_conversion<generic_utf16<charT>, locale_narrow>
+      : boost::true_type {};
+  template <class charT>
+    struct has_fused_conversion<locale_narrow, generic_utf16<charT> >
+      : boost::true_type {};
+  template <class charT>
+    struct has_fused_conversion<generic_utf32<charT>, locale_narrow>
+      : boost::true_type {};
+  template <class charT>
+    struct has_fused_conversion<locale_narrow, generic_utf32<charT> >
+      : boost::true_type {};
+#endif
+
+  //  codec_pair_step<ToCodec, FromCodec>::step(first, last, out) converts the code point
+  //  at first, advancing first past it, writes its ToCodec units to out, and returns
+  //  their number. Invalid input is reported by FromCodec::invalid_input().
+  template <class ToCodec, class FromCodec>
+  struct codec_pair_step
+  {
+    template <class InputIterator>
+    static std::size_t step(InputIterator& first, InputIterator last,
+      typename ToCodec::value_type* out)
+    {
+      char32 cp;
+      if (FromCodec::decode(first, last, cp) != decode_ok)
+        FromCodec::invalid_input(cp);
+      return ToCodec::encode(cp, out) - out;
+    }
+  };
+
+  //  fused_conversion_iterator  -------------------------------------------------------//
+  //
+  //  meets the DefaultCtorEndIterator requirements. Each code point is converted as soon
+  //  as the iterator reaches it, so that dereference() and equal() need not test for a
+  //  pending read. Over a bidirectional range it is a bidirectional iterator; only an
+  //  iterator constructed with a position, and those derived from it, can be
+  //  decremented from the end.
+
+  template <class ToCodec, class FromCodec, class InputIterator>
+  class fused_conversion_iterator
+    : public boost::iterator_facade<
+        fused_conversion_iterator<ToCodec, FromCodec, InputIterator>,
+        typename ToCodec::value_type,
+        typename bidirectional_category<InputIterator>::type,
+        const typename ToCodec::value_type>
+  {
+    typedef typename ToCodec::value_type to_type;
+
+    InputIterator  m_first;  // start of the range, for decrement()
+    InputIterator  m_pos;    // start of the code point in m_units
+    InputIterator  m_begin;  // start of the code point after m_units
+    InputIterator  m_end;
+    to_type        m_units[ToCodec::max_units];
+    unsigned       m_current;  // index of the current unit in m_units
+    unsigned       m_size;     // units in m_units; 0 at the end
+
+  public:
+
+    // end iterator
+    fused_conversion_iterator() : m_begin(), m_end(), m_current(0), m_size(0) {}
+
+    // by_null
+    fused_conversion_iterator(InputIterator begin) : m_first(begin), m_begin(begin),
+      m_end(null_terminated<InputIterator>::end(begin)) { extract_current(); }
+
+    // by range
+    template <class T>
+    fused_conversion_iterator(InputIterator begin, T end,
+      // enable_if ensures 2nd argument of 0 is treated as size, not range end
+      typename boost::enable_if<boost::is_same<InputIterator, T>, void* >::type = 0)
+      : m_first(begin), m_begin(begin), m_end(end) { extract_current(); }
+
+    // by_size
+    fused_conversion_iterator(InputIterator begin, std::size_t sz)
+      : m_first(begin), m_begin(begin), m_end(begin)
+    {
+      std::advance(m_end, sz);
+      extract_current();
+    }
+
+    // by range, at position
+    fused_conversion_iterator(InputIterator first, InputIterator last,
+      InputIterator position)
+      : m_first(first), m_begin(position), m_end(last) { extract_current(); }
+
+    const to_type& dereference() const
+    {
+      BOOST_ASSERT_MSG(m_size, "Attempt to dereference end iterator");
+      return m_units[m_current];
+    }
+
+    bool equal(const fused_conversion_iterator& that) const
+    {
+      if (!m_size || !that.m_size)
+        return m_size == that.m_size;
+      return m_begin == that.m_begin && m_current == that.m_current;
+    }
+
+    void increment()
+    {
+      BOOST_ASSERT_MSG(m_size, "Attempt to increment end iterator");
+      if (++m_current == m_size)
+        extract_current();
+    }
+
+    void decrement()
+    {
+      if (m_current)
+      {
+        --m_current;
+        return;
+      }
+      BOOST_ASSERT_MSG(m_pos != m_first, "Attempt to decrement begin iterator");
+      // the sequence before m_pos must decode to exactly the units stepped back over
+      m_begin = m_pos;
+      --m_pos;
+      m_pos = FromCodec::sequence_start(m_first, m_pos);
+      InputIterator next(m_pos);
+      char32 cp;
+      if (FromCodec::decode(next, m_begin, cp) != decode_ok || next != m_begin)
+        FromCodec::invalid_input(cp);
+      m_size = static_cast<unsigned>(ToCodec::encode(cp, m_units) - m_units);
+      m_current = m_size - 1;
+    }
+
+  private:
+    void extract_current()
+    {
+      m_current = 0;
+      m_pos = m_begin;
+      if (null_terminated<InputIterator>::at_end(m_begin, m_end))
+        m_size = 0;
+      else
+      {
+        // work on a local copy so the compiler can keep it in a register
+        InputIterator first(m_begin);
+        m_size = static_cast<unsigned>(
+          codec_pair_step<ToCodec, FromCodec>::step(first, m_end, m_units));
+        m_begin = first;
+      }
+    }
+  };
+
+  //  conversion_iterator_base<...>::type is conversion_iterator's base class; make()
+  //  constructs it from conversion_iterator's constructor arguments
+
+  //  the to_iterators cannot be decremented, so any pair of BlockCodecs is fused over a
+  //  bidirectional range
+  template <class ToCodec, class FromCodec, class InputIterator>
+  struct use_fused_conversion
+    : boost::integral_constant<bool,
+        has_fused_conversion<ToCodec, FromCodec>::value
+        || (boost::is_same<typename bidirectional_category<InputIterator>::type,
+              std::bidirectional_iterator_tag>::value
+            && has_block_interface<ToCodec>::value
+            && has_block_interface<FromCodec>::value)>
+  {};
+
+  template <class ToCodec, class FromCodec, class InputIterator,
+    bool Fused = use_fused_conversion<ToCodec, FromCodec, InputIterator>::value>
+  struct conversion_iterator_base
+  {
+    typedef typename FromCodec::template from_iterator<InputIterator> from_iterator_type;
+    typedef typename ToCodec::template to_iterator<from_iterator_type>  type;
+
+    static type make(InputIterator begin)
+      { return type(from_iterator_type(begin)); }
+    static type make(InputIterator begin, InputIterator end)
+      { return type(from_iterator_type(begin, end)); }
+    static type make(InputIterator begin, std::size_t sz)
+      { return type(from_iterator_type(begin, sz)); }
+    static type make(InputIterator first, InputIterator last, InputIterator position)
+      { return type(from_iterator_type(first, last, position)); }
+  };
+
+  template <class ToCodec, class FromCodec, class InputIterator>
+  struct conversion_iterator_base<ToCodec, FromCodec, InputIterator, true>
+  {
+    typedef fused_conversion_iterator<ToCodec, FromCodec, InputIterator> type;
+
+    static type make(InputIterator begin) { return type(begin); }
+    static type make(InputIterator begin, InputIterator end) { return type(begin, end); }
+    static type make(InputIterator begin, std::size_t sz) { return type(begin, sz); }
+    static type make(InputIterator first, InputIterator last, InputIterator position)
+      { return type(first, last, position); }
+  };
+} // namespace detail
+
+template <class ToCodec, class FromCodec, class InputIterator>
+class conversion_iterator
+  : public detail::conversion_iterator_base<ToCodec, FromCodec, InputIterator>::type
+{
+  typedef detail::conversion_iterator_base<ToCodec, FromCodec, InputIterator> base_maker;
+  typedef detail::use_fused_conversion<ToCodec, FromCodec, InputIterator> fused;
+public:
+  typedef typename FromCodec::template from_iterator<InputIterator>  from_iterator_type;
+  typedef typename ToCodec::template to_iterator<from_iterator_type>   to_iterator_type;
+
+  conversion_iterator() BOOST_DEFAULTED
+
+  conversion_iterator(InputIterator begin)
+    : base_maker::type(base_maker::make(begin))
+    { BOOST_INTEROP_STATS_CALL(ToCodec, FromCodec, 0, 0, fused::value); }
+
+  template <class U>
+  conversion_iterator(InputIterator begin, U end,
+    // enable_if ensures 2nd argument of 0 is treated as size, not range end
+    typename boost::enable_if<boost::is_same<InputIterator, U>, void* >::type = 0)
+    : base_maker::type(base_maker::make(begin, end))
+  {
+    BOOST_INTEROP_STATS_CALL(ToCodec, FromCodec, detail::stats_distance(begin, end), 0,
+      fused::value);
+  }
+
+  conversion_iterator(InputIterator begin, std::size_t sz)
+    : base_maker::type(base_maker::make(begin, sz))
+    { BOOST_INTEROP_STATS_CALL(ToCodec, FromCodec, sz, 0, fused::value); }
+
+  //  at position within [first, last); with position == last, an end iterator that can
+  //  be decremented
+  conversion_iterator(InputIterator first, InputIterator last, InputIterator position)
+    : base_maker::type(base_maker::make(first, last, position)) {}
+};
+
+//--------------------------------------------------------------------------------------//
+//                                  error policies                                      //
+//--------------------------------------------------------------------------------------//
+
+//  An ErrorPolicy passed as the final argument to make_string() selects, at compile
+//  time, what happens to invalid input:
+//
+//  throw_on_error     throw std::out_of_range, as make_string() without a policy does.
+//  replace_on_error   replace each invalid sequence with U+FFFD, or with '?' when the
+//                     target is a single byte narrow encoding.
+//  skip_on_error      drop each invalid sequence.
+//  stop_on_error      stop at the first invalid sequence. stop_on_error(offset) sets
+//                     offset to the number of input units converted; that is the offset
+//                     of the invalid sequence, or the input length if there is none.
+//  assume_valid       trust the input to be valid. A conversion between the same
+//                     encoding copies it without validating it; other conversions still
+//                     check it, and throw as throw_on_error does.
+//
+//  An invalid sequence is one that FromCodec::decode() rejects, including one truncated
+//  by the end of the input. Only throw_on_error and assume_valid involve exceptions, and
+//  no policy adds work to the loops that convert valid input. Both codecs must be
+//  BlockCodecs, and a source that is not contiguous must be a forward iterator range.
+
+struct throw_on_error {};
+struct replace_on_error {};
+struct skip_on_error {};
+struct assume_valid {};
+
+class stop_on_error
+{
+public:
+  explicit stop_on_error(std::size_t& offset) : m_offset(&offset) {}
+  void converted(std::size_t n) const { *m_offset = n; }
+private:
+  std::size_t* m_offset;
+};
+
+template <class T> struct is_error_policy : boost::false_type {};
+template <> struct is_error_policy<throw_on_error> : boost::true_type {};
+template <> struct is_error_policy<replace_on_error> : boost::true_type {};
+template <> struct is_error_policy<skip_on_error> : boost::true_type {};
+template <> struct is_error_policy<stop_on_error> : boost::true_type {};
+template <> struct is_error_policy<assume_valid> : boost::true_type {};
+
+namespace detail
+{
+  //  code point substituted for invalid input by replace_on_error
+  template <class Codec>
+  struct replacement_character { BOOST_STATIC_CONSTANT(char32, value = 0xFFFDu); };
+  template <class Table>
+  struct replacement_character<narrow_codec<Table> >
+    { BOOST_STATIC_CONSTANT(char32, value = '?'); };
+
+  //  on_invalid<ToCodec, FromCodec>(first, last, cp, s, policy) applies policy to the
+  //  invalid or incomplete sequence at first, for which FromCodec::decode() set cp,
+  //  appending any replacement to s and advancing first past the sequence. Returns
+  //  false if conversion is to stop at first.
+
+  template <class FromCodec, class InputIterator>
+  inline void skip_sequence(InputIterator& first, InputIterator last)
+  {
+    char32 cp;
+    FromCodec::decode(first, last, cp);  // always consumes at least one unit
+  }
+
+  template <class ToCodec, class FromCodec, class InputIterator, class String>
+  inline bool on_invalid(InputIterator&, InputIterator, char32 cp, String&,
+    throw_on_error)
+  {
+    BOOST_INTEROP_STATS_ERROR(ToCodec, FromCodec);
+    FromCodec::invalid_input(cp);
+    return false;
+  }
+
+  template <class ToCodec, class FromCodec, class InputIterator, class String>
+  inline bool on_invalid(InputIterator&, InputIterator, char32 cp, String&,
+    assume_valid)
+  {
+    BOOST_INTEROP_STATS_ERROR(ToCodec, FromCodec);
+    FromCodec::invalid_input(cp);
+    return false;
+  }
+
+  template <class ToCodec, class FromCodec, class InputIterator, class String>
+  inline bool on_invalid(InputIterator& first, InputIterator last, char32, String& s,
+    replace_on_error)
+  {
+    BOOST_INTEROP_STATS_ERROR(ToCodec, FromCodec);
+    skip_sequence<FromCodec>(first, last);
+    ToCodec::encode(replacement_character<ToCodec>::value, std::back_inserter(s));
+    return true;
+  }
+
+  template <class ToCodec, class FromCodec, class InputIterator, class String>
+  inline bool on_invalid(InputIterator& first, InputIterator last, char32, String&,
+    skip_on_error)
+  {
+    BOOST_INTEROP_STATS_ERROR(ToCodec, FromCodec);
+    skip_sequence<FromCodec>(first, last);
+    return true;
+  }
+
+  template <class ToCodec, class FromCodec, class InputIterator, class String>
+  inline bool on_invalid(InputIterator&, InputIterator, char32, String&, stop_on_error)
+  {
+    BOOST_INTEROP_STATS_ERROR(ToCodec, FromCodec);
+    return false;
+  }
+
+  //  tell policy how many input units were converted
+  template <class ErrorPolicy>
+  inline void report_converted(ErrorPolicy, std::size_t) {}
+  inline void report_converted(stop_on_error policy, std::size_t n)
+  {
+    policy.converted(n);
+  }
+} // namespace detail
+
+//--------------------------------------------------------------------------------------//
+//                              block transcoding kernels                               //
+//--------------------------------------------------------------------------------------//
+
+//  When both codecs are BlockCodecs, the source is a contiguous range, and the result
+//  is a contiguous string, make_string() converts the whole buffer in a tight
+//  decode/encode loop that writes directly into the result, rather than paying for a
+//  conversion_iterator dereference/increment/equal per code unit. Other sources still
+//  use conversion_iterator.
+//
+//  Runs of ASCII are converted by detail::simd::copy_ascii() many units at a time when
+//  both codecs are ASCII compatible; only non-ASCII code points go through the scalar
+//  decode() and encode(). Between narrow_codec and UTF-16 or UTF-32, the codepage
+//  tables themselves are applied a block at a time by detail::simd::decode_codepage()
+//  and detail::simd::encode_codepage(). Between two codecs for the same encoding, valid
+//  input is not converted at all, but validated and copied.
+
+namespace detail
+{
+  //  true if units below 0x80 decode to, and are encoded from, the same code point
+  template <class Codec> struct is_ascii_compatible : boost::false_type {};
+  template <> struct is_ascii_compatible<utf8> : boost::true_type {};
+  template <class charT>
+    struct is_ascii_compatible<generic_utf16<charT> > : boost::true_type {};
+  template <class charT>
+    struct is_ascii_compatible<generic_utf32<charT> > : boost::true_type {};
+  template <class Table>  // see codepage_tables.hpp
+    struct is_ascii_compatible<narrow_codec<Table> > : boost::true_type {};
+#ifndef BOOST_WINDOWS_API
+  template <> struct is_ascii_compatible<locale_narrow> : boost::true_type {};
+#endif
+
+  //  true if Codec supplies validate(first, last) and decode_unchecked(first, cp), so
+  //  that a source can be validated in one vectorized pass and then decoded without
+  //  per-sequence checks
+  template <class Codec> struct has_validator : boost::false_type {};
+  template <> struct has_validator<utf8> : boost::true_type {};
+#ifndef BOOST_WINDOWS_API
+  template <> struct has_validator<locale_narrow> : boost::true_type {};
+#endif
+
+  //  true if ToCodec and FromCodec are the same encoding, with units of the same size,
+  //  so that valid input converts to a copy of itself. FromCodec must supply
+  //  validate(first, last). locale_narrow is only UTF-8 while narrow_codepage() selects
+  //  no table, which copies_as_is() tests; a table converts the bytes it leaves
+  //  undefined.
+  template <class ToCodec, class FromCodec>
+  struct is_same_encoding : boost::false_type {};
+  template <> struct is_same_encoding<utf8, utf8> : boost::true_type {};
+  template <class charT, class charT2>
+  struct is_same_encoding<generic_utf16<charT2>, generic_utf16<charT> >
+    : boost::integral_constant<bool, sizeof(charT2) == sizeof(charT)> {};
+  template <class charT, class charT2>
+  struct is_same_encoding<generic_utf32<charT2>, generic_utf32<charT> >
+    : boost::integral_constant<bool, sizeof(charT2) == sizeof(charT)> {};
+#ifndef BOOST_WINDOWS_API
+  template <>
+  struct is_same_encoding<locale_narrow, locale_narrow> : boost::true_type {};
+  template <>
+  struct is_same_encoding<utf8, locale_narrow> : boost::true_type {};
+  template <>
+  struct is_same_encoding<locale_narrow, utf8> : boost::true_type {};
+#endif
+
+  template <class Codec> struct is_locale_narrow : boost::false_type {};
+#ifndef BOOST_WINDOWS_API
+  template <> struct is_locale_narrow<locale_narrow> : boost::true_type {};
+#endif
+
+  //  for a pair that is_same_encoding, true unless either codec is a locale_narrow
+  //  that narrow_codepage(), or table, has given a table
+  template <class ToCodec, class FromCodec>
+  inline bool copies_as_is(const codepage* table)
+  {
+    return !(is_locale_narrow<ToCodec>::value || is_locale_narrow<FromCodec>::value)
+      || !table;
+  }
+
+  template <class ToCodec, class FromCodec>
+  inline bool copies_as_is()
+  {
+#ifndef BOOST_WINDOWS_API
+    if (is_locale_narrow<ToCodec>::value || is_locale_narrow<FromCodec>::value)
+      return copies_as_is<ToCodec, FromCodec>(narrow_codepage());
+#endif
+    return true;
+  }
+
+  //  length_counter<ToCodec, FromCodec>::count(first, last) returns the number of
+  //  ToCodec units converting the valid input [first, last) produces. The general case
+  //  decodes each code point; the UTF pairs count units directly from the input.
+
+  template <class ToCodec, class FromCodec>
+  struct length_counter
+  {
+    static std::size_t count(const typename FromCodec::value_type* first,
+      const typename FromCodec::value_type* last)
+    {
+      std::size_t n = 0;
+      char32 cp;
+      while (first != last && FromCodec::decode(first, last, cp) == decode_ok)
+        n += ToCodec::encoded_length(cp);
+      return n;
+    }
+  };
+
+  template <class charT>
+  struct length_counter<generic_utf16<charT>, utf8>
+  {
+    static std::size_t count(const char* first, const char* last)
+      { return simd::length_from_utf8<true>(first, last - first); }
+  };
+
+  template <class charT>
+  struct length_counter<generic_utf32<charT>, utf8>
+  {
+    static std::size_t count(const char* first, const char* last)
+      { return simd::length_from_utf8<false>(first, last - first); }
+  };
+
+  template <class charT>
+  struct length_counter<utf8, generic_utf16<charT> >
+  {
+    static std::size_t count(const charT* first, const charT* last)
+      { return simd::utf8_length_from_utf16(first, last - first); }
+  };
+
+  template <class charT, class charT2>
+  struct length_counter<generic_utf32<charT2>, generic_utf16<charT> >
+  {
+    static std::size_t count(const charT* first, const charT* last)
+      { return simd::utf32_length_from_utf16(first, last - first); }
+  };
+
+  template <class charT>
+  struct length_counter<utf8, generic_utf32<charT> >
+  {
+    static std::size_t count(const charT* first, const charT* last)
+      { return simd::utf8_length_from_utf32(first, last - first); }
+  };
+
+  template <class charT, class charT2>
+  struct length_counter<generic_utf16<charT2>, generic_utf32<charT> >
+  {
+    static std::size_t count(const charT* first, const charT* last)
+      { return simd::utf16_length_from_utf32(first, last - first); }
+  };
+
+  //  one unit out per unit in: the same encoding, or a single byte codepage, whose code
+  //  points are all in the BMP, to UTF-16 or UTF-32
+
+  template <>
+  struct length_counter<utf8, utf8>
+  {
+    static std::size_t count(const char* first, const char* last)
+      { return last - first; }
+  };
+
+  template <class charT, class charT2>
+  struct length_counter<generic_utf16<charT2>, generic_utf16<charT> >
+  {
+    static std::size_t count(const charT* first, const charT* last)
+      { return last - first; }
+  };
+
+  template <class charT, class charT2>
+  struct length_counter<generic_utf32<charT2>, generic_utf32<charT> >
+  {
+    static std::size_t count(const charT* first, const charT* last)
+      { return last - first; }
+  };
+
+  template <class charT, class Table>
+  struct length_counter<generic_utf16<charT>, narrow_codec<Table> >
+  {
+    static std::size_t count(const char* first, const char* last)
+      { return last - first; }
+  };
+
+  template <class charT, class Table>
+  struct length_counter<generic_utf32<charT>, narrow_codec<Table> >
+  {
+    static std::size_t count(const char* first, const char* last)
+      { return last - first; }
+  };
+
+  //  a single byte codepage has one unit per code point
+  template <class Table, class FromCodec>
+  struct length_counter<narrow_codec<Table>, FromCodec>
+    : length_counter<utf32, FromCodec> {};
+
+#ifndef BOOST_WINDOWS_API
+  //  locale_narrow counts as utf8 unless narrow_codepage() selects a table, which has
+  //  one byte per code point
+
+  template <class ToCodec>
+  struct length_counter<ToCodec, locale_narrow>
+  {
+    static std::size_t count(const char* first, const char* last)
+      { return count(narrow_codepage(), first, last); }
+
+    static std::size_t count(const codepage* table, const char* first,
+      const char* last)
+    {
+      if (!table)
+        return length_counter<ToCodec, utf8>::count(first, last);
+      if (ToCodec::encoded_length(0xFFFFu) == 1)  // table code points are in the BMP
+        return last - first;
+      std::size_t n = 0;
+      for (; first != last; ++first)
+        n += ToCodec::encoded_length(table->decode(*first));
+      return n;
+    }
+  };
+
+  template <class FromCodec>
+  struct length_counter<locale_narrow, FromCodec>
+  {
+    static std::size_t count(const typename FromCodec::value_type* first,
+      const typename FromCodec::value_type* last)
+      { return count(narrow_codepage(), first, last); }
+
+    static std::size_t count(const codepage* table,
+      const typename FromCodec::value_type* first,
+      const typename FromCodec::value_type* last)
+    {
+      return table ? length_counter<utf32, FromCodec>::count(first, last)
+        : length_counter<utf8, FromCodec>::count(first, last);
+    }
+  };
+
+  template <class Table>
+  struct length_counter<narrow_codec<Table>, locale_narrow>
+    : length_counter<utf32, locale_narrow> {};
+
+  template <>
+  struct length_counter<locale_narrow, locale_narrow>
+  {
+    static std::size_t count(const char* first, const char* last)
+      { return count(narrow_codepage(), first, last); }
+
+    static std::size_t count(const codepage* table, const char* first,
+      const char* last)
+    {
+      return table ? static_cast<std::size_t>(last - first)
+        : length_counter<utf8, utf8>::count(first, last);
+    }
+  };
+#endif
+
+  //  resize s to n units whose values are about to be overwritten, avoiding the
+  //  zero fill where the standard library allows
+  template <class String>
+  inline void resize_for_overwrite(String& s, std::size_t n) { s.resize(n); }
+
+#if defined(__cpp_lib_string_resize_and_overwrite)
+  struct keep_all
+  {
+    template <class Pointer>
+    std::size_t operator()(Pointer, std::size_t n) const { return n; }
+  };
+
+  template <class charT, class Traits, class Allocator>
+  inline void resize_for_overwrite(std::basic_string<charT, Traits, Allocator>& s,
+    std::size_t n)
+  {
+    s.resize_and_overwrite(n, keep_all());
+  }
+#endif
+
+  enum block_status
+  {
+    block_ok,           // all input converted
+    block_output_full,  // not enough room for the next code point
+    block_incomplete,   // input ended in the middle of a sequence
+    block_invalid       // invalid input sequence
+  };
+
+  template <class FromCodec, bool Validated>
+  struct block_decoder
+  {
+    template <class InputIterator>
+    static decode_status decode(InputIterator& first, InputIterator last, char32& cp)
+    {
+      return FromCodec::decode(first, last, cp);
+    }
+  };
+
+  template <class FromCodec>
+  struct block_decoder<FromCodec, true>
+  {
+    template <class InputIterator>
+    static decode_status decode(InputIterator& first, InputIterator, char32& cp)
+    {
+      FromCodec::decode_unchecked(first, cp);
+      return decode_ok;
+    }
+  };
+
+  //  If Validated, the input must already have been accepted by FromCodec::validate()
+  template <class ToCodec, class FromCodec, bool Validated = false>
+  struct block_converter
+  {
+    typedef typename FromCodec::value_type  from_type;
+    typedef typename ToCodec::value_type    to_type;
+    typedef block_decoder<FromCodec, Validated> decoder;
+
+    //  Converts [first, last) into [out, out_last), advancing first and out past the
+    //  units consumed and produced. If the result is not block_ok, first identifies the
+    //  sequence that could not be converted, and for block_invalid cp holds the
+    //  offending unit as reported by FromCodec::decode().
+    static block_status convert(const from_type*& first, const from_type* last,
+      to_type*& out, to_type* out_last, char32& cp)
+    {
+      return convert(first, last, out, out_last, cp,
+        boost::integral_constant<bool, is_ascii_compatible<FromCodec>::value
+          && is_ascii_compatible<ToCodec>::value>());
+    }
+
+    static block_status convert(const from_type*& first, const from_type* last,
+      to_type*& out, to_type* out_last, char32& cp, boost::true_type)
+    {
+      while (first != last)
+      {
+        if (static_cast< ::boost::uint32_t>(*first) < 0x80u)
+        {
+          std::size_t n = simd::copy_ascii(first, out,
+            (std::min)(static_cast<std::size_t>(last - first),
+                       static_cast<std::size_t>(out_last - out)));
+          first += n;
+          out += n;
+          if (first == last)
+            break;
+          if (out == out_last)
+            return block_output_full;
+        }
+        const from_type* next = first;
+        decode_status status = decoder::decode(next, last, cp);
+        if (status != decode_ok)
+          return status == decode_incomplete ? block_incomplete : block_invalid;
+        if (static_cast<std::size_t>(out_last - out) < ToCodec::encoded_length(cp))
+          return block_output_full;
+        out = ToCodec::encode(cp, out);
+        first = next;
+      }
+      return block_ok;
+    }
+
+    static block_status convert(const from_type*& first, const from_type* last,
+      to_type*& out, to_type* out_last, char32& cp, boost::false_type)
+    {
+      while (first != last)
+      {
+        const from_type* next = first;
+        decode_status status = decoder::decode(next, last, cp);
+        if (status != decode_ok)
+          return status == decode_incomplete ? block_incomplete : block_invalid;
+        if (static_cast<std::size_t>(out_last - out) < ToCodec::encoded_length(cp))
+          return block_output_full;
+        out = ToCodec::encode(cp, out);
+        first = next;
+      }
+      return block_ok;
+    }
+  };
+
+  //  narrow_codec to UTF-16 or UTF-32 is one unit per byte with no invalid input, so
+  //  all of the input that fits goes through simd::decode_codepage()
+  template <class charT>
+  inline block_status codepage_decode(const codepage& table, const char*& first,
+    const char* last, charT*& out, charT* out_last)
+  {
+    std::size_t n = (std::min)(static_cast<std::size_t>(last - first),
+                               static_cast<std::size_t>(out_last - out));
+    simd::decode_codepage(first, out, n, table.to_utf16);
+    first += n;
+    out += n;
+    return first == last ? block_ok : block_output_full;
+  }
+
+  //  UTF-16 or UTF-32 to narrow_codec converts whole runs of BMP code points with
+  //  simd::encode_codepage(), and only surrogate pairs and invalid input with decode()
+  template <class FromCodec>
+  block_status codepage_encode(const codepage& table,
+    const typename FromCodec::value_type*& first,
+    const typename FromCodec::value_type* last, char*& out, char* out_last, char32& cp)
+  {
+    typedef typename FromCodec::value_type from_type;
+    while (first != last)
+    {
+      std::size_t n = simd::encode_codepage(first, out, (std::min)(
+        static_cast<std::size_t>(last - first),
+        static_cast<std::size_t>(out_last - out)), table.to_char, table.slice_index);
+      first += n;
+      out += n;
+      if (first == last)
+        break;
+      if (out == out_last)
+        return block_output_full;
+      const from_type* next = first;
+      decode_status status = FromCodec::decode(next, last, cp);
+      if (status != decode_ok)
+        return status == decode_incomplete ? block_incomplete : block_invalid;
+      *out++ = table.encode(cp);
+      first = next;
+    }
+    return block_ok;
+  }
+
+  template <class Table>
+  inline codepage table_codepage()
+  {
+    codepage table = {0, 0, 0, Table::to_utf16, Table::to_char, Table::slice_index};
+    return table;
+  }
+
+  template <class Table, class charT>
+  struct codepage_decoder
+  {
+    static block_status convert(const char*& first, const char* last, charT*& out,
+      charT* out_last, char32&)
+    {
+      return codepage_decode(table_codepage<Table>(), first, last, out, out_last);
+    }
+  };
+
+  template <class charT, class Table, bool Validated>
+  struct block_converter<generic_utf16<charT>, narrow_codec<Table>, Validated>
+    : codepage_decoder<Table, charT> {};
+  template <class charT, class Table, bool Validated>
+  struct block_converter<generic_utf32<charT>, narrow_codec<Table>, Validated>
+    : codepage_decoder<Table, charT> {};
+
+  template <class Table, class FromCodec>
+  struct codepage_encoder
+  {
+    typedef typename FromCodec::value_type from_type;
+
+    static block_status convert(const from_type*& first, const from_type* last,
+      char*& out, char* out_last, char32& cp)
+    {
+      return codepage_encode<FromCodec>(table_codepage<Table>(), first, last, out,
+        out_last, cp);
+    }
+  };
+
+  template <class Table, class charT, bool Validated>
+  struct block_converter<narrow_codec<Table>, generic_utf16<charT>, Validated>
+    : codepage_encoder<Table, generic_utf16<charT> > {};
+  template <class Table, class charT, bool Validated>
+  struct block_converter<narrow_codec<Table>, generic_utf32<charT>, Validated>
+    : codepage_encoder<Table, generic_utf32<charT> > {};
+
+#ifndef BOOST_WINDOWS_API
+  //  locale_narrow tests narrow_codepage() once per call: UTF-8 goes to the utf8
+  //  converters, and a table to the codepage kernels above where the other codec is
+  //  UTF-16 or UTF-32, or else to a loop that decodes or encodes through the table
+
+  template <class ToCodec>
+  struct locale_table_decoder
+  {
+    typedef typename ToCodec::value_type to_type;
+
+    static block_status convert(const codepage& table, const char*& first,
+      const char* last, to_type*& out, to_type* out_last)
+    {
+      while (first != last)
+      {
+        if (is_ascii_compatible<ToCodec>::value)
+        {
+          std::size_t n = simd::copy_ascii(first, out,
+            (std::min)(static_cast<std::size_t>(last - first),
+                       static_cast<std::size_t>(out_last - out)));
+          first += n;
+          out += n;
+          if (first == last)
+            break;
+        }
+        char32 cp = table.decode(*first);
+        if (static_cast<std::size_t>(out_last - out) < ToCodec::encoded_length(cp))
+          return block_output_full;
+        out = ToCodec::encode(cp, out);
+        ++first;
+      }
+      return block_ok;
+    }
+  };
+
+  template <class charT>
+  struct locale_table_decoder<generic_utf16<charT> >
+  {
+    static block_status convert(const codepage& table, const char*& first,
+      const char* last, charT*& out, charT* out_last)
+      { return codepage_decode(table, first, last, out, out_last); }
+  };
+
+  template <class charT>
+  struct locale_table_decoder<generic_utf32<charT> >
+  {
+    static block_status convert(const codepage& table, const char*& first,
+      const char* last, charT*& out, charT* out_last)
+      { return codepage_decode(table, first, last, out, out_last); }
+  };
+
+  template <class FromCodec, bool Validated>
+  struct locale_table_encoder
+  {
+    typedef typename FromCodec::value_type from_type;
+    typedef block_decoder<FromCodec, Validated> decoder;
+
+    static block_status convert(const codepage& table, const from_type*& first,
+      const from_type* last, char*& out, char* out_last, char32& cp)
+    {
+      while (first != last)
+      {
+        if (is_ascii_compatible<FromCodec>::value)
+        {
+          std::size_t n = simd::copy_ascii(first, out,
+            (std::min)(static_cast<std::size_t>(last - first),
+                       static_cast<std::size_t>(out_last - out)));
+          first += n;
+          out += n;
+          if (first == last)
+            break;
+        }
+        if (out == out_last)
+          return block_output_full;
+        const from_type* next = first;
+        decode_status status = decoder::decode(next, last, cp);
+        if (status != decode_ok)
+          return status == decode_incomplete ? block_incomplete : block_invalid;
+        *out++ = table.encode(cp);
+        first = next;
+      }
+      return block_ok;
+    }
+  };
+
+  template <class charT, bool Validated>
+  struct locale_table_encoder<generic_utf16<charT>, Validated>
+  {
+    static block_status convert(const codepage& table, const charT*& first,
+      const charT* last, char*& out, char* out_last, char32& cp)
+    {
+      return codepage_encode<generic_utf16<charT> >(table, first, last, out, out_last,
+        cp);
+    }
+  };
+
+  template <class charT, bool Validated>
+  struct locale_table_encoder<generic_utf32<charT>, Validated>
+  {
+    static block_status convert(const codepage& table, const charT*& first,
+      const charT* last, char*& out, char* out_last, char32& cp)
+    {
+      return codepage_encode<generic_utf32<charT> >(table, first, last, out, out_last,
+        cp);
+    }
+  };
+
+  template <class ToCodec, bool Validated>
+  struct block_converter<ToCodec, locale_narrow, Validated>
+  {
+    typedef typename ToCodec::value_type to_type;
+
+    static block_status convert(const char*& first, const char* last, to_type*& out,
+      to_type* out_last, char32& cp)
+      { return convert(narrow_codepage(), first, last, out, out_last, cp); }
+
+    static block_status convert(const codepage* table, const char*& first,
+      const char* last, to_type*& out, to_type* out_last, char32& cp)
+    {
+      if (table)
+        return locale_table_decoder<ToCodec>::convert(*table, first, last, out,
+          out_last);
+      return block_converter<ToCodec, utf8, Validated>::convert(first, last, out,
+        out_last, cp);
+    }
+  };
+
+  template <class FromCodec, bool Validated>
+  struct block_converter<locale_narrow, FromCodec, Validated>
+  {
+    typedef typename FromCodec::value_type from_type;
+
+    static block_status convert(const from_type*& first, const from_type* last,
+      char*& out, char* out_last, char32& cp)
+      { return convert(narrow_codepage(), first, last, out, out_last, cp); }
+
+    static block_status convert(const codepage* table, const from_type*& first,
+      const from_type* last, char*& out, char* out_last, char32& cp)
+    {
+      if (table)
+        return locale_table_encoder<FromCodec, Validated>::convert(*table, first, last,
+          out, out_last, cp);
+      return block_converter<utf8, FromCodec, Validated>::convert(first, last, out,
+        out_last, cp);
+    }
+  };
+
+  template <bool Validated>
+  struct block_converter<locale_narrow, locale_narrow, Validated>
+  {
+    static block_status convert(const char*& first, const char* last, char*& out,
+      char* out_last, char32& cp)
+      { return convert(narrow_codepage(), first, last, out, out_last, cp); }
+
+    static block_status convert(const codepage* table, const char*& first,
+      const char* last, char*& out, char* out_last, char32& cp)
+    {
+      if (!table)
+        return block_converter<utf8, utf8, Validated>::convert(first, last, out,
+          out_last, cp);
+      //  bytes the table leaves undefined become '?', as for any other conversion
+      for (; first != last && out != out_last; ++first, ++out)
+        *out = table->encode(table->decode(*first));
+      return first == last ? block_ok : block_output_full;
+    }
+  };
+#endif  // BOOST_WINDOWS_API
+
+  //  Appends the conversion of [first, last) to s, applying policy to invalid input,
+  //  and returns the end of the input converted. s is sized once, by length_counter;
+  //  it only grows again if invalid input made that count too small.
+  template <class ToCodec, class FromCodec, bool Validated, class ToString,
+    class ErrorPolicy>
+  const typename FromCodec::value_type* block_append_range(
+    const typename FromCodec::value_type* first,
+    const typename FromCodec::value_type* last, ToString& s, ErrorPolicy policy)
+  {
+    typedef typename ToCodec::value_type to_type;
+
+    std::size_t pos = s.size();
+    std::size_t estimate = length_counter<ToCodec, FromCodec>::count(first, last);
+    if (estimate == 0 && first != last)  // invalid input can count as nothing
+      estimate = ToCodec::max_units;
+    while (first != last)
+    {
+      resize_for_overwrite(s, pos + estimate);
+      to_type* base = &s[0];
+      to_type* out = base + pos;
+      char32 cp = 0;
+      block_status status = block_converter<ToCodec, FromCodec, Validated>::convert(
+        first, last, out, base + s.size(), cp);
+      pos = out - base;
+      if (status == block_ok)
+        break;
+      if (status != block_output_full)
+      {
+        s.resize(pos);
+        if (!on_invalid<ToCodec, FromCodec>(first, last, cp, s, policy))
+          return first;
+        pos = s.size();
+      }
+      estimate = (last - first) * ToCodec::max_units;
+    }
+    s.resize(pos);
+    return first;
+  }
+
+  template <class ToCodec, class FromCodec, class ToString, class ErrorPolicy>
+  inline const typename FromCodec::value_type* block_append(
+    const typename FromCodec::value_type* first,
+    const typename FromCodec::value_type* last, ToString& s, ErrorPolicy policy,
+    boost::false_type)
+  {
+    return block_append_range<ToCodec, FromCodec, false>(first, last, s, policy);
+  }
+
+  //  validate up front, convert the valid prefix unchecked, and let the checked
+  //  converter deal with the error, if any, in the remainder
+  template <class ToCodec, class FromCodec, class ToString, class ErrorPolicy>
+  inline const typename FromCodec::value_type* block_append(
+    const typename FromCodec::value_type* first,
+    const typename FromCodec::value_type* last, ToString& s, ErrorPolicy policy,
+    boost::true_type)
+  {
+    const typename FromCodec::value_type* valid_last = FromCodec::validate(first, last);
+    block_append_range<ToCodec, FromCodec, true>(first, valid_last, s, policy);
+    if (valid_last == last)
+      return last;
+    return block_append_range<ToCodec, FromCodec, false>(valid_last, last, s, policy);
+  }
+
+  //  the end of the run of valid input at first, which assume_valid does not check
+  template <class FromCodec, class T, class ErrorPolicy>
+  inline const T* valid_end(const T* first, const T* last, ErrorPolicy)
+  {
+    return FromCodec::validate(first, last);
+  }
+
+  template <class FromCodec, class T>
+  inline const T* valid_end(const T*, const T* last, assume_valid) { return last; }
+
+  //  Between the same encoding, append the valid runs of the input as they are, and
+  //  apply policy to each invalid sequence between them
+  template <class ToCodec, class FromCodec, class ToString, class ErrorPolicy>
+  const typename FromCodec::value_type* copy_append(
+    const typename FromCodec::value_type* first,
+    const typename FromCodec::value_type* last, ToString& s, ErrorPolicy policy)
+  {
+    s.reserve(s.size() + (last - first));
+    while (first != last)
+    {
+      const typename FromCodec::value_type* valid_last
+        = valid_end<FromCodec>(first, last, policy);
+      s.insert(s.end(), first, valid_last);
+      first = valid_last;
+      if (first == last)
+        break;
+      const typename FromCodec::value_type* next = first;
+      char32 cp;
+      FromCodec::decode(next, last, cp);
+      if (!on_invalid<ToCodec, FromCodec>(first, last, cp, s, policy))
+        break;
+    }
+    return first;
+  }
+
+  template <class ToCodec, class FromCodec, class ToString, class ErrorPolicy>
+  inline const typename FromCodec::value_type* convert_append(
+    const typename FromCodec::value_type* first,
+    const typename FromCodec::value_type* last, ToString& s, ErrorPolicy policy,
+    boost::false_type)
+  {
+    return block_append<ToCodec, FromCodec>(first, last, s, policy,
+      typename has_validator<FromCodec>::type());
+  }
+
+  template <class ToCodec, class FromCodec, class ToString, class ErrorPolicy>
+  inline const typename FromCodec::value_type* convert_append(
+    const typename FromCodec::value_type* first,
+    const typename FromCodec::value_type* last, ToString& s, ErrorPolicy policy,
+    boost::true_type)
+  {
+    if (copies_as_is<ToCodec, FromCodec>())
+      return copy_append<ToCodec, FromCodec>(first, last, s, policy);
+    return convert_append<ToCodec, FromCodec>(first, last, s, policy,
+      boost::false_type());
+  }
+
+  template <class ToCodec, class FromCodec, class ToString, class ErrorPolicy>
+  inline const typename FromCodec::value_type* block_append(
+    const typename FromCodec::value_type* first,
+    const typename FromCodec::value_type* last, ToString& s, ErrorPolicy policy)
+  {
+    return convert_append<ToCodec, FromCodec>(first, last, s, policy,
+      typename is_same_encoding<ToCodec, FromCodec>::type());
+  }
+
+  //  Null terminated input on the block path is processed a chunk at a time. Each chunk
+  //  is searched for the terminator by simd::find_null() and then converted while it is
+  //  still in cache, so the input is read from memory once, rather than once to find
+  //  its length and again to convert it.
+
+  const std::size_t null_chunk_bytes = 16384;
+
+  //  Returns the end of the chunk of the null terminated sequence at first, setting
+  //  terminated if the chunk ends at the terminator
+  template <class Codec>
+  inline const typename Codec::value_type* null_chunk(
+    const typename Codec::value_type* first, bool& terminated)
+  {
+    const std::size_t chunk = null_chunk_bytes / sizeof(typename Codec::value_type);
+    std::size_t n = simd::find_null(first, chunk);
+    terminated = n < chunk;
+    //  when there is no terminator within the chunk, first[chunk] is readable, and
+    //  the chunk ends where the sequence containing it starts
+    return terminated ? first + n : Codec::sequence_start(first, first + n);
+  }
+
+  //  Appends the conversion of the forward iterator range [first, last) to s, applying
+  //  policy to invalid input, and returns the number of input units converted
+  template <class ToCodec, class FromCodec, class ToString, class InputIterator,
+    class ErrorPolicy>
+  std::size_t iterator_append(InputIterator first, InputIterator last, ToString& s,
+    ErrorPolicy policy)
+  {
+    std::size_t n = 0;
+    while (first != last)
+    {
+      InputIterator next = first;
+      char32 cp;
+      if (FromCodec::decode(next, last, cp) == decode_ok)
+        ToCodec::encode(cp, std::back_inserter(s));
+      else
+      {
+        next = first;
+        if (!on_invalid<ToCodec, FromCodec>(next, last, cp, s, policy))
+          break;
+      }
+      n += std::distance(first, next);
+      first = next;
+    }
+    return n;
+  }
+
+  template <class ToCodec, class FromCodec, class ToString, class InputIterator>
+  struct use_block_path
+    : boost::integral_constant<bool,
+        has_block_interface<ToCodec>::value
+        && has_block_interface<FromCodec>::value
+        && is_contiguous_iterator<InputIterator>::value
+        && is_contiguous_container<ToString>::value
+        && boost::is_same<typename ToString::value_type,
+             typename ToCodec::value_type>::value
+        && boost::is_same<typename boost::remove_cv<
+             typename std::iterator_traits<InputIterator>::value_type>::type,
+             typename FromCodec::value_type>::value>
+  {};
+
+  //  make_string() implementation helpers. Each converts its source into the empty
+  //  string s, applying policy to invalid input; the final argument selects the block
+  //  path. Without the block path, throw_on_error uses conversion_iterator, so that any
+  //  Codec and any input iterator may be used.
+
+  template <class ToCodec, class FromCodec, class InputIterator, class ToString>
+  inline void convert_range(InputIterator first, InputIterator last, ToString& s,
+    throw_on_error, boost::false_type)
+  {
+    typedef conversion_iterator<ToCodec, FromCodec, InputIterator> iter_type;
+    s.assign(iter_type(first, last), iter_type());
+    //  iter_type counted the input
+    BOOST_INTEROP_STATS_UNITS(ToCodec, FromCodec, 0, s.size());
+  }
+
+  template <class ToCodec, class FromCodec, class InputIterator, class ToString,
+    class ErrorPolicy>
+  inline void convert_range(InputIterator first, InputIterator last, ToString& s,
+    ErrorPolicy policy, boost::false_type)
+  {
+    BOOST_STATIC_ASSERT_MSG((has_block_interface<ToCodec>::value
+      && has_block_interface<FromCodec>::value),
+      "error policies require BlockCodecs");
+    std::size_t n = iterator_append<ToCodec, FromCodec>(first, last, s, policy);
+    report_converted(policy, n);
+    BOOST_INTEROP_STATS_CALL(ToCodec, FromCodec, n, s.size(), false);
+  }
+
+  template <class ToCodec, class FromCodec, class InputIterator, class ToString,
+    class ErrorPolicy>
+  inline void convert_range(InputIterator first, InputIterator last, ToString& s,
+    ErrorPolicy policy, boost::true_type)
+  {
+    std::size_t n = 0;
+    if (first != last)
+    {
+      const typename FromCodec::value_type* p = &*first;
+      n = block_append<ToCodec, FromCodec>(p, p + (last - first), s, policy) - p;
+    }
+    report_converted(policy, n);
+    BOOST_INTEROP_STATS_CALL(ToCodec, FromCodec, n, s.size(), true);
+  }
+
+  template <class ToCodec, class FromCodec, class InputIterator, class ToString>
+  inline void convert_null(InputIterator begin, ToString& s, throw_on_error,
+    boost::false_type)
+  {
+    typedef conversion_iterator<ToCodec, FromCodec, InputIterator> iter_type;
+    s.assign(iter_type(begin), iter_type());
+    BOOST_INTEROP_STATS_UNITS(ToCodec, FromCodec, 0, s.size());
+  }
+
+  template <class ToCodec, class FromCodec, class InputIterator, class ToString,
+    class ErrorPolicy>
+  inline void convert_null(InputIterator begin, ToString& s, ErrorPolicy policy,
+    boost::false_type)
+  {
+    InputIterator end(begin);
+    for (;
+         *end != typename std::iterator_traits<InputIterator>::value_type();
+         ++end) {}
+    convert_range<ToCodec, FromCodec>(begin, end, s, policy, boost::false_type());
+  }
+
+  template <class ToCodec, class FromCodec, class InputIterator, class ToString,
+    class ErrorPolicy>
+  inline void convert_null(InputIterator begin, ToString& s, ErrorPolicy policy,
+    boost::true_type)
+  {
+    typedef typename FromCodec::value_type from_type;
+
+    const from_type* const start = &*begin;
+    const from_type* first = start;
+    for (bool terminated = false; !terminated;)
+    {
+      const from_type* last = null_chunk<FromCodec>(first, terminated);
+      if (first == last)
+        break;
+      const from_type* stop = block_append<ToCodec, FromCodec>(first, last, s, policy);
+      first = stop;
+      if (stop != last)
+        break;  // the policy stopped the conversion
+    }
+    report_converted(policy, first - start);
+    BOOST_INTEROP_STATS_CALL(ToCodec, FromCodec, first - start, s.size(), true);
+  }
+
+  template <class ToCodec, class FromCodec, class InputIterator, class ToString>
+  inline void convert_size(InputIterator begin, std::size_t sz, ToString& s,
+    throw_on_error, boost::false_type)
+  {
+    typedef conversion_iterator<ToCodec, FromCodec, InputIterator> iter_type;
+    s.assign(iter_type(begin, sz), iter_type());
+    //  iter_type counted the input
+    BOOST_INTEROP_STATS_UNITS(ToCodec, FromCodec, 0, s.size());
+  }
+
+  template <class ToCodec, class FromCodec, class InputIterator, class ToString,
+    class ErrorPolicy, class UseBlockPath>
+  inline void convert_size(InputIterator begin, std::size_t sz, ToString& s,
+    ErrorPolicy policy, UseBlockPath)
+  {
+    InputIterator end(begin);
+    std::advance(end, sz);
+    convert_range<ToCodec, FromCodec>(begin, end, s, policy, UseBlockPath());
+  }
+
+  template <class ToCodec, class FromCodec, class FromString, class ToString,
+    class ErrorPolicy>
+  inline void convert_container(const FromString& from, ToString& s,
+    ErrorPolicy policy, boost::false_type)
+  {
+    convert_range<ToCodec, FromCodec>(from.begin(), from.end(), s, policy,
+      typename use_block_path<ToCodec, FromCodec, ToString,
+        typename FromString::const_iterator>::type());
+  }
+
+  template <class ToCodec, class FromCodec, class FromString, class ToString,
+    class ErrorPolicy>
+  inline void convert_container(const FromString& from, ToString& s,
+    ErrorPolicy policy, boost::true_type)
+  {
+    //  works for any allocator, unlike the iterator based detection
+    typedef const typename FromString::value_type* pointer;
+    pointer first = from.empty() ? 0 : &*from.begin();
+    convert_range<ToCodec, FromCodec>(first, first + from.size(), s, policy,
+      typename use_block_path<ToCodec, FromCodec, ToString, pointer>::type());
+  }
+
+  //  true if T is an allocator. With C++11, T must have an allocate(n) member, as
+  //  std::pmr::polymorphic_allocator does; with C++03, a rebind member template.
+  template <class T>
+  class is_allocator
+  {
+    struct size2 {char a[2]; };
+    template <class U> static size2 sfinae(...);
+#if !defined(BOOST_NO_SFINAE_EXPR) && !defined(BOOST_NO_CXX11_DECLTYPE)
+    template <class U>
+    static char sfinae(decltype(boost::declval<U&>().allocate(std::size_t()))*);
+#else
+    template <class U>
+    static char sfinae(typename U::template rebind<char>::other*);
+#endif
+  public:
+    BOOST_STATIC_CONSTANT(bool, value = sizeof(sfinae<T>(0)) == 1);
+  };
+
+  //  the std::basic_string of ToCodec's value_type whose allocator is rebound from
+  //  Allocator, returned by the make_string() and to_* overloads taking an allocator
+  template <class ToCodec, class Allocator>
+  struct allocator_string
+  {
+    typedef typename ToCodec::value_type value_type;
+#ifndef BOOST_NO_CXX11_ALLOCATOR
+    typedef typename std::allocator_traits<Allocator>::template
+      rebind_alloc<value_type> allocator_type;
+#else
+    typedef typename Allocator::template rebind<value_type>::other allocator_type;
+#endif
+    typedef std::basic_string<value_type, std::char_traits<value_type>,
+      allocator_type> type;
+  };
+
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+  //  true if make_string() may return the rvalue source FromString itself: it is a
+  //  contiguous ToString, and FromCodec selects for it a codec of ToCodec's encoding
+  template <class ToCodec, class FromCodec, class ToString, class FromString,
+    bool = boost::is_same<ToString, FromString>::value>
+  struct is_movable_source : boost::false_type {};
+
+  template <class ToCodec, class FromCodec, class String>
+  struct is_movable_source<ToCodec, FromCodec, String, String, true>
+    : boost::integral_constant<bool, is_contiguous_container<String>::value
+        && is_same_encoding<ToCodec, typename FromCodec::template
+             codec<typename String::value_type>::type>::value>
+  {};
+
+  //  true if s may be returned as the conversion of itself
+  template <class ToCodec, class FromCodec, class String, class ErrorPolicy>
+  inline bool is_valid_as_is(const String& s, ErrorPolicy)
+  {
+    if (!copies_as_is<ToCodec, FromCodec>())
+      return false;
+    if (s.empty())
+      return true;
+    const typename String::value_type* first = &s[0];
+    const typename String::value_type* last = first + s.size();
+    return FromCodec::validate(first, last) == last;
+  }
+
+  template <class ToCodec, class FromCodec, class String>
+  inline bool is_valid_as_is(const String&, assume_valid)
+  {
+    return copies_as_is<ToCodec, FromCodec>();
+  }
+#endif
+
+} // namespace detail
+
+//--------------------------------------------------------------------------------------//
+//                                  validate_utf8                                       //
+//--------------------------------------------------------------------------------------//
+
+//  Returns the offset of the first byte of the first sequence in [p, p + n) that is not
+//  valid UTF-8, or n if the whole range is valid. Overlong forms, encoded surrogates,
+//  code points beyond U+10FFFF, and a sequence truncated by the end of the range are
+//  all invalid. Vectorized when BOOST_INTEROP_SSSE3 or BOOST_INTEROP_AVX2 is defined.
+
+inline std::size_t validate_utf8(const char* p, std::size_t n)
+{
+  return detail::simd::validate_utf8(p, n);
+}
+
+//--------------------------------------------------------------------------------------//
+//                                 converted_length                                     //
+//--------------------------------------------------------------------------------------//
+
+//  converted_length<ToCodec, FromCodec>(p, n) returns the number of ToCodec units that
+//  make_string<ToCodec, FromCodec>() produces from [p, p + n), so that callers can size
+//  their own buffers. make_string() uses it to size its result exactly once. Both codecs
+//  must be BlockCodecs. The input is not validated, and for invalid input the result is
+//  unspecified. The UTF pairs count units without decoding, and are vectorized when
+//  BOOST_INTEROP_SSE2 or BOOST_INTEROP_AVX2 is defined.
+
+template <class ToCodec, class FromCodec>
+inline std::size_t converted_length(const typename FromCodec::value_type* p,
+  std::size_t n)
+{
+  return detail::length_counter<ToCodec, FromCodec>::count(p, p + n);
+}
+
+//  FromCodec is selected from the value_type of FromString
+template <class ToCodec, class FromString>
+inline std::size_t converted_length(const FromString& s)
+{
+  typedef typename select_codec<typename FromString::value_type>::type from_codec;
+  return s.empty() ? 0
+    : converted_length<ToCodec, from_codec>(&*s.begin(), s.size());
+}
+
+//  null terminated
+template <class ToCodec, class FromCodec>
+inline std::size_t converted_length(const typename FromCodec::value_type* s)
+{
+  std::size_t n = 0;
+  for (bool terminated = false; !terminated;)
+  {
+    const typename FromCodec::value_type* last
+      = detail::null_chunk<FromCodec>(s, terminated);
+    n += detail::length_counter<ToCodec, FromCodec>::count(s, last);
+    s = last;
+  }
+  return n;
+}
+
+//  count_code_points<Codec>(p, n) returns the number of code points in [p, p + n),
+//  counted in the same way: a UTF-8 code point is a byte that is not a continuation
+//  byte, and a UTF-16 code point a unit that is not a low surrogate.
+
+template <class Codec>
+inline std::size_t count_code_points(const typename Codec::value_type* p,
+  std::size_t n)
+{
+  return converted_length<utf32, Codec>(p, n);
+}
+
+//  Codec is selected from the value_type of String
+template <class String>
+inline std::size_t count_code_points(const String& s)
+{
+  return converted_length<utf32>(s);
+}
+
+//  null terminated
+template <class Codec>
+inline std::size_t count_code_points(const typename Codec::value_type* s)
+{
+  return converted_length<utf32, Codec>(s);
+}
+
+inline std::size_t utf16_length_from_utf8(const char* p, std::size_t n)
+  { return converted_length<utf16, utf8>(p, n); }
+inline std::size_t utf32_length_from_utf8(const char* p, std::size_t n)
+  { return converted_length<utf32, utf8>(p, n); }
+inline std::size_t utf8_length_from_utf16(const char16* p, std::size_t n)
+  { return converted_length<utf8, utf16>(p, n); }
+inline std::size_t utf32_length_from_utf16(const char16* p, std::size_t n)
+  { return converted_length<utf32, utf16>(p, n); }
+inline std::size_t utf8_length_from_utf32(const char32* p, std::size_t n)
+  { return converted_length<utf8, utf32>(p, n); }
+inline std::size_t utf16_length_from_utf32(const char32* p, std::size_t n)
+  { return converted_length<utf16, utf32>(p, n); }
+inline std::size_t narrow_length_from_wide(const wchar_t* p, std::size_t n)
+  { return converted_length<narrow, wide>(p, n); }
+inline std::size_t wide_length_from_narrow(const char* p, std::size_t n)
+  { return converted_length<wide, narrow>(p, n); }
+
+//--------------------------------------------------------------------------------------//
+//                               make_string function                                   //
+//--------------------------------------------------------------------------------------//
+
+//  Each form may also be given an ErrorPolicy (see error policies above), an allocator,
+//  or both, as trailing arguments. Given an allocator, the result is a std::basic_string
+//  whose allocator is rebound from, and constructed from, that allocator; so a
+//  std::pmr::polymorphic_allocator yields a std::pmr string that allocates from the
+//  allocator's memory resource.
+//
+//  When the source and the result are the same encoding, the source is validated and
+//  copied rather than converted. A source that is an rvalue of the result type is
+//  validated and then moved into the result, without copying at all.
+
+//  container
+template <class ToCodec,
+# ifndef BOOST_NO_FUNCTION_TEMPLATE_DEFAULT_ARGS
+          class FromCodec = default_codec,
+          class ToString = std::basic_string<typename ToCodec::value_type>,
+# else
+          class FromCodec,
+          class ToString,
+# endif
+          class FromString> inline
+  // enable_if resolves ambiguity with single iterator overload
+typename boost::disable_if<boost::is_iterator<typename boost::decay<FromString>::type>,
+ToString>::type make_string(const FromString& s)
+{
+  return make_string<ToCodec, FromCodec, ToString>(s, throw_on_error());
+}
+
+//  container, error policy
+template <class ToCodec,
+# ifndef BOOST_NO_FUNCTION_TEMPLATE_DEFAULT_ARGS
+          class FromCodec = default_codec,
+          class ToString = std::basic_string<typename ToCodec::value_type>,
+# else
+          class FromCodec,
+          class ToString,
+# endif
+          class FromString, class ErrorPolicy> inline
+typename boost::enable_if_c<is_error_policy<ErrorPolicy>::value
+  && !boost::is_iterator<typename boost::decay<FromString>::type>::value,
+ToString>::type make_string(const FromString& s, ErrorPolicy policy)
+{
+  typedef typename FromCodec::template
+    codec<typename FromString::value_type>::type from_codec;
+
+  ToString result;
+  detail::convert_container<ToCodec, from_codec>(s, result, policy,
+    typename detail::is_contiguous_container<FromString>::type());
+  return result;
+}
+
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+//  rvalue container of the same encoding as the result, which takes over its buffer
+//  once it is found to be valid
+template <class ToCodec,
+# ifndef BOOST_NO_FUNCTION_TEMPLATE_DEFAULT_ARGS
+          class FromCodec = default_codec,
+          class ToString = std::basic_string<typename ToCodec::value_type>,
+# else
+          class FromCodec,
+          class ToString,
+# endif
+          class FromString> inline
+typename boost::enable_if<detail::is_movable_source<ToCodec, FromCodec, ToString,
+  FromString>, ToString>::type make_string(FromString&& s)
+{
+  return make_string<ToCodec, FromCodec, ToString>(std::move(s), throw_on_error());
+}
+
+//  rvalue container of the same encoding as the result, error policy
+template <class ToCodec,
+# ifndef BOOST_NO_FUNCTION_TEMPLATE_DEFAULT_ARGS
+          class FromCodec = default_codec,
+          class ToString = std::basic_string<typename ToCodec::value_type>,
+# else
+          class FromCodec,
+          class ToString,
+# endif
+          class FromString, class ErrorPolicy> inline
+typename boost::enable_if_c<is_error_policy<ErrorPolicy>::value
+  && detail::is_movable_source<ToCodec, FromCodec, ToString, FromString>::value,
+ToString>::type make_string(FromString&& s, ErrorPolicy policy)
+{
+  typedef typename FromCodec::template
+    codec<typename FromString::value_type>::type from_codec;
+
+  if (detail::is_valid_as_is<ToCodec, from_codec>(s, policy))
+  {
+    BOOST_INTEROP_STATS_CALL(ToCodec, from_codec, s.size(), s.size(), true);
+    return std::move(s);
+  }
+  return make_string<ToCodec, FromCodec, ToString>(static_cast<const FromString&>(s),
+    policy);
+}
+#endif
+
+//  container, allocator
+template <class ToCodec,
+# ifndef BOOST_NO_FUNCTION_TEMPLATE_DEFAULT_ARGS
+          class FromCodec = default_codec,
+# else
+          class FromCodec,
+# endif
+          class FromString, class Allocator> inline
+typename boost::lazy_enable_if_c<detail::is_allocator<Allocator>::value
+  && !boost::is_iterator<typename boost::decay<FromString>::type>::value,
+detail::allocator_string<ToCodec, Allocator> >::type
+make_string(const FromString& s, const Allocator& a)
+{
+  return make_string<ToCodec, FromCodec>(s, throw_on_error(), a);
+}
+
+//  container, error policy, allocator
+template <class ToCodec,
+# ifndef BOOST_NO_FUNCTION_TEMPLATE_DEFAULT_ARGS
+          class FromCodec = default_codec,
+# else
+          class FromCodec,
+# endif
+          class FromString, class ErrorPolicy, class Allocator> inline
+typename boost::lazy_enable_if_c<is_error_policy<ErrorPolicy>::value
+  && detail::is_allocator<Allocator>::value
+  && !boost::is_iterator<typename boost::decay<FromString>::type>::value,
+detail::allocator_string<ToCodec, Allocator> >::type
+make_string(const FromString& s, ErrorPolicy policy, const Allocator& a)
+{
+  typedef typename FromCodec::template
+    codec<typename FromString::value_type>::type from_codec;
+  typedef typename detail::allocator_string<ToCodec, Allocator>::type string_type;
+
+  typename string_type::allocator_type alloc(a);
+  string_type result(alloc);
+  detail::convert_container<ToCodec, from_codec>(s, result, policy,
+    typename detail::is_contiguous_container<FromString>::type());
+  return result;
+}
+
+//  null terminated iterator
+template <class ToCodec,
+# ifndef BOOST_NO_FUNCTION_TEMPLATE_DEFAULT_ARGS
+          class FromCodec = default_codec,
+          class ToString = std::basic_string<typename ToCodec::value_type>,
+# else
+          class FromCodec,
+          class ToString,
+# endif
+          class InputIterator> inline
+  // enable_if resolves ambiguity with FromString overload
+typename boost::enable_if<boost::is_iterator<InputIterator>,
+ToString>::type make_string(InputIterator begin)
+{
+  return make_string<ToCodec, FromCodec, ToString>(begin, throw_on_error());
+}
+
+//  null terminated iterator, error policy
+template <class ToCodec,
+# ifndef BOOST_NO_FUNCTION_TEMPLATE_DEFAULT_ARGS
+          class FromCodec = default_codec,
+          class ToString = std::basic_string<typename ToCodec::value_type>,
+# else
+          class FromCodec,
+          class ToString,
+# endif
+          class InputIterator, class ErrorPolicy> inline
+typename boost::enable_if_c<is_error_policy<ErrorPolicy>::value
+  && boost::is_iterator<InputIterator>::value,
+ToString>::type make_string(InputIterator begin, ErrorPolicy policy)
+{
+  typedef typename FromCodec::template
+    codec<typename std::iterator_traits<InputIterator>::value_type>::type from_codec;
+
+  ToString result;
+  detail::convert_null<ToCodec, from_codec>(begin, result, policy,
+    typename detail::use_block_path<ToCodec, from_codec, ToString,
+      InputIterator>::type());
+  return result;
+}
+
+//  null terminated iterator, allocator
+template <class ToCodec,
+# ifndef BOOST_NO_FUNCTION_TEMPLATE_DEFAULT_ARGS
+          class FromCodec = default_codec,
+# else
+          class FromCodec,
+# endif
+          class InputIterator, class Allocator> inline
+typename boost::lazy_enable_if_c<detail::is_allocator<Allocator>::value
+  && boost::is_iterator<InputIterator>::value,
+detail::allocator_string<ToCodec, Allocator> >::type
+make_string(InputIterator begin, const Allocator& a)
+{
+  return make_string<ToCodec, FromCodec>(begin, throw_on_error(), a);
+}
+
+//  null terminated iterator, error policy, allocator
+template <class ToCodec,
+# ifndef BOOST_NO_FUNCTION_TEMPLATE_DEFAULT_ARGS
+          class FromCodec = default_codec,
+# else
+          class FromCodec,
+# endif
+          class InputIterator, class ErrorPolicy, class Allocator> inline
+typename boost::lazy_enable_if_c<is_error_policy<ErrorPolicy>::value
+  && detail::is_allocator<Allocator>::value
+  && boost::is_iterator<InputIterator>::value,
+detail::allocator_string<ToCodec, Allocator> >::type
+make_string(InputIterator begin, ErrorPolicy policy, const Allocator& a)
+{
+  typedef typename FromCodec::template
+    codec<typename std::iterator_traits<InputIterator>::value_type>::type from_codec;
+  typedef typename detail::allocator_string<ToCodec, Allocator>::type string_type;
+
+  typename string_type::allocator_type alloc(a);
+  string_type result(alloc);
+  detail::convert_null<ToCodec, from_codec>(begin, result, policy,
+    typename detail::use_block_path<ToCodec, from_codec, string_type,
+      InputIterator>::type());
+  return result;
+}
+
+//  iterator, size
+template <class ToCodec,
+# ifndef BOOST_NO_FUNCTION_TEMPLATE_DEFAULT_ARGS
+          class FromCodec = default_codec,
+          class ToString = std::basic_string<typename ToCodec::value_type>,
+# else
+          class FromCodec,
+          class ToString,
+# endif
+          class InputIterator> inline
+ToString make_string(InputIterator begin, std::size_t sz)
+{
+  return make_string<ToCodec, FromCodec, ToString>(begin, sz, throw_on_error());
+}
+
+//  iterator, size, error policy
+template <class ToCodec,
+# ifndef BOOST_NO_FUNCTION_TEMPLATE_DEFAULT_ARGS
+          class FromCodec = default_codec,
+          class ToString = std::basic_string<typename ToCodec::value_type>,
+# else
+          class FromCodec,
+          class ToString,
+# endif
+          class InputIterator, class ErrorPolicy> inline
+typename boost::enable_if<is_error_policy<ErrorPolicy>,
+ToString>::type make_string(InputIterator begin, std::size_t sz, ErrorPolicy policy)
+{
+  typedef typename FromCodec::template
+    codec<typename std::iterator_traits<InputIterator>::value_type>::type from_codec;
+
+  ToString result;
+  detail::convert_size<ToCodec, from_codec>(begin, sz, result, policy,
+    typename detail::use_block_path<ToCodec, from_codec, ToString,
+      InputIterator>::type());
+  return result;
+}
+
+//  iterator, size, allocator
+template <class ToCodec,
+# ifndef BOOST_NO_FUNCTION_TEMPLATE_DEFAULT_ARGS
+          class FromCodec = default_codec,
+# else
+          class FromCodec,
+# endif
+          class InputIterator, class Allocator> inline
+typename boost::lazy_enable_if<detail::is_allocator<Allocator>,
+detail::allocator_string<ToCodec, Allocator> >::type
+make_string(InputIterator begin, std::size_t sz, const Allocator& a)
+{
+  return make_string<ToCodec, FromCodec>(begin, sz, throw_on_error(), a);
+}
+
+//  iterator, size, error policy, allocator
+template <class ToCodec,
+# ifndef BOOST_NO_FUNCTION_TEMPLATE_DEFAULT_ARGS
+          class FromCodec = default_codec,
+# else
+          class FromCodec,
+# endif
+          class InputIterator, class ErrorPolicy, class Allocator> inline
+typename boost::lazy_enable_if_c<is_error_policy<ErrorPolicy>::value
+  && detail::is_allocator<Allocator>::value,
+detail::allocator_string<ToCodec, Allocator> >::type
+make_string(InputIterator begin, std::size_t sz, ErrorPolicy policy,
+  const Allocator& a)
+{
+  typedef typename FromCodec::template
+    codec<typename std::iterator_traits<InputIterator>::value_type>::type from_codec;
+  typedef typename detail::allocator_string<ToCodec, Allocator>::type string_type;
+
+  typename string_type::allocator_type alloc(a);
+  string_type result(alloc);
+  detail::convert_size<ToCodec, from_codec>(begin, sz, result, policy,
+    typename detail::use_block_path<ToCodec, from_codec, string_type,
+      InputIterator>::type());
+  return result;
+}
+
+//  iterator range
+template <class ToCodec,
+# ifndef BOOST_NO_FUNCTION_TEMPLATE_DEFAULT_ARGS
+          class FromCodec = default_codec,
+          class ToString = std::basic_string<typename ToCodec::value_type>,
+# else
+          class FromCodec,
+          class ToString,
+# endif
+          class InputIterator, class InputIterator2>
+  // enable_if ensures 2nd argument of 0 is treated as size, not range end
+typename boost::enable_if<boost::is_iterator<InputIterator2>,
+ToString>::type make_string(InputIterator begin, InputIterator2 end)
+{
+  return make_string<ToCodec, FromCodec, ToString>(begin, end, throw_on_error());
+}
+
+//  iterator range, error policy
+template <class ToCodec,
+# ifndef BOOST_NO_FUNCTION_TEMPLATE_DEFAULT_ARGS
+          class FromCodec = default_codec,
+          class ToString = std::basic_string<typename ToCodec::value_type>,
+# else
+          class FromCodec,
+          class ToString,
+# endif
+          class InputIterator, class InputIterator2, class ErrorPolicy> inline
+typename boost::enable_if_c<is_error_policy<ErrorPolicy>::value
+  && boost::is_iterator<InputIterator2>::value,
+ToString>::type make_string(InputIterator begin, InputIterator2 end,
+  ErrorPolicy policy)
+{
+  typedef typename FromCodec::template
+    codec<typename std::iterator_traits<InputIterator>::value_type>::type from_codec;
+
+  ToString result;
+  detail::convert_range<ToCodec, from_codec>(begin, end, result, policy,
+    typename detail::use_block_path<ToCodec, from_codec, ToString,
+      InputIterator>::type());
+  return result;
+}
+
+//  iterator range, allocator
+template <class ToCodec,
+# ifndef BOOST_NO_FUNCTION_TEMPLATE_DEFAULT_ARGS
+          class FromCodec = default_codec,
+# else
+          class FromCodec,
+# endif
+          class InputIterator, class InputIterator2, class Allocator> inline
+typename boost::lazy_enable_if_c<detail::is_allocator<Allocator>::value
+  && boost::is_iterator<InputIterator2>::value,
+detail::allocator_string<ToCodec, Allocator> >::type
+make_string(InputIterator begin, InputIterator2 end, const Allocator& a)
+{
+  return make_string<ToCodec, FromCodec>(begin, end, throw_on_error(), a);
+}
+
+//  iterator range, error policy, allocator
+template <class ToCodec,
+# ifndef BOOST_NO_FUNCTION_TEMPLATE_DEFAULT_ARGS
+          class FromCodec = default_codec,
+# else
+          class FromCodec,
+# endif
+          class InputIterator, class InputIterator2, class ErrorPolicy,
+          class Allocator> inline
+typename boost::lazy_enable_if_c<is_error_policy<ErrorPolicy>::value
+  && detail::is_allocator<Allocator>::value
+  && boost::is_iterator<InputIterator2>::value,
+detail::allocator_string<ToCodec, Allocator> >::type
+make_string(InputIterator begin, InputIterator2 end, ErrorPolicy policy,
+  const Allocator& a)
+{
+  typedef typename FromCodec::template
+    codec<typename std::iterator_traits<InputIterator>::value_type>::type from_codec;
+  typedef typename detail::allocator_string<ToCodec, Allocator>::type string_type;
+
+  typename string_type::allocator_type alloc(a);
+  string_type result(alloc);
+  detail::convert_range<ToCodec, from_codec>(begin, end, result, policy,
+    typename detail::use_block_path<ToCodec, from_codec, string_type,
+      InputIterator>::type());
+  return result;
+}
+
+//--------------------------------------------------------------------------------------//
+//                               make_string aliases                                    //
+//--------------------------------------------------------------------------------------//
+
+//--------------------------------  to_narrow()  -------------------------------------//
+//  container
+template <
+# ifndef BOOST_NO_FUNCTION_TEMPLATE_DEFAULT_ARGS
+          class FromCodec = default_codec,
+          class ToString = std::basic_string<char>,
+# else
+          class FromCodec, class ToString,
+# endif
+          class FromString> inline
+  // disable_if resolves ambiguity with single iterator overload
+typename boost::disable_if<boost::is_iterator<typename boost::decay<FromString>::type>,
+ToString>::type
+to_narrow(const FromString& s) {return make_string<narrow, FromCodec, ToString>(s);}
+
+//  null terminated iterator
+template <
+# ifndef BOOST_NO_FUNCTION_TEMPLATE_DEFAULT_ARGS
+          class FromCodec = default_codec,
+          class ToString = std::basic_string<char>,
+# else
+          class FromCodec, class ToString,
+# endif
+          class InputIterator> inline
+  // enable_if resolves ambiguity with FromString overload
+typename boost::enable_if<boost::is_iterator<InputIterator>,
+ToString>::type
+to_narrow(InputIterator begin) {return make_string<narrow, FromCodec, ToString>(begin);}
 
 //  iterator, size
 template <
@@ -1139,6 +3680,61 @@ typename boost::enable_if<boost::is_iterator<InputIterator2>,
 ToString>::type to_narrow(InputIterator begin, InputIterator2 end)
   {return make_string<narrow, FromCodec, ToString>(begin, end);}
 
+//  container, allocator
+template <
+# ifndef BOOST_NO_FUNCTION_TEMPLATE_DEFAULT_ARGS
+          class FromCodec = default_codec,
+# else
+          class FromCodec,
+# endif
+          class FromString, class Allocator> inline
+typename boost::lazy_enable_if_c<detail::is_allocator<Allocator>::value
+  && !boost::is_iterator<typename boost::decay<FromString>::type>::value,
+detail::allocator_string<narrow, Allocator> >::type
+to_narrow(const FromString& s, const Allocator& a)
+  {return make_string<narrow, FromCodec>(s, a);}
+
+//  null terminated iterator, allocator
+template <
+# ifndef BOOST_NO_FUNCTION_TEMPLATE_DEFAULT_ARGS
+          class FromCodec = default_codec,
+# else
+          class FromCodec,
+# endif
+          class InputIterator, class Allocator> inline
+typename boost::lazy_enable_if_c<detail::is_allocator<Allocator>::value
+  && boost::is_iterator<InputIterator>::value,
+detail::allocator_string<narrow, Allocator> >::type
+to_narrow(InputIterator begin, const Allocator& a)
+  {return make_string<narrow, FromCodec>(begin, a);}
+
+//  iterator, size, allocator
+template <
+# ifndef BOOST_NO_FUNCTION_TEMPLATE_DEFAULT_ARGS
+          class FromCodec = default_codec,
+# else
+          class FromCodec,
+# endif
+          class InputIterator, class Allocator> inline
+typename boost::lazy_enable_if<detail::is_allocator<Allocator>,
+detail::allocator_string<narrow, Allocator> >::type
+to_narrow(InputIterator begin, std::size_t sz, const Allocator& a)
+  {return make_string<narrow, FromCodec>(begin, sz, a);}
+
+//  iterator range, allocator
+template <
+# ifndef BOOST_NO_FUNCTION_TEMPLATE_DEFAULT_ARGS
+          class FromCodec = default_codec,
+# else
+          class FromCodec,
+# endif
+          class InputIterator, class InputIterator2, class Allocator> inline
+typename boost::lazy_enable_if_c<detail::is_allocator<Allocator>::value
+  && boost::is_iterator<InputIterator2>::value,
+detail::allocator_string<narrow, Allocator> >::type
+to_narrow(InputIterator begin, InputIterator2 end, const Allocator& a)
+  {return make_string<narrow, FromCodec>(begin, end, a);}
+
 //--------------------------------  to_wide()  -------------------------------------//
 //  container
 template <
@@ -1194,6 +3790,61 @@ typename boost::enable_if<boost::is_iterator<InputIterator2>,
 ToString>::type to_wide(InputIterator begin, InputIterator2 end)
   {return make_string<wide, FromCodec, ToString>(begin, end);}
 
+//  container, allocator
+template <
+# ifndef BOOST_NO_FUNCTION_TEMPLATE_DEFAULT_ARGS
+          class FromCodec = default_codec,
+# else
+          class FromCodec,
+# endif
+          class FromString, class Allocator> inline
+typename boost::lazy_enable_if_c<detail::is_allocator<Allocator>::value
+  && !boost::is_iterator<typename boost::decay<FromString>::type>::value,
+detail::allocator_string<wide, Allocator> >::type
+to_wide(const FromString& s, const Allocator& a)
+  {return make_string<wide, FromCodec>(s, a);}
+
+//  null terminated iterator, allocator
+template <
+# ifndef BOOST_NO_FUNCTION_TEMPLATE_DEFAULT_ARGS
+          class FromCodec = default_codec,
+# else
+          class FromCodec,
+# endif
+          class InputIterator, class Allocator> inline
+typename boost::lazy_enable_if_c<detail::is_allocator<Allocator>::value
+  && boost::is_iterator<InputIterator>::value,
+detail::allocator_string<wide, Allocator> >::type
+to_wide(InputIterator begin, const Allocator& a)
+  {return make_string<wide, FromCodec>(begin, a);}
+
+//  iterator, size, allocator
+template <
+# ifndef BOOST_NO_FUNCTION_TEMPLATE_DEFAULT_ARGS
+          class FromCodec = default_codec,
+# else
+          class FromCodec,
+# endif
+          class InputIterator, class Allocator> inline
+typename boost::lazy_enable_if<detail::is_allocator<Allocator>,
+detail::allocator_string<wide, Allocator> >::type
+to_wide(InputIterator begin, std::size_t sz, const Allocator& a)
+  {return make_string<wide, FromCodec>(begin, sz, a);}
+
+//  iterator range, allocator
+template <
+# ifndef BOOST_NO_FUNCTION_TEMPLATE_DEFAULT_ARGS
+          class FromCodec = default_codec,
+# else
+          class FromCodec,
+# endif
+          class InputIterator, class InputIterator2, class Allocator> inline
+typename boost::lazy_enable_if_c<detail::is_allocator<Allocator>::value
+  && boost::is_iterator<InputIterator2>::value,
+detail::allocator_string<wide, Allocator> >::type
+to_wide(InputIterator begin, InputIterator2 end, const Allocator& a)
+  {return make_string<wide, FromCodec>(begin, end, a);}
+
 //--------------------------------  to_utf8()  -------------------------------------//
 //  container
 template <
@@ -1249,6 +3900,61 @@ typename boost::enable_if<boost::is_iterator<InputIterator2>,
 ToString>::type to_utf8(InputIterator begin, InputIterator2 end)
   {return make_string<utf8, FromCodec, ToString>(begin, end);}
 
+//  container, allocator
+template <
+# ifndef BOOST_NO_FUNCTION_TEMPLATE_DEFAULT_ARGS
+          class FromCodec = default_codec,
+# else
+          class FromCodec,
+# endif
+          class FromString, class Allocator> inline
+typename boost::lazy_enable_if_c<detail::is_allocator<Allocator>::value
+  && !boost::is_iterator<typename boost::decay<FromString>::type>::value,
+detail::allocator_string<utf8, Allocator> >::type
+to_utf8(const FromString& s, const Allocator& a)
+  {return make_string<utf8, FromCodec>(s, a);}
+
+//  null terminated iterator, allocator
+template <
+# ifndef BOOST_NO_FUNCTION_TEMPLATE_DEFAULT_ARGS
+          class FromCodec = default_codec,
+# else
+          class FromCodec,
+# endif
+          class InputIterator, class Allocator> inline
+typename boost::lazy_enable_if_c<detail::is_allocator<Allocator>::value
+  && boost::is_iterator<InputIterator>::value,
+detail::allocator_string<utf8, Allocator> >::type
+to_utf8(InputIterator begin, const Allocator& a)
+  {return make_string<utf8, FromCodec>(begin, a);}
+
+//  iterator, size, allocator
+template <
+# ifndef BOOST_NO_FUNCTION_TEMPLATE_DEFAULT_ARGS
+          class FromCodec = default_codec,
+# else
+          class FromCodec,
+# endif
+          class InputIterator, class Allocator> inline
+typename boost::lazy_enable_if<detail::is_allocator<Allocator>,
+detail::allocator_string<utf8, Allocator> >::type
+to_utf8(InputIterator begin, std::size_t sz, const Allocator& a)
+  {return make_string<utf8, FromCodec>(begin, sz, a);}
+
+//  iterator range, allocator
+template <
+# ifndef BOOST_NO_FUNCTION_TEMPLATE_DEFAULT_ARGS
+          class FromCodec = default_codec,
+# else
+          class FromCodec,
+# endif
+          class InputIterator, class InputIterator2, class Allocator> inline
+typename boost::lazy_enable_if_c<detail::is_allocator<Allocator>::value
+  && boost::is_iterator<InputIterator2>::value,
+detail::allocator_string<utf8, Allocator> >::type
+to_utf8(InputIterator begin, InputIterator2 end, const Allocator& a)
+  {return make_string<utf8, FromCodec>(begin, end, a);}
+
 //--------------------------------  to_utf16()  -------------------------------------//
 //  container
 template <
@@ -1304,6 +4010,61 @@ typename boost::enable_if<boost::is_iterator<InputIterator2>,
 ToString>::type to_utf16(InputIterator begin, InputIterator2 end)
   {return make_string<utf16, FromCodec, ToString>(begin, end);}
 
+//  container, allocator
+template <
+# ifndef BOOST_NO_FUNCTION_TEMPLATE_DEFAULT_ARGS
+          class FromCodec = default_codec,
+# else
+          class FromCodec,
+# endif
+          class FromString, class Allocator> inline
+typename boost::lazy_enable_if_c<detail::is_allocator<Allocator>::value
+  && !boost::is_iterator<typename boost::decay<FromString>::type>::value,
+detail::allocator_string<utf16, Allocator> >::type
+to_utf16(const FromString& s, const Allocator& a)
+  {return make_string<utf16, FromCodec>(s, a);}
+
+//  null terminated iterator, allocator
+template <
+# ifndef BOOST_NO_FUNCTION_TEMPLATE_DEFAULT_ARGS
+          class FromCodec = default_codec,
+# else
+          class FromCodec,
+# endif
+          class InputIterator, class Allocator> inline
+typename boost::lazy_enable_if_c<detail::is_allocator<Allocator>::value
+  && boost::is_iterator<InputIterator>::value,
+detail::allocator_string<utf16, Allocator> >::type
+to_utf16(InputIterator begin, const Allocator& a)
+  {return make_string<utf16, FromCodec>(begin, a);}
+
+//  iterator, size, allocator
+template <
+# ifndef BOOST_NO_FUNCTION_TEMPLATE_DEFAULT_ARGS
+          class FromCodec = default_codec,
+# else
+          class FromCodec,
+# endif
+          class InputIterator, class Allocator> inline
+typename boost::lazy_enable_if<detail::is_allocator<Allocator>,
+detail::allocator_string<utf16, Allocator> >::type
+to_utf16(InputIterator begin, std::size_t sz, const Allocator& a)
+  {return make_string<utf16, FromCodec>(begin, sz, a);}
+
+//  iterator range, allocator
+template <
+# ifndef BOOST_NO_FUNCTION_TEMPLATE_DEFAULT_ARGS
+          class FromCodec = default_codec,
+# else
+          class FromCodec,
+# endif
+          class InputIterator, class InputIterator2, class Allocator> inline
+typename boost::lazy_enable_if_c<detail::is_allocator<Allocator>::value
+  && boost::is_iterator<InputIterator2>::value,
+detail::allocator_string<utf16, Allocator> >::type
+to_utf16(InputIterator begin, InputIterator2 end, const Allocator& a)
+  {return make_string<utf16, FromCodec>(begin, end, a);}
+
 //--------------------------------  to_utf32()  -------------------------------------//
 //  container
 template <
@@ -1359,6 +4120,61 @@ typename boost::enable_if<boost::is_iterator<InputIterator2>,
 ToString>::type to_utf32(InputIterator begin, InputIterator2 end)
   {return make_string<utf32, FromCodec, ToString>(begin, end);}
 
+//  container, allocator
+template <
+# ifndef BOOST_NO_FUNCTION_TEMPLATE_DEFAULT_ARGS
+          class FromCodec = default_codec,
+# else
+          class FromCodec,
+# endif
+          class FromString, class Allocator> inline
+typename boost::lazy_enable_if_c<detail::is_allocator<Allocator>::value
+  && !boost::is_iterator<typename boost::decay<FromString>::type>::value,
+detail::allocator_string<utf32, Allocator> >::type
+to_utf32(const FromString& s, const Allocator& a)
+  {return make_string<utf32, FromCodec>(s, a);}
+
+//  null terminated iterator, allocator
+template <
+# ifndef BOOST_NO_FUNCTION_TEMPLATE_DEFAULT_ARGS
+          class FromCodec = default_codec,
+# else
+          class FromCodec,
+# endif
+          class InputIterator, class Allocator> inline
+typename boost::lazy_enable_if_c<detail::is_allocator<Allocator>::value
+  && boost::is_iterator<InputIterator>::value,
+detail::allocator_string<utf32, Allocator> >::type
+to_utf32(InputIterator begin, const Allocator& a)
+  {return make_string<utf32, FromCodec>(begin, a);}
+
+//  iterator, size, allocator
+template <
+# ifndef BOOST_NO_FUNCTION_TEMPLATE_DEFAULT_ARGS
+          class FromCodec = default_codec,
+# else
+          class FromCodec,
+# endif
+          class InputIterator, class Allocator> inline
+typename boost::lazy_enable_if<detail::is_allocator<Allocator>,
+detail::allocator_string<utf32, Allocator> >::type
+to_utf32(InputIterator begin, std::size_t sz, const Allocator& a)
+  {return make_string<utf32, FromCodec>(begin, sz, a);}
+
+//  iterator range, allocator
+template <
+# ifndef BOOST_NO_FUNCTION_TEMPLATE_DEFAULT_ARGS
+          class FromCodec = default_codec,
+# else
+          class FromCodec,
+# endif
+          class InputIterator, class InputIterator2, class Allocator> inline
+typename boost::lazy_enable_if_c<detail::is_allocator<Allocator>::value
+  && boost::is_iterator<InputIterator2>::value,
+detail::allocator_string<utf32, Allocator> >::type
+to_utf32(InputIterator begin, InputIterator2 end, const Allocator& a)
+  {return make_string<utf32, FromCodec>(begin, end, a);}
+
 }  // namespace interop
 }  // namespace boost
 
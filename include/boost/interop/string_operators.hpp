@@ -16,9 +16,16 @@
 #define BOOST_STRING_OPERATORS_HPP
 
 #include <boost/interop/string_interop.hpp>
+#include <boost/interop/transcoder.hpp>
+#include <boost/static_assert.hpp>
+#include <boost/type_traits/is_same.hpp>
+#include <cstddef>
 #include <string>
 #include <iterator>
 #include <algorithm>
+#ifdef BOOST_INTEROP_SPAN
+# include <span>
+#endif
 
 namespace boost
 {
@@ -35,15 +42,141 @@ inline
 OutputIterator
 copy_string(InputIterator first, InputIterator last, OutputIterator result)
 {
-std::cout << "copy_string" << std::endl;
   typedef conversion_iterator<ToCodec,
     typename FromCodec::template
       codec<typename std::iterator_traits<InputIterator>::value_type>::type,
     InputIterator>
       iter_type;
+#ifndef BOOST_INTEROP_STATS
   return std::copy(iter_type(first, last), iter_type(), result);
+#else
+  //  count the output, which conversion_iterator itself cannot
+  std::size_t n = 0;
+  for (iter_type it(first, last), end; it != end; ++it, ++result, ++n)
+    *result = *it;
+  BOOST_INTEROP_STATS_UNITS(ToCodec, typename FromCodec::template
+    codec<typename std::iterator_traits<InputIterator>::value_type>::type, 0, n);
+  return result;
+#endif
 }
 
+//--------------------------------------------------------------------------------------//
+//                               transcode algorithm                                    //
+//--------------------------------------------------------------------------------------//
+
+//  transcode() converts a contiguous source into a caller supplied buffer, such as a
+//  stack array, a ring buffer segment, or a mapped file, without allocating. It
+//  returns the input units consumed, the output units written, and a status:
+//
+//  ok                all input was converted.
+//  output_full       the next code point does not fit; resume at first + consumed.
+//  incomplete_input  the input ends in the middle of a sequence, which was not
+//                    consumed. See transcoder for input that arrives in chunks.
+//  invalid           the sequence at first + consumed is invalid.
+//
+//  As with make_string(), each codec defaults to the one selected by the
+//  corresponding character type. Both must be BlockCodecs.
+
+//  pointer range
+template <
+# ifndef BOOST_NO_FUNCTION_TEMPLATE_DEFAULT_ARGS
+          class ToCodec = default_codec,
+          class FromCodec = default_codec,
+# else
+          class ToCodec,
+          class FromCodec,
+# endif
+          class FromCharT, class ToCharT>
+inline transcode_result transcode(const FromCharT* first, const FromCharT* last,
+  ToCharT* out, ToCharT* out_last)
+{
+  typedef typename FromCodec::template codec<FromCharT>::type from_codec;
+  typedef typename ToCodec::template codec<ToCharT>::type to_codec;
+  BOOST_STATIC_ASSERT_MSG((detail::has_block_interface<to_codec>::value
+    && detail::has_block_interface<from_codec>::value),
+    "transcode() requires BlockCodecs");
+  BOOST_STATIC_ASSERT_MSG((boost::is_same<typename from_codec::value_type,
+    FromCharT>::value && boost::is_same<typename to_codec::value_type, ToCharT>::value),
+    "codec value_type does not match the character type");
+
+  const FromCharT* const begin = first;
+  ToCharT* const out_begin = out;
+  char32 cp = 0;
+  transcode_result result;
+  switch (detail::block_converter<to_codec, from_codec>::convert(
+    first, last, out, out_last, cp))
+  {
+  case detail::block_ok:          result.status = transcode_status::ok; break;
+  case detail::block_output_full: result.status = transcode_status::output_full; break;
+  case detail::block_incomplete:  result.status = transcode_status::incomplete_input;
+                                  break;
+  default:                        result.status = transcode_status::invalid; break;
+  }
+  result.consumed = first - begin;
+  result.written = out - out_begin;
+  return result;
+}
+
+//  contiguous container, buffer of n units
+template <
+# ifndef BOOST_NO_FUNCTION_TEMPLATE_DEFAULT_ARGS
+          class ToCodec = default_codec,
+          class FromCodec = default_codec,
+# else
+          class ToCodec,
+          class FromCodec,
+# endif
+          class FromString, class ToCharT>
+inline
+typename boost::disable_if<boost::is_iterator<typename boost::decay<FromString>::type>,
+transcode_result>::type transcode(const FromString& src, ToCharT* out, std::size_t n)
+{
+  BOOST_STATIC_ASSERT_MSG(detail::is_contiguous_container<FromString>::value,
+    "transcode() requires a contiguous source");
+  typedef typename FromString::value_type from_type;
+  const from_type* first = src.empty() ? 0 : &*src.begin();
+  return transcode<ToCodec, FromCodec>(first, first + src.size(), out, out + n);
+}
+
+//  contiguous container, array
+template <
+# ifndef BOOST_NO_FUNCTION_TEMPLATE_DEFAULT_ARGS
+          class ToCodec = default_codec,
+          class FromCodec = default_codec,
+# else
+          class ToCodec,
+          class FromCodec,
+# endif
+          class FromString, class ToCharT, std::size_t N>
+inline
+typename boost::disable_if<boost::is_iterator<typename boost::decay<FromString>::type>,
+transcode_result>::type transcode(const FromString& src, ToCharT (&dst)[N])
+{
+  return transcode<ToCodec, FromCodec>(src, dst, N);
+}
+
+#ifdef BOOST_INTEROP_SPAN
+//  spans
+template <class ToCodec = default_codec, class FromCodec = default_codec,
+          class FromCharT, std::size_t N, class ToCharT, std::size_t M>
+inline transcode_result transcode(std::span<FromCharT, N> src,
+  std::span<ToCharT, M> dst)
+{
+  return transcode<ToCodec, FromCodec>(src.data(), src.data() + src.size(),
+    dst.data(), dst.data() + dst.size());
+}
+
+//  contiguous container, span
+template <class ToCodec = default_codec, class FromCodec = default_codec,
+          class FromString, class ToCharT, std::size_t M>
+inline
+typename boost::disable_if<boost::is_iterator<typename boost::decay<FromString>::type>,
+transcode_result>::type transcode(const FromString& src, std::span<ToCharT, M> dst)
+{
+  return transcode<ToCodec, FromCodec>(src, dst.data(), dst.size());
+}
+#endif
+
 //--------------------------------------------------------------------------------------//
 //                                     assign                                           //
 //--------------------------------------------------------------------------------------//
@@ -55,9 +188,9 @@ std::basic_string<charT1, traits1, Allocator1>&
 assign(std::basic_string<charT1, traits1, Allocator1>& to,
        const std::basic_string<charT2, traits2, Allocator2>& from)
 {
-std::cout << "assign" << std::endl;
   std::basic_string<charT1, traits1, Allocator1> tmp;
-  copy_string<select_codec<charT2>::type, select_codec<charT1>::type>
+  copy_string<typename select_codec<charT2>::type,
+    typename select_codec<charT1>::type>
     (from.cbegin(), from.cend(), std::back_inserter(tmp));
   std::swap(tmp, to);
   return to;
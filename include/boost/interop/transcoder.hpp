@@ -0,0 +1,214 @@
+//  boost/interop/transcoder.hpp  ------------------------------------------------------//
+
+//  Copyright Beman Dawes 2012
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+//--------------------------------------------------------------------------------------//
+//                                                                                      //
+//  Incremental conversion of input that arrives in chunks.                             //
+//                                                                                      //
+//  A transcoder<ToCodec, FromCodec> converts a stream one chunk at a time into         //
+//  caller supplied buffers. A multi-unit sequence split across chunks, such as a       //
+//  UTF-8 sequence or a UTF-16 surrogate pair, is held by the transcoder and completed  //
+//  by the next feed(), so the stream never needs to be concatenated.                   //
+//                                                                                      //
+//  Both codecs must be BlockCodecs (see string_interop.hpp).                           //
+//                                                                                      //
+//--------------------------------------------------------------------------------------//
+
+#if !defined(BOOST_INTEROP_TRANSCODER_HPP)
+# define BOOST_INTEROP_TRANSCODER_HPP
+
+#include <boost/interop/string_interop.hpp>
+#include <boost/static_assert.hpp>
+#include <cstddef>
+
+#include <boost/config/abi_prefix.hpp> // must be the last #include
+
+namespace boost
+{
+namespace interop
+{
+
+//--------------------------------------------------------------------------------------//
+//                                 transcode_result                                     //
+//--------------------------------------------------------------------------------------//
+
+namespace transcode_status
+{
+  enum type
+  {
+    ok,                // all input was consumed
+    output_full,       // the output buffer has no room for the next code point
+    incomplete_input,  // the input ended in the middle of a sequence
+    invalid            // an invalid sequence was encountered
+  };
+}
+
+struct transcode_result
+{
+  std::size_t             consumed;  // input units consumed
+  std::size_t             written;   // output units written
+  transcode_status::type  status;
+};
+
+//--------------------------------------------------------------------------------------//
+//                                    transcoder                                        //
+//--------------------------------------------------------------------------------------//
+
+template <class ToCodec, class FromCodec>
+class transcoder
+{
+  BOOST_STATIC_ASSERT_MSG((detail::has_block_interface<ToCodec>::value
+    && detail::has_block_interface<FromCodec>::value),
+    "transcoder requires BlockCodecs");
+
+public:
+  typedef typename FromCodec::value_type  from_type;
+  typedef typename ToCodec::value_type    to_type;
+
+  transcoder() : m_pending(), m_pending_size(0) {}
+
+  //  Converts the chunk [first, last) into [out, out_last).
+  //
+  //  status is ok when the whole chunk has been consumed. A sequence left incomplete at
+  //  the end of the chunk is consumed too, and held until the next feed() completes it.
+  //
+  //  status is output_full when the next code point does not fit. Call feed() again
+  //  with [first + consumed, last) and more room.
+  //
+  //  status is invalid when the chunk, or a held sequence completed by it, is not valid
+  //  input. consumed then counts the units of the chunk before the invalid sequence, or
+  //  is 0 if the sequence began in an earlier chunk. The held sequence is discarded.
+  transcode_result feed(const from_type* first, const from_type* last,
+    to_type* out, to_type* out_last)
+  {
+    const from_type* const chunk = first;
+    to_type* const out_first = out;
+    transcode_result result;
+    result.status = transcode_status::ok;
+
+    if (m_pending_size)
+      result.status = complete_pending(first, last, out, out_last);
+
+    if (result.status == transcode_status::ok && first != last)
+    {
+      char32 cp = 0;
+      switch (detail::block_converter<ToCodec, FromCodec>::convert(
+        first, last, out, out_last, cp))
+      {
+      case detail::block_ok:
+        break;
+      case detail::block_output_full:
+        result.status = transcode_status::output_full;
+        break;
+      case detail::block_incomplete:
+        //  [first, last) is the start of a sequence; hold it
+        for (; first != last; ++first)
+          m_pending[m_pending_size++] = *first;
+        break;
+      case detail::block_invalid:
+        result.status = transcode_status::invalid;
+        break;
+      }
+    }
+
+    result.consumed = first - chunk;
+    result.written = out - out_first;
+    return result;
+  }
+
+  //  Appends the conversion of [first, last) to s. Returns ok or invalid.
+  template <class ToString>
+  transcode_status::type feed(const from_type* first, const from_type* last,
+    ToString& s)
+  {
+    std::size_t pos = s.size();
+    std::size_t room = (last - first) + ToCodec::max_units;
+    for (;;)
+    {
+      s.resize(pos + room);
+      to_type* base = &s[0];
+      transcode_result r = feed(first, last, base + pos, base + s.size());
+      first += r.consumed;
+      pos += r.written;
+      if (r.status != transcode_status::output_full)
+      {
+        s.resize(pos);
+        return r.status;
+      }
+      room = (last - first) * ToCodec::max_units + ToCodec::max_units;
+    }
+  }
+
+  //  Signals the end of the stream. Returns incomplete_input if a sequence is still
+  //  held, otherwise ok. Either way the transcoder is ready for a new stream.
+  transcode_status::type finish()
+  {
+    bool incomplete = m_pending_size != 0;
+    m_pending_size = 0;
+    return incomplete ? transcode_status::incomplete_input : transcode_status::ok;
+  }
+
+  //  true if part of a sequence is held awaiting the next chunk
+  bool pending() const { return m_pending_size != 0; }
+
+  void reset() { m_pending_size = 0; }
+
+private:
+  from_type  m_pending[FromCodec::max_units];
+  unsigned   m_pending_size;
+
+  //  Completes the held sequence with units from [first, last), advancing first past
+  //  those units once the code point has been written.
+  transcode_status::type complete_pending(const from_type*& first,
+    const from_type* last, to_type*& out, to_type* out_last)
+  {
+    from_type units[FromCodec::max_units];
+    unsigned size = m_pending_size;
+    for (unsigned i = 0; i < size; ++i)
+      units[i] = m_pending[i];
+
+    const from_type* next = first;
+    for (;;)
+    {
+      const from_type* p = units;
+      const from_type* const units_end = units + size;
+      char32 cp;
+      detail::decode_status status = FromCodec::decode(p, units_end, cp);
+      if (status == detail::decode_ok)
+      {
+        if (static_cast<std::size_t>(out_last - out) < ToCodec::encoded_length(cp))
+          return transcode_status::output_full;  // held sequence left intact
+        out = ToCodec::encode(cp, out);
+        first = next;
+        m_pending_size = 0;
+        return transcode_status::ok;
+      }
+      if (status == detail::decode_invalid || size == FromCodec::max_units)
+      {
+        m_pending_size = 0;
+        return transcode_status::invalid;
+      }
+      if (next == last)
+      {
+        //  still incomplete; hold what we have
+        for (unsigned i = m_pending_size; i < size; ++i)
+          m_pending[i] = units[i];
+        m_pending_size = size;
+        first = next;
+        return transcode_status::ok;
+      }
+      units[size++] = *next++;
+    }
+  }
+};
+
+}  // namespace interop
+}  // namespace boost
+
+#include <boost/config/abi_suffix.hpp> // pops abi_prefix.hpp pragmas
+
+#endif  // BOOST_INTEROP_TRANSCODER_HPP
@@ -0,0 +1,183 @@
+//  boost/interop/transcoding_streambuf.hpp  -------------------------------------------//
+
+//  Copyright Beman Dawes 2012
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+//--------------------------------------------------------------------------------------//
+//                                                                                      //
+//  A streambuf that transcodes to and from another streambuf.                          //
+//                                                                                      //
+//  transcoding_streambuf<InternCodec, ExternCodec> presents InternCodec characters,    //
+//  and reads and writes ExternCodec units through an underlying streambuf, such as a   //
+//  filebuf opened in binary mode or a stringbuf:                                       //
+//                                                                                      //
+//    std::filebuf file;                                                                //
+//    file.open("log.txt", std::ios_base::out | std::ios_base::binary);                 //
+//    transcoding_streambuf<wide, utf8> buf(&file);                                     //
+//    std::wostream os(&buf);                                                           //
+//                                                                                      //
+//  Unlike basic_filebuf and a codecvt facet, it works with any underlying streambuf    //
+//  and any internal character type. Each underflow() and overflow() converts a full    //
+//  buffer with the block kernels. The underlying streambuf must outlive it.            //
+//                                                                                      //
+//  Invalid input makes underflow() return eof, and invalid output makes overflow() and //
+//  sync() fail. A sequence still incomplete at the end of the input is invalid. The    //
+//  streambuf does not support seeking.                                                 //
+//                                                                                      //
+//  Both codecs must be BlockCodecs (see string_interop.hpp).                           //
+//                                                                                      //
+//--------------------------------------------------------------------------------------//
+
+#if !defined(BOOST_INTEROP_TRANSCODING_STREAMBUF_HPP)
+# define BOOST_INTEROP_TRANSCODING_STREAMBUF_HPP
+
+#include <boost/interop/string_interop.hpp>
+#include <boost/static_assert.hpp>
+#include <cstddef>
+#include <streambuf>
+#include <string>
+
+#include <boost/config/abi_prefix.hpp> // must be the last #include
+
+namespace boost
+{
+namespace interop
+{
+
+template <class InternCodec, class ExternCodec = utf8,
+  class Traits = std::char_traits<typename InternCodec::value_type> >
+class transcoding_streambuf
+  : public std::basic_streambuf<typename InternCodec::value_type, Traits>
+{
+  BOOST_STATIC_ASSERT_MSG((detail::has_block_interface<InternCodec>::value
+    && detail::has_block_interface<ExternCodec>::value),
+    "transcoding_streambuf requires BlockCodecs");
+
+public:
+  typedef typename InternCodec::value_type           char_type;
+  typedef Traits                                     traits_type;
+  typedef typename traits_type::int_type             int_type;
+  typedef typename ExternCodec::value_type           extern_type;
+  typedef std::basic_streambuf<extern_type>          extern_streambuf;
+
+  BOOST_STATIC_CONSTANT(std::size_t, buffer_size = 1024);
+
+  explicit transcoding_streambuf(extern_streambuf* next)
+    : m_next(next), m_extern_size(0)
+  {
+    this->setg(m_get, m_get, m_get);
+    this->setp(m_put, m_put + buffer_size);
+  }
+
+  //  writes any buffered output to the underlying streambuf
+  ~transcoding_streambuf() { flush(); }
+
+  extern_streambuf* next() const { return m_next; }
+
+protected:
+  int_type underflow()
+  {
+    if (this->gptr() != this->egptr())
+      return traits_type::to_int_type(*this->gptr());
+
+    for (;;)
+    {
+      //  refill the external buffer behind any incomplete sequence held over
+      std::streamsize n = m_next->sgetn(m_extern + m_extern_size,
+        static_cast<std::streamsize>(buffer_size - m_extern_size));
+      m_extern_size += static_cast<std::size_t>(n);
+      if (m_extern_size == 0)
+        return traits_type::eof();
+
+      const extern_type* first = m_extern;
+      const extern_type* last = m_extern + m_extern_size;
+      char_type* out = m_get;
+      char32 cp = 0;
+      detail::block_status status = detail::block_converter<InternCodec, ExternCodec>
+        ::convert(first, last, out, m_get + buffer_size, cp);
+      bool failed = status == detail::block_invalid
+        || (status == detail::block_incomplete && n == 0);
+      if (failed && out == m_get)
+      {
+        m_extern_size = 0;
+        return traits_type::eof();
+      }
+
+      //  keep what was not converted for the next refill; after a failure that is the
+      //  invalid sequence, which ends the input once what precedes it has been read
+      m_extern_size = last - first;
+      move_units(m_extern, first, m_extern_size);
+      if (out != m_get)
+      {
+        this->setg(m_get, m_get, out);
+        return traits_type::to_int_type(*m_get);
+      }
+    }
+  }
+
+  int_type overflow(int_type c = traits_type::eof())
+  {
+    if (!flush())
+      return traits_type::eof();
+    if (traits_type::eq_int_type(c, traits_type::eof()))
+      return traits_type::not_eof(c);
+    *this->pptr() = traits_type::to_char_type(c);
+    this->pbump(1);
+    return c;
+  }
+
+  int sync()
+  {
+    return flush() && m_next->pubsync() != -1 ? 0 : -1;
+  }
+
+private:
+  extern_streambuf*  m_next;
+  char_type          m_get[buffer_size];
+  char_type          m_put[buffer_size];
+  extern_type        m_extern[buffer_size];  // input held over between refills
+  std::size_t        m_extern_size;
+
+  //  to does not follow from, so a forward copy is safe when the ranges overlap
+  template <class T>
+  static void move_units(T* to, const T* from, std::size_t n)
+  {
+    for (; n; --n)
+      *to++ = *from++;
+  }
+
+  //  converts and writes the put area, keeping an incomplete trailing sequence; returns
+  //  false on invalid output or if the underlying streambuf fails
+  bool flush()
+  {
+    extern_type buffer[buffer_size];
+    const char_type* first = this->pbase();
+    const char_type* last = this->pptr();
+    while (first != last)
+    {
+      extern_type* out = buffer;
+      char32 cp = 0;
+      detail::block_status status = detail::block_converter<ExternCodec, InternCodec>
+        ::convert(first, last, out, buffer + buffer_size, cp);
+      std::streamsize n = out - buffer;
+      if (m_next->sputn(buffer, n) != n || status == detail::block_invalid)
+        return false;
+      if (status == detail::block_incomplete)
+        break;
+    }
+    std::size_t held = last - first;
+    move_units(m_put, first, held);
+    this->setp(m_put, m_put + buffer_size);
+    this->pbump(static_cast<int>(held));
+    return true;
+  }
+};
+
+}  // namespace interop
+}  // namespace boost
+
+#include <boost/config/abi_suffix.hpp> // pops abi_prefix.hpp pragmas
+
+#endif  // BOOST_INTEROP_TRANSCODING_STREAMBUF_HPP
@@ -0,0 +1,172 @@
+//  libs/interop/src/codepage_1250.cpp  ------------------------------------------------//
+
+//  Copyright Beman Dawes 2011
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+// define BOOST_INTEROP_SOURCE so that <boost/interop/config.hpp> knows
+// the library is being built (possibly exporting rather than importing code)
+#define BOOST_INTEROP_SOURCE 
+
+#include <boost/interop/codepage_tables.hpp>
+#include <boost/static_assert.hpp>
+
+namespace boost
+{
+namespace interop
+{
+
+/****************** tables generated by tools/table_generator.cpp ***********************/
+
+/****************************** DO NOT EDIT BY HAND *************************************/
+
+const boost::char16  codepage_1250::to_utf16[256] =
+{
+0x0,0x1,0x2,0x3,0x4,0x5,0x6,0x7,0x8,0x9,0xa,0xb,0xc,0xd,0xe,0xf,
+0x10,0x11,0x12,0x13,0x14,0x15,0x16,0x17,0x18,0x19,0x1a,0x1b,0x1c,0x1d,0x1e,0x1f,
+0x20,0x21,0x22,0x23,0x24,0x25,0x26,0x27,0x28,0x29,0x2a,0x2b,0x2c,0x2d,0x2e,0x2f,
+0x30,0x31,0x32,0x33,0x34,0x35,0x36,0x37,0x38,0x39,0x3a,0x3b,0x3c,0x3d,0x3e,0x3f,
+0x40,0x41,0x42,0x43,0x44,0x45,0x46,0x47,0x48,0x49,0x4a,0x4b,0x4c,0x4d,0x4e,0x4f,
+0x50,0x51,0x52,0x53,0x54,0x55,0x56,0x57,0x58,0x59,0x5a,0x5b,0x5c,0x5d,0x5e,0x5f,
+0x60,0x61,0x62,0x63,0x64,0x65,0x66,0x67,0x68,0x69,0x6a,0x6b,0x6c,0x6d,0x6e,0x6f,
+0x70,0x71,0x72,0x73,0x74,0x75,0x76,0x77,0x78,0x79,0x7a,0x7b,0x7c,0x7d,0x7e,0x7f,
+0x20ac,0xfffd,0x201a,0xfffd,0x201e,0x2026,0x2020,0x2021,0xfffd,0x2030,0x160,0x2039,0x15a,0x164,0x17d,0x179,
+0xfffd,0x2018,0x2019,0x201c,0x201d,0x2022,0x2013,0x2014,0xfffd,0x2122,0x161,0x203a,0x15b,0x165,0x17e,0x17a,
+0xa0,0x2c7,0x2d8,0x141,0xa4,0x104,0xa6,0xa7,0xa8,0xa9,0x15e,0xab,0xac,0xad,0xae,0x17b,
+0xb0,0xb1,0x2db,0x142,0xb4,0xb5,0xb6,0xb7,0xb8,0x105,0x15f,0xbb,0x13d,0x2dd,0x13e,0x17c,
+0x154,0xc1,0xc2,0x102,0xc4,0x139,0x106,0xc7,0x10c,0xc9,0x118,0xcb,0x11a,0xcd,0xce,0x10e,
+0x110,0x143,0x147,0xd3,0xd4,0x150,0xd6,0xd7,0x158,0x16e,0xda,0x170,0xdc,0xdd,0x162,0xdf,
+0x155,0xe1,0xe2,0x103,0xe4,0x13a,0x107,0xe7,0x10d,0xe9,0x119,0xeb,0x11b,0xed,0xee,0x10f,
+0x111,0x144,0x148,0xf3,0xf4,0x151,0xf6,0xf7,0x159,0x16f,0xfa,0x171,0xfc,0xfd,0x163,0x2d9
+};
+
+BOOST_STATIC_ASSERT(sizeof(codepage_1250::to_utf16) == 2*256);
+
+const unsigned char codepage_1250::to_char[1024] =
+{
+//  slice 0 - characters with no codepage representation
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+
+//  slice 1 - 0x0
+0x00,0x1,0x2,0x3,0x4,0x5,0x6,0x7,0x8,0x9,0xa,0xb,0xc,0xd,0xe,0xf,
+0x10,0x11,0x12,0x13,0x14,0x15,0x16,0x17,0x18,0x19,0x1a,0x1b,0x1c,0x1d,0x1e,0x1f,
+0x20,0x21,0x22,0x23,0x24,0x25,0x26,0x27,0x28,0x29,0x2a,0x2b,0x2c,0x2d,0x2e,0x2f,
+0x30,0x31,0x32,0x33,0x34,0x35,0x36,0x37,0x38,0x39,0x3a,0x3b,0x3c,0x3d,0x3e,0x3f,
+0x40,0x41,0x42,0x43,0x44,0x45,0x46,0x47,0x48,0x49,0x4a,0x4b,0x4c,0x4d,0x4e,0x4f,
+0x50,0x51,0x52,0x53,0x54,0x55,0x56,0x57,0x58,0x59,0x5a,0x5b,0x5c,0x5d,0x5e,0x5f,
+0x60,0x61,0x62,0x63,0x64,0x65,0x66,0x67,0x68,0x69,0x6a,0x6b,0x6c,0x6d,0x6e,0x6f,
+0x70,0x71,0x72,0x73,0x74,0x75,0x76,0x77,0x78,0x79,0x7a,0x7b,0x7c,0x7d,0x7e,0x7f,
+
+//  slice 2 - 0x80
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+0xa0,'?','?','?',0xa4,'?',0xa6,0xa7,0xa8,0xa9,'?',0xab,0xac,0xad,0xae,'?',
+0xb0,0xb1,'?','?',0xb4,0xb5,0xb6,0xb7,0xb8,'?','?',0xbb,'?','?','?','?',
+'?',0xc1,0xc2,'?',0xc4,'?','?',0xc7,'?',0xc9,'?',0xcb,'?',0xcd,0xce,'?',
+'?','?','?',0xd3,0xd4,'?',0xd6,0xd7,'?','?',0xda,'?',0xdc,0xdd,'?',0xdf,
+'?',0xe1,0xe2,'?',0xe4,'?','?',0xe7,'?',0xe9,'?',0xeb,'?',0xed,0xee,'?',
+'?','?','?',0xf3,0xf4,'?',0xf6,0xf7,'?','?',0xfa,'?',0xfc,0xfd,'?','?',
+
+//  slice 3 - 0x100
+'?','?',0xc3,0xe3,0xa5,0xb9,0xc6,0xe6,'?','?','?','?',0xc8,0xe8,0xcf,0xef,
+0xd0,0xf0,'?','?','?','?','?','?',0xca,0xea,0xcc,0xec,'?','?','?','?',
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+'?','?','?','?','?','?','?','?','?',0xc5,0xe5,'?','?',0xbc,0xbe,'?',
+'?',0xa3,0xb3,0xd1,0xf1,'?','?',0xd2,0xf2,'?','?','?','?','?','?','?',
+0xd5,0xf5,'?','?',0xc0,0xe0,'?','?',0xd8,0xf8,0x8c,0x9c,'?','?',0xaa,0xba,
+0x8a,0x9a,0xde,0xfe,0x8d,0x9d,'?','?','?','?','?','?','?','?',0xd9,0xf9,
+0xdb,0xfb,'?','?','?','?','?','?','?',0x8f,0x9f,0xaf,0xbf,0x8e,0x9e,'?',
+
+//  slice 4 - 0x280
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+'?','?','?','?','?','?','?',0xa1,'?','?','?','?','?','?','?','?',
+'?','?','?','?','?','?','?','?',0xa2,0xff,'?',0xb2,'?',0xbd,'?','?',
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+
+//  slice 5 - 0x2000
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+'?','?','?',0x96,0x97,'?','?','?',0x91,0x92,0x82,'?',0x93,0x94,0x84,'?',
+0x86,0x87,0x95,'?','?','?',0x85,'?','?','?','?','?','?','?','?','?',
+0x89,'?','?','?','?','?','?','?','?',0x8b,0x9b,'?','?','?','?','?',
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+
+//  slice 6 - 0x2080
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+'?','?','?','?','?','?','?','?','?','?','?','?',0x80,'?','?','?',
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+
+//  slice 7 - 0x2100
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+'?','?',0x99,'?','?','?','?','?','?','?','?','?','?','?','?','?',
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+
+};
+
+BOOST_STATIC_ASSERT(sizeof(codepage_1250::to_char) == 1024);
+
+const boost::uint8_t codepage_1250::slice_index[512] =
+{
+1,2,3,0,0,4,0,0,0,0,0,0,0,0,0,0,
+0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+5,6,7,0,0,0,0,0,0,0,0,0,0,0,0,0,
+0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0
+
+};
+
+BOOST_STATIC_ASSERT(sizeof(codepage_1250::slice_index) == 512);
+
+}  // namespace interop
+}  // namespace boost
@@ -5,21 +5,23 @@
 //  Distributed under the Boost Software License, Version 1.0.
 //  See http://www.boost.org/LICENSE_1_0.txt
 
-#include <boost/interop/conversion_iterator_adapters.hpp>
+// define BOOST_INTEROP_SOURCE so that <boost/interop/config.hpp> knows
+// the library is being built (possibly exporting rather than importing code)
+#define BOOST_INTEROP_SOURCE 
+
+#include <boost/interop/codepage_tables.hpp>
 #include <boost/static_assert.hpp>
 
 namespace boost
 {
 namespace interop
 {
-namespace detail
-{
 
 /****************** tables generated by tools/table_generator.cpp ***********************/
 
 /****************************** DO NOT EDIT BY HAND *************************************/
 
-const boost::u16_t  to_utf16[] =
+const boost::char16  codepage_1252::to_utf16[256] =
 {
 0x0,0x1,0x2,0x3,0x4,0x5,0x6,0x7,0x8,0x9,0xa,0xb,0xc,0xd,0xe,0xf,
 0x10,0x11,0x12,0x13,0x14,0x15,0x16,0x17,0x18,0x19,0x1a,0x1b,0x1c,0x1d,0x1e,0x1f,
@@ -29,8 +31,8 @@ const boost::u16_t  to_utf16[] =
 0x50,0x51,0x52,0x53,0x54,0x55,0x56,0x57,0x58,0x59,0x5a,0x5b,0x5c,0x5d,0x5e,0x5f,
 0x60,0x61,0x62,0x63,0x64,0x65,0x66,0x67,0x68,0x69,0x6a,0x6b,0x6c,0x6d,0x6e,0x6f,
 0x70,0x71,0x72,0x73,0x74,0x75,0x76,0x77,0x78,0x79,0x7a,0x7b,0x7c,0x7d,0x7e,0x7f,
-0x20ac,0x0,0x201a,0x192,0x201e,0x2026,0x2020,0x2021,0x2c6,0x2030,0x160,0x2039,0x152,0x0,0x17d,0x0,
-0x0,0x2018,0x2019,0x201c,0x201d,0x2022,0x2013,0x2014,0x2dc,0x2122,0x161,0x203a,0x153,0x0,0x17e,0x178,
+0x20ac,0xfffd,0x201a,0x192,0x201e,0x2026,0x2020,0x2021,0x2c6,0x2030,0x160,0x2039,0x152,0xfffd,0x17d,0xfffd,
+0xfffd,0x2018,0x2019,0x201c,0x201d,0x2022,0x2013,0x2014,0x2dc,0x2122,0x161,0x203a,0x153,0xfffd,0x17e,0x178,
 0xa0,0xa1,0xa2,0xa3,0xa4,0xa5,0xa6,0xa7,0xa8,0xa9,0xaa,0xab,0xac,0xad,0xae,0xaf,
 0xb0,0xb1,0xb2,0xb3,0xb4,0xb5,0xb6,0xb7,0xb8,0xb9,0xba,0xbb,0xbc,0xbd,0xbe,0xbf,
 0xc0,0xc1,0xc2,0xc3,0xc4,0xc5,0xc6,0xc7,0xc8,0xc9,0xca,0xcb,0xcc,0xcd,0xce,0xcf,
@@ -39,9 +41,9 @@ const boost::u16_t  to_utf16[] =
 0xf0,0xf1,0xf2,0xf3,0xf4,0xf5,0xf6,0xf7,0xf8,0xf9,0xfa,0xfb,0xfc,0xfd,0xfe,0xff
 };
 
-BOOST_STATIC_ASSERT(sizeof(to_utf16) == 2*256);
+BOOST_STATIC_ASSERT(sizeof(codepage_1252::to_utf16) == 2*256);
 
-const unsigned char to_char[] =
+const unsigned char codepage_1252::to_char[1152] =
 {
 //  slice 0 - characters with no codepage representation
 '?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
@@ -54,7 +56,7 @@ const unsigned char to_char[] =
 '?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
 
 //  slice 1 - 0x0
-0x0,0x1,0x2,0x3,0x4,0x5,0x6,0x7,0x8,0x9,0xa,0xb,0xc,0xd,0xe,0xf,
+0x00,0x1,0x2,0x3,0x4,0x5,0x6,0x7,0x8,0x9,0xa,0xb,0xc,0xd,0xe,0xf,
 0x10,0x11,0x12,0x13,0x14,0x15,0x16,0x17,0x18,0x19,0x1a,0x1b,0x1c,0x1d,0x1e,0x1f,
 0x20,0x21,0x22,0x23,0x24,0x25,0x26,0x27,0x28,0x29,0x2a,0x2b,0x2c,0x2d,0x2e,0x2f,
 0x30,0x31,0x32,0x33,0x34,0x35,0x36,0x37,0x38,0x39,0x3a,0x3b,0x3c,0x3d,0x3e,0x3f,
@@ -135,9 +137,9 @@ const unsigned char to_char[] =
 
 };
 
-BOOST_STATIC_ASSERT(sizeof(to_char) == 1152);
+BOOST_STATIC_ASSERT(sizeof(codepage_1252::to_char) == 1152);
 
-const boost::uint8_t slice_index[] =
+const boost::uint8_t codepage_1252::slice_index[512] =
 {
 1,2,3,4,0,5,0,0,0,0,0,0,0,0,0,0,
 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
@@ -174,10 +176,7 @@ const boost::uint8_t slice_index[] =
 
 };
 
-BOOST_STATIC_ASSERT(sizeof(slice_index) == 512);
-
-}  // namesapce detail
+BOOST_STATIC_ASSERT(sizeof(codepage_1252::slice_index) == 512);
 
 }  // namespace interop
-
 }  // namespace boost
@@ -0,0 +1,182 @@
+//  libs/interop/src/codepage_1254.cpp  ------------------------------------------------//
+
+//  Copyright Beman Dawes 2011
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+// define BOOST_INTEROP_SOURCE so that <boost/interop/config.hpp> knows
+// the library is being built (possibly exporting rather than importing code)
+#define BOOST_INTEROP_SOURCE 
+
+#include <boost/interop/codepage_tables.hpp>
+#include <boost/static_assert.hpp>
+
+namespace boost
+{
+namespace interop
+{
+
+/****************** tables generated by tools/table_generator.cpp ***********************/
+
+/****************************** DO NOT EDIT BY HAND *************************************/
+
+const boost::char16  codepage_1254::to_utf16[256] =
+{
+0x0,0x1,0x2,0x3,0x4,0x5,0x6,0x7,0x8,0x9,0xa,0xb,0xc,0xd,0xe,0xf,
+0x10,0x11,0x12,0x13,0x14,0x15,0x16,0x17,0x18,0x19,0x1a,0x1b,0x1c,0x1d,0x1e,0x1f,
+0x20,0x21,0x22,0x23,0x24,0x25,0x26,0x27,0x28,0x29,0x2a,0x2b,0x2c,0x2d,0x2e,0x2f,
+0x30,0x31,0x32,0x33,0x34,0x35,0x36,0x37,0x38,0x39,0x3a,0x3b,0x3c,0x3d,0x3e,0x3f,
+0x40,0x41,0x42,0x43,0x44,0x45,0x46,0x47,0x48,0x49,0x4a,0x4b,0x4c,0x4d,0x4e,0x4f,
+0x50,0x51,0x52,0x53,0x54,0x55,0x56,0x57,0x58,0x59,0x5a,0x5b,0x5c,0x5d,0x5e,0x5f,
+0x60,0x61,0x62,0x63,0x64,0x65,0x66,0x67,0x68,0x69,0x6a,0x6b,0x6c,0x6d,0x6e,0x6f,
+0x70,0x71,0x72,0x73,0x74,0x75,0x76,0x77,0x78,0x79,0x7a,0x7b,0x7c,0x7d,0x7e,0x7f,
+0x20ac,0xfffd,0x201a,0x192,0x201e,0x2026,0x2020,0x2021,0x2c6,0x2030,0x160,0x2039,0x152,0xfffd,0xfffd,0xfffd,
+0xfffd,0x2018,0x2019,0x201c,0x201d,0x2022,0x2013,0x2014,0x2dc,0x2122,0x161,0x203a,0x153,0xfffd,0xfffd,0x178,
+0xa0,0xa1,0xa2,0xa3,0xa4,0xa5,0xa6,0xa7,0xa8,0xa9,0xaa,0xab,0xac,0xad,0xae,0xaf,
+0xb0,0xb1,0xb2,0xb3,0xb4,0xb5,0xb6,0xb7,0xb8,0xb9,0xba,0xbb,0xbc,0xbd,0xbe,0xbf,
+0xc0,0xc1,0xc2,0xc3,0xc4,0xc5,0xc6,0xc7,0xc8,0xc9,0xca,0xcb,0xcc,0xcd,0xce,0xcf,
+0x11e,0xd1,0xd2,0xd3,0xd4,0xd5,0xd6,0xd7,0xd8,0xd9,0xda,0xdb,0xdc,0x130,0x15e,0xdf,
+0xe0,0xe1,0xe2,0xe3,0xe4,0xe5,0xe6,0xe7,0xe8,0xe9,0xea,0xeb,0xec,0xed,0xee,0xef,
+0x11f,0xf1,0xf2,0xf3,0xf4,0xf5,0xf6,0xf7,0xf8,0xf9,0xfa,0xfb,0xfc,0x131,0x15f,0xff
+};
+
+BOOST_STATIC_ASSERT(sizeof(codepage_1254::to_utf16) == 2*256);
+
+const unsigned char codepage_1254::to_char[1152] =
+{
+//  slice 0 - characters with no codepage representation
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+
+//  slice 1 - 0x0
+0x00,0x1,0x2,0x3,0x4,0x5,0x6,0x7,0x8,0x9,0xa,0xb,0xc,0xd,0xe,0xf,
+0x10,0x11,0x12,0x13,0x14,0x15,0x16,0x17,0x18,0x19,0x1a,0x1b,0x1c,0x1d,0x1e,0x1f,
+0x20,0x21,0x22,0x23,0x24,0x25,0x26,0x27,0x28,0x29,0x2a,0x2b,0x2c,0x2d,0x2e,0x2f,
+0x30,0x31,0x32,0x33,0x34,0x35,0x36,0x37,0x38,0x39,0x3a,0x3b,0x3c,0x3d,0x3e,0x3f,
+0x40,0x41,0x42,0x43,0x44,0x45,0x46,0x47,0x48,0x49,0x4a,0x4b,0x4c,0x4d,0x4e,0x4f,
+0x50,0x51,0x52,0x53,0x54,0x55,0x56,0x57,0x58,0x59,0x5a,0x5b,0x5c,0x5d,0x5e,0x5f,
+0x60,0x61,0x62,0x63,0x64,0x65,0x66,0x67,0x68,0x69,0x6a,0x6b,0x6c,0x6d,0x6e,0x6f,
+0x70,0x71,0x72,0x73,0x74,0x75,0x76,0x77,0x78,0x79,0x7a,0x7b,0x7c,0x7d,0x7e,0x7f,
+
+//  slice 2 - 0x80
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+0xa0,0xa1,0xa2,0xa3,0xa4,0xa5,0xa6,0xa7,0xa8,0xa9,0xaa,0xab,0xac,0xad,0xae,0xaf,
+0xb0,0xb1,0xb2,0xb3,0xb4,0xb5,0xb6,0xb7,0xb8,0xb9,0xba,0xbb,0xbc,0xbd,0xbe,0xbf,
+0xc0,0xc1,0xc2,0xc3,0xc4,0xc5,0xc6,0xc7,0xc8,0xc9,0xca,0xcb,0xcc,0xcd,0xce,0xcf,
+'?',0xd1,0xd2,0xd3,0xd4,0xd5,0xd6,0xd7,0xd8,0xd9,0xda,0xdb,0xdc,'?','?',0xdf,
+0xe0,0xe1,0xe2,0xe3,0xe4,0xe5,0xe6,0xe7,0xe8,0xe9,0xea,0xeb,0xec,0xed,0xee,0xef,
+'?',0xf1,0xf2,0xf3,0xf4,0xf5,0xf6,0xf7,0xf8,0xf9,0xfa,0xfb,0xfc,'?','?',0xff,
+
+//  slice 3 - 0x100
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?',0xd0,0xf0,
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+0xdd,0xfd,'?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+'?','?',0x8c,0x9c,'?','?','?','?','?','?','?','?','?','?',0xde,0xfe,
+0x8a,0x9a,'?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+'?','?','?','?','?','?','?','?',0x9f,'?','?','?','?','?','?','?',
+
+//  slice 4 - 0x180
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+'?','?',0x83,'?','?','?','?','?','?','?','?','?','?','?','?','?',
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+
+//  slice 5 - 0x280
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+'?','?','?','?','?','?',0x88,'?','?','?','?','?','?','?','?','?',
+'?','?','?','?','?','?','?','?','?','?','?','?',0x98,'?','?','?',
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+
+//  slice 6 - 0x2000
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+'?','?','?',0x96,0x97,'?','?','?',0x91,0x92,0x82,'?',0x93,0x94,0x84,'?',
+0x86,0x87,0x95,'?','?','?',0x85,'?','?','?','?','?','?','?','?','?',
+0x89,'?','?','?','?','?','?','?','?',0x8b,0x9b,'?','?','?','?','?',
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+
+//  slice 7 - 0x2080
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+'?','?','?','?','?','?','?','?','?','?','?','?',0x80,'?','?','?',
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+
+//  slice 8 - 0x2100
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+'?','?',0x99,'?','?','?','?','?','?','?','?','?','?','?','?','?',
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+'?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
+
+};
+
+BOOST_STATIC_ASSERT(sizeof(codepage_1254::to_char) == 1152);
+
+const boost::uint8_t codepage_1254::slice_index[512] =
+{
+1,2,3,4,0,5,0,0,0,0,0,0,0,0,0,0,
+0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+6,7,8,0,0,0,0,0,0,0,0,0,0,0,0,0,
+0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0
+
+};
+
+BOOST_STATIC_ASSERT(sizeof(codepage_1254::slice_index) == 512);
+
+}  // namespace interop
+}  // namespace boost
@@ -9,22 +9,19 @@
 // the library is being built (possibly exporting rather than importing code)
 #define BOOST_INTEROP_SOURCE 
 
-#include <boost/interop/detail/config.hpp>
-#include <boost/interop/cxx11_char_types.hpp>
+#include <boost/interop/codepage_tables.hpp>
 #include <boost/static_assert.hpp>
 
 namespace boost
 {
 namespace interop
 {
-namespace detail
-{
 
 /****************** tables generated by tools/table_generator.cpp ***********************/
 
 /****************************** DO NOT EDIT BY HAND *************************************/
 
-BOOST_INTEROP_DECL extern const boost::char16  to_utf16[] =
+const boost::char16  codepage_437::to_utf16[256] =
 {
 0x0,0x1,0x2,0x3,0x4,0x5,0x6,0x7,0x8,0x9,0xa,0xb,0xc,0xd,0xe,0xf,
 0x10,0x11,0x12,0x13,0x14,0x15,0x16,0x17,0x18,0x19,0x1a,0x1b,0x1c,0x1d,0x1e,0x1f,
@@ -44,9 +41,9 @@ BOOST_INTEROP_DECL extern const boost::char16  to_utf16[] =
 0x2261,0xb1,0x2265,0x2264,0x2320,0x2321,0xf7,0x2248,0xb0,0x2219,0xb7,0x221a,0x207f,0xb2,0x25a0,0xa0
 };
 
-BOOST_STATIC_ASSERT(sizeof(to_utf16) == 2*256);
+BOOST_STATIC_ASSERT(sizeof(codepage_437::to_utf16) == 2*256);
 
-BOOST_INTEROP_DECL extern const unsigned char to_char[] =
+const unsigned char codepage_437::to_char[1408] =
 {
 //  slice 0 - characters with no codepage representation
 '?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
@@ -59,7 +56,7 @@ BOOST_INTEROP_DECL extern const unsigned char to_char[] =
 '?','?','?','?','?','?','?','?','?','?','?','?','?','?','?','?',
 
 //  slice 1 - 0x0
-0x0,0x1,0x2,0x3,0x4,0x5,0x6,0x7,0x8,0x9,0xa,0xb,0xc,0xd,0xe,0xf,
+0x00,0x1,0x2,0x3,0x4,0x5,0x6,0x7,0x8,0x9,0xa,0xb,0xc,0xd,0xe,0xf,
 0x10,0x11,0x12,0x13,0x14,0x15,0x16,0x17,0x18,0x19,0x1a,0x1b,0x1c,0x1d,0x1e,0x1f,
 0x20,0x21,0x22,0x23,0x24,0x25,0x26,0x27,0x28,0x29,0x2a,0x2b,0x2c,0x2d,0x2e,0x2f,
 0x30,0x31,0x32,0x33,0x34,0x35,0x36,0x37,0x38,0x39,0x3a,0x3b,0x3c,0x3d,0x3e,0x3f,
@@ -160,9 +157,9 @@ BOOST_INTEROP_DECL extern const unsigned char to_char[] =
 
 };
 
-BOOST_STATIC_ASSERT(sizeof(to_char) == 1408);
+BOOST_STATIC_ASSERT(sizeof(codepage_437::to_char) == 1408);
 
-BOOST_INTEROP_DECL extern const boost::uint8_t slice_index[] =
+const boost::uint8_t codepage_437::slice_index[512] =
 {
 1,2,0,3,0,0,0,4,0,0,0,0,0,0,0,0,
 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
@@ -199,10 +196,7 @@ BOOST_INTEROP_DECL extern const boost::uint8_t slice_index[] =
 
 };
 
-BOOST_STATIC_ASSERT(sizeof(slice_index) == 512);
-
-}  // namesapce detail
+BOOST_STATIC_ASSERT(sizeof(codepage_437::slice_index) == 512);
 
 }  // namespace interop
-
 }  // namespace boost
@@ -0,0 +1,110 @@
+//  libs/interop/src/codepage_registry.cpp  --------------------------------------------//
+
+//  Copyright Beman Dawes 2012
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+// define BOOST_INTEROP_SOURCE so that <boost/interop/config.hpp> knows
+// the library is being built (possibly exporting rather than importing code)
+#define BOOST_INTEROP_SOURCE 
+
+#include <boost/interop/codepage.hpp>
+#include <cctype>
+
+namespace boost
+{
+namespace interop
+{
+
+namespace
+{
+
+#define BOOST_INTEROP_CODEPAGE(TABLE, NAME, ALIAS, NUMBER) \
+  { NAME, ALIAS, NUMBER, TABLE::to_utf16, TABLE::to_char, TABLE::slice_index }
+
+  const codepage registry[] =
+  {
+    BOOST_INTEROP_CODEPAGE(codepage_437,  "IBM437",       "cp437",    437),
+    BOOST_INTEROP_CODEPAGE(codepage_850,  "IBM850",       "cp850",    850),
+    BOOST_INTEROP_CODEPAGE(codepage_866,  "IBM866",       "cp866",    866),
+    BOOST_INTEROP_CODEPAGE(codepage_1250, "windows-1250", "cp1250",   1250),
+    BOOST_INTEROP_CODEPAGE(codepage_1251, "windows-1251", "cp1251",   1251),
+    BOOST_INTEROP_CODEPAGE(codepage_1252, "windows-1252", "cp1252",   1252),
+    BOOST_INTEROP_CODEPAGE(codepage_1253, "windows-1253", "cp1253",   1253),
+    BOOST_INTEROP_CODEPAGE(codepage_1254, "windows-1254", "cp1254",   1254),
+    BOOST_INTEROP_CODEPAGE(codepage_1255, "windows-1255", "cp1255",   1255),
+    BOOST_INTEROP_CODEPAGE(codepage_1256, "windows-1256", "cp1256",   1256),
+    BOOST_INTEROP_CODEPAGE(codepage_1257, "windows-1257", "cp1257",   1257),
+    BOOST_INTEROP_CODEPAGE(codepage_1258, "windows-1258", "cp1258",   1258),
+    BOOST_INTEROP_CODEPAGE(iso_8859_1,    "ISO-8859-1",   "latin1",   28591),
+    BOOST_INTEROP_CODEPAGE(iso_8859_2,    "ISO-8859-2",   "latin2",   28592),
+    BOOST_INTEROP_CODEPAGE(iso_8859_3,    "ISO-8859-3",   "latin3",   28593),
+    BOOST_INTEROP_CODEPAGE(iso_8859_4,    "ISO-8859-4",   "latin4",   28594),
+    BOOST_INTEROP_CODEPAGE(iso_8859_5,    "ISO-8859-5",   "cyrillic", 28595),
+    BOOST_INTEROP_CODEPAGE(iso_8859_6,    "ISO-8859-6",   "arabic",   28596),
+    BOOST_INTEROP_CODEPAGE(iso_8859_7,    "ISO-8859-7",   "greek",    28597),
+    BOOST_INTEROP_CODEPAGE(iso_8859_8,    "ISO-8859-8",   "hebrew",   28598),
+    BOOST_INTEROP_CODEPAGE(iso_8859_9,    "ISO-8859-9",   "latin5",   28599),
+    BOOST_INTEROP_CODEPAGE(iso_8859_10,   "ISO-8859-10",  "latin6",   0),
+    BOOST_INTEROP_CODEPAGE(iso_8859_11,   "ISO-8859-11",  "TIS-620",  0),
+    BOOST_INTEROP_CODEPAGE(iso_8859_13,   "ISO-8859-13",  "latin7",   28603),
+    BOOST_INTEROP_CODEPAGE(iso_8859_14,   "ISO-8859-14",  "latin8",   0),
+    BOOST_INTEROP_CODEPAGE(iso_8859_15,   "ISO-8859-15",  "latin9",   28605),
+    BOOST_INTEROP_CODEPAGE(iso_8859_16,   "ISO-8859-16",  "latin10",  0),
+    BOOST_INTEROP_CODEPAGE(koi8_r,        "KOI8-R",       "cskoi8r",  20866),
+    BOOST_INTEROP_CODEPAGE(koi8_u,        "KOI8-U",       "cskoi8u",  21866)
+  };
+
+#undef BOOST_INTEROP_CODEPAGE
+
+  const std::size_t registry_size = sizeof(registry) / sizeof(registry[0]);
+
+  //  compare names ignoring case and anything other than letters and digits
+  bool same_name(const char* p, const char* q)
+  {
+    for (;;)
+    {
+      while (*p && !std::isalnum(static_cast<unsigned char>(*p)))
+        ++p;
+      while (*q && !std::isalnum(static_cast<unsigned char>(*q)))
+        ++q;
+      if (!*p || !*q)
+        return !*p && !*q;
+      if (std::tolower(static_cast<unsigned char>(*p))
+        != std::tolower(static_cast<unsigned char>(*q)))
+        return false;
+      ++p;
+      ++q;
+    }
+  }
+
+}  // unnamed namespace
+
+BOOST_INTEROP_DECL const codepage* find_codepage(const char* name)
+{
+  for (std::size_t i = 0; i < registry_size; ++i)
+  {
+    if (same_name(name, registry[i].name) || same_name(name, registry[i].alias))
+      return &registry[i];
+  }
+  return 0;
+}
+
+BOOST_INTEROP_DECL const codepage* find_codepage(unsigned number)
+{
+  if (number == 0)
+    return 0;
+  for (std::size_t i = 0; i < registry_size; ++i)
+  {
+    if (registry[i].number == number)
+      return &registry[i];
+  }
+  return 0;
+}
+
+BOOST_INTEROP_DECL const codepage* codepages_begin() { return registry; }
+BOOST_INTEROP_DECL const codepage* codepages_end() { return registry + registry_size; }
+
+}  // namespace interop
+}  // namespace boost
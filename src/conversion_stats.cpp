@@ -0,0 +1,218 @@
+//  libs/interop/src/conversion_stats.cpp  ---------------------------------------------//
+
+//  Copyright Beman Dawes 2012
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+// define BOOST_INTEROP_SOURCE so that <boost/interop/config.hpp> knows
+// the library is being built (possibly exporting rather than importing code)
+#define BOOST_INTEROP_SOURCE
+
+#include <boost/interop/conversion_stats.hpp>
+#include <boost/interop/codepage.hpp>
+#include <cstring>
+#include <new>
+#ifndef BOOST_INTEROP_NO_THREADS
+# include <mutex>
+#endif
+
+namespace boost
+{
+namespace interop
+{
+
+namespace
+{
+  class thread_stats;
+
+  //  Everything is guarded by the mutex, except the counters themselves, which each
+  //  thread updates without locking. retired has an entry for each registered pair,
+  //  holding its names and the counts of threads that have exited.
+  struct stats_registry
+  {
+#ifndef BOOST_INTEROP_NO_THREADS
+    std::mutex                     mutex;
+#endif
+    std::vector<conversion_stats>  retired;
+    std::vector<thread_stats*>     threads;
+  };
+
+  stats_registry& registry()
+  {
+    static stats_registry* instance = new stats_registry;  // outlives thread_stats
+    return *instance;
+  }
+
+#ifndef BOOST_INTEROP_NO_THREADS
+# define BOOST_INTEROP_REGISTRY_LOCK \
+    std::lock_guard<std::mutex> lock(registry().mutex)
+#else
+# define BOOST_INTEROP_REGISTRY_LOCK
+#endif
+
+  void add_counts(conversion_stats& to, const detail::stats_counters& from)
+  {
+    to.calls += detail::stats_load(from.calls);
+    to.input_units += detail::stats_load(from.input_units);
+    to.output_units += detail::stats_load(from.output_units);
+    to.errors += detail::stats_load(from.errors);
+    to.fast_path += detail::stats_load(from.fast_path);
+    to.fallback_path += detail::stats_load(from.fallback_path);
+  }
+
+  void add_counts(conversion_stats& to, const conversion_stats& from)
+  {
+    to.calls += from.calls;
+    to.input_units += from.input_units;
+    to.output_units += from.output_units;
+    to.errors += from.errors;
+    to.fast_path += from.fast_path;
+    to.fallback_path += from.fallback_path;
+  }
+
+  conversion_stats zero_stats(const char* to_codec, const char* from_codec)
+  {
+    conversion_stats stats = {to_codec, from_codec, 0, 0, 0, 0, 0, 0};
+    return stats;
+  }
+
+  //  one thread's counters, indexed by pair, each on cache lines of its own
+  class thread_stats
+  {
+  public:
+    thread_stats()
+    {
+      BOOST_INTEROP_REGISTRY_LOCK;
+      registry().threads.push_back(this);
+    }
+
+    ~thread_stats()
+    {
+      BOOST_INTEROP_REGISTRY_LOCK;
+      stats_registry& reg = registry();
+      for (std::size_t i = 0; i < m_counters.size(); ++i)
+      {
+        if (m_counters[i])
+        {
+          add_counts(reg.retired[i], *m_counters[i]);
+          release(m_counters[i], m_blocks[i]);
+        }
+      }
+      for (std::size_t i = 0; i < reg.threads.size(); ++i)
+      {
+        if (reg.threads[i] == this)
+        {
+          reg.threads.erase(reg.threads.begin() + i);
+          break;
+        }
+      }
+    }
+
+    detail::stats_counters& counters(std::size_t pair)
+    {
+      if (pair < m_counters.size() && m_counters[pair])
+        return *m_counters[pair];
+      return add(pair);
+    }
+
+    //  Requires: the registry is locked
+    void add_to(std::vector<conversion_stats>& stats) const
+    {
+      for (std::size_t i = 0; i < m_counters.size(); ++i)
+        if (m_counters[i])
+          add_counts(stats[i], *m_counters[i]);
+    }
+
+  private:
+    std::vector<detail::stats_counters*> m_counters;
+    std::vector<void*>                   m_blocks;  // the allocations holding them
+
+    detail::stats_counters& add(std::size_t pair)
+    {
+      //  allocate a line more than needed, so that the counters can start on a line
+      //  boundary and no other allocation shares their lines
+      void* block = ::operator new(sizeof(detail::stats_counters)
+        + detail::stats_line_size);
+      std::size_t offset = detail::stats_line_size
+        - reinterpret_cast<std::size_t>(block) % detail::stats_line_size;
+      detail::stats_counters* counters = new (static_cast<char*>(block) + offset)
+        detail::stats_counters();
+
+      BOOST_INTEROP_REGISTRY_LOCK;
+      if (pair >= m_counters.size())
+      {
+        m_counters.resize(pair + 1, 0);
+        m_blocks.resize(pair + 1, 0);
+      }
+      m_counters[pair] = counters;
+      m_blocks[pair] = block;
+      return *counters;
+    }
+
+    static void release(detail::stats_counters* counters, void* block)
+    {
+      counters->~stats_counters();
+      ::operator delete(block);
+    }
+  };
+
+#ifndef BOOST_INTEROP_NO_THREADS
+  thread_local thread_stats this_thread_stats;
+#else
+  thread_stats this_thread_stats;
+#endif
+
+}  // unnamed namespace
+
+BOOST_INTEROP_DECL stats_snapshot conversion_stats_snapshot()
+{
+  stats_snapshot snapshot;
+  {
+    BOOST_INTEROP_REGISTRY_LOCK;
+    stats_registry& reg = registry();
+    snapshot.pairs = reg.retired;
+    for (std::size_t i = 0; i < reg.threads.size(); ++i)
+      reg.threads[i]->add_to(snapshot.pairs);
+  }
+  snapshot.totals = zero_stats("", "");
+  for (std::size_t i = 0; i < snapshot.pairs.size(); ++i)
+    add_counts(snapshot.totals, snapshot.pairs[i]);
+  return snapshot;
+}
+
+namespace detail
+{
+
+BOOST_INTEROP_DECL std::size_t register_codec_pair(const char* to_codec,
+  const char* from_codec)
+{
+  BOOST_INTEROP_REGISTRY_LOCK;
+  stats_registry& reg = registry();
+  for (std::size_t i = 0; i < reg.retired.size(); ++i)
+  {
+    if (std::strcmp(reg.retired[i].to_codec, to_codec) == 0
+      && std::strcmp(reg.retired[i].from_codec, from_codec) == 0)
+      return i;
+  }
+  reg.retired.push_back(zero_stats(to_codec, from_codec));
+  return reg.retired.size() - 1;
+}
+
+BOOST_INTEROP_DECL stats_counters& thread_counters(std::size_t pair)
+{
+  return this_thread_stats.counters(pair);
+}
+
+BOOST_INTEROP_DECL const char* codepage_name(const boost::char16* to_utf16)
+{
+  for (const codepage* cp = codepages_begin(); cp != codepages_end(); ++cp)
+    if (cp->to_utf16 == to_utf16)
+      return cp->name;
+  return "codepage";
+}
+
+} // namespace detail
+
+}  // namespace interop
+}  // namespace boost
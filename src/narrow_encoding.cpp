@@ -0,0 +1,58 @@
+//  libs/interop/src/narrow_encoding.cpp  ----------------------------------------------//
+
+//  Copyright Beman Dawes 2012
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+// define BOOST_INTEROP_SOURCE so that <boost/interop/config.hpp> knows
+// the library is being built (possibly exporting rather than importing code)
+#define BOOST_INTEROP_SOURCE 
+
+#include <boost/interop/codepage.hpp>
+
+#ifndef BOOST_WINDOWS_API
+
+#include <langinfo.h>
+#include <locale.h>
+#include <unistd.h>
+#if defined(__APPLE__)
+# include <xlocale.h>
+#endif
+
+namespace boost
+{
+namespace interop
+{
+namespace detail
+{
+
+BOOST_INTEROP_DECL const codepage* codeset_codepage(const char* codeset)
+{
+  //  the registry has no entry for UTF-8, for ASCII (which UTF-8 handles as well), or
+  //  for any multibyte codeset, so all of those select UTF-8
+  if (!codeset || !*codeset)
+    return 0;
+  return find_codepage(codeset);
+}
+
+BOOST_INTEROP_DECL const codepage* detect_narrow_codepage()
+{
+  //  the environment's locale, whether or not the program has called setlocale()
+#if (defined(_POSIX_VERSION) && _POSIX_VERSION >= 200809L) || defined(__APPLE__)
+  locale_t loc = newlocale(LC_CTYPE_MASK, "", static_cast<locale_t>(0));
+  if (loc)
+  {
+    const codepage* table = codeset_codepage(nl_langinfo_l(CODESET, loc));
+    freelocale(loc);
+    return table;
+  }
+#endif
+  return codeset_codepage(nl_langinfo(CODESET));
+}
+
+}  // namespace detail
+}  // namespace interop
+}  // namespace boost
+
+#endif  // BOOST_WINDOWS_API
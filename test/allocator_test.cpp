@@ -0,0 +1,195 @@
+//  interop/allocator_test.cpp  --------------------------------------------------------//
+
+//  Copyright Beman Dawes 2012
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+#include <boost/config/warning_disable.hpp>  // must precede other headers
+
+#include <iostream>
+#include <boost/interop/string_interop.hpp>
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <string>
+#include <boost/type_traits/is_same.hpp>
+#include <boost/detail/lightweight_test.hpp>
+#include <boost/detail/lightweight_main.hpp>
+
+#if defined(__has_include)
+# if __has_include(<memory_resource>) && __cplusplus >= 201703L
+#   include <memory_resource>
+#   define BOOST_INTEROP_TEST_PMR
+# endif
+#endif
+
+using std::string;
+using boost::u16string;
+using boost::u32string;
+using boost::char16;
+using boost::char32;
+using namespace boost::interop;
+
+namespace
+{
+  std::size_t allocations = 0;
+
+  //  counts the allocations made through any copy or rebinding of it
+  template <class T>
+  class counting_allocator
+  {
+  public:
+    typedef T                 value_type;
+    typedef T*                pointer;
+    typedef const T*          const_pointer;
+    typedef T&                reference;
+    typedef const T&          const_reference;
+    typedef std::size_t       size_type;
+    typedef std::ptrdiff_t    difference_type;
+    template <class U> struct rebind { typedef counting_allocator<U> other; };
+
+    explicit counting_allocator(int id) : m_id(id) {}
+    template <class U>
+    counting_allocator(const counting_allocator<U>& other) : m_id(other.id()) {}
+
+    pointer allocate(size_type n, const void* = 0)
+    {
+      ++allocations;
+      return static_cast<pointer>(::operator new(n * sizeof(T)));
+    }
+    void deallocate(pointer p, size_type) { ::operator delete(p); }
+    size_type max_size() const { return static_cast<size_type>(-1) / sizeof(T); }
+    void construct(pointer p, const T& v) { new (static_cast<void*>(p)) T(v); }
+    void destroy(pointer p) { p->~T(); }
+    pointer address(reference r) const { return &r; }
+    const_pointer address(const_reference r) const { return &r; }
+
+    int id() const { return m_id; }
+
+  private:
+    int m_id;
+  };
+
+  template <class T, class U>
+  bool operator==(const counting_allocator<T>& x, const counting_allocator<U>& y)
+    { return x.id() == y.id(); }
+  template <class T, class U>
+  bool operator!=(const counting_allocator<T>& x, const counting_allocator<U>& y)
+    { return x.id() != y.id(); }
+
+  typedef std::basic_string<char, std::char_traits<char>, counting_allocator<char> >
+    counted_string;
+  typedef std::basic_string<char16, std::char_traits<char16>,
+    counting_allocator<char16> > counted_u16string;
+  typedef std::basic_string<char32, std::char_traits<char32>,
+    counting_allocator<char32> > counted_u32string;
+  typedef std::basic_string<wchar_t, std::char_traits<wchar_t>,
+    counting_allocator<wchar_t> > counted_wstring;
+
+  //  long enough that no implementation keeps it in a small string buffer
+  const char utf8_text[] = "Lorem ipsum dolor sit amet \xE2\x82\xAC \xF0\x9F\x98\x8A "
+    "consectetur adipiscing elit \xC3\xA9";
+
+  template <class String>
+  bool has_allocator(const String& s, int id)
+  {
+    return s.get_allocator().id() == id;
+  }
+
+  void make_string_test()
+  {
+    std::cout << "make_string test..." << std::endl;
+
+    const counting_allocator<char> a(42);
+    const string s(utf8_text);
+    const u16string expect16 = make_string<utf16, utf8, u16string>(s);
+    const std::list<char> lst(s.begin(), s.end());
+
+    std::size_t before = allocations;
+    counted_u16string r1 = make_string<utf16, utf8>(s, a);
+    BOOST_TEST(allocations > before);
+    BOOST_TEST(has_allocator(r1, 42));
+    BOOST_TEST(u16string(r1.begin(), r1.end()) == expect16);
+
+    counted_u16string r2 = make_string<utf16, utf8>(utf8_text, a);
+    BOOST_TEST(has_allocator(r2, 42));
+    BOOST_TEST(r2 == r1);
+
+    counted_u16string r3 = make_string<utf16, utf8>(s.data(), s.size(), a);
+    BOOST_TEST(r3 == r1);
+
+    counted_u16string r4 = make_string<utf16, utf8>(lst.begin(), lst.end(), a);
+    BOOST_TEST(has_allocator(r4, 42));
+    BOOST_TEST(r4 == r1);
+
+    counted_u32string r5 = make_string<utf32, utf8>(s, skip_on_error(), a);
+    BOOST_TEST(has_allocator(r5, 42));
+    BOOST_TEST((r5.size() == make_string<utf32, utf8, u32string>(s).size()));
+
+    std::size_t offset = 0;
+    const string bad("ab\x80");
+    counted_string r6 = make_string<utf8, utf8>(bad.begin(), bad.end(),
+      stop_on_error(offset), a);
+    BOOST_TEST(r6 == "ab");
+    BOOST_TEST_EQ(offset, 2U);
+
+    counted_string r7 = make_string<utf8, utf16>(r1, a);
+    BOOST_TEST(r7 == utf8_text);
+  }
+
+  void alias_test()
+  {
+    std::cout << "alias test..." << std::endl;
+
+    const counting_allocator<int> a(7);
+    const string s(utf8_text);
+
+    counted_u16string r16 = to_utf16<utf8>(s, a);
+    BOOST_TEST(has_allocator(r16, 7));
+    counted_u32string r32 = to_utf32<utf8>(s.c_str(), a);
+    BOOST_TEST(has_allocator(r32, 7));
+    counted_string r8 = to_utf8<utf32>(r32.data(), r32.size(), a);
+    BOOST_TEST(r8 == utf8_text);
+    counted_wstring rw = to_wide<utf16>(r16.begin(), r16.end(), a);
+    BOOST_TEST(has_allocator(rw, 7));
+    counted_string rn = to_narrow<wide>(rw, a);
+    BOOST_TEST(has_allocator(rn, 7));
+    string expect = to_narrow<wide, string>(std::wstring(rw.begin(), rw.end()));
+    BOOST_TEST(rn == expect.c_str());
+  }
+
+#ifdef BOOST_INTEROP_TEST_PMR
+  //  every allocation must come from the arena; its upstream refuses to allocate
+  void pmr_test()
+  {
+    std::cout << "pmr test..." << std::endl;
+
+    char buffer[4096];
+    std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer),
+      std::pmr::null_memory_resource());
+    std::pmr::polymorphic_allocator<char> a(&arena);
+    const string s(utf8_text);
+
+    std::pmr::u16string r16 = make_string<utf16, utf8>(s, a);
+    BOOST_TEST(r16.get_allocator().resource() == &arena);
+    std::pmr::u32string r32 = to_utf32<utf16>(r16, a);
+    std::pmr::string r8 = make_string<utf8, utf32>(r32, replace_on_error(), a);
+    BOOST_TEST(r8 == utf8_text);
+    std::pmr::wstring rw = to_wide<utf8>(s.c_str(), a);
+    BOOST_TEST(rw.get_allocator().resource() == &arena);
+  }
+#endif
+
+}  // unnamed namespace
+
+int cpp_main(int, char*[])
+{
+  make_string_test();
+  alias_test();
+#ifdef BOOST_INTEROP_TEST_PMR
+  pmr_test();
+#endif
+
+  return ::boost::report_errors();
+}
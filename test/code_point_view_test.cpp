@@ -0,0 +1,144 @@
+//  interop/code_point_view_test.cpp  --------------------------------------------------//
+
+//  Copyright Beman Dawes 2012
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+#include <boost/config/warning_disable.hpp>  // must precede other headers
+
+#include <iostream>
+#include <boost/interop/code_point_view.hpp>
+#include <boost/interop/string_operators.hpp>
+#include <stdexcept>
+#include <string>
+#include "random_sequence.hpp"
+#include <boost/detail/lightweight_test.hpp>
+#include <boost/detail/lightweight_main.hpp>
+
+using std::string;
+using boost::u16string;
+using boost::u32string;
+using boost::char16;
+using boost::char32;
+using namespace boost::interop;
+
+namespace
+{
+  interop_test::random_sequence next_random(2468);
+
+  //  long ASCII runs, so that checkpoints fall in both vector blocks and scalar tails,
+  //  mixed with sequences of every length
+  u32string make_text(std::size_t n)
+  {
+    u32string s;
+    while (s.size() < n)
+    {
+      switch (next_random() % 5)
+      {
+      case 0:  s += char32(0x80 + next_random() % 0x780); break;
+      case 1:  s += char32(0x4E00 + next_random() % 0x5000); break;
+      case 2:  s += char32(0x10000 + next_random() % 0xFFFFF); break;
+      default:
+        for (unsigned i = next_random() % 100; i && s.size() < n; --i)
+          s += char32('a' + i % 26);
+      }
+    }
+    return s;
+  }
+
+  //  every access through the view agrees with the UTF-32 conversion
+  template <class Codec, class String>
+  void check(const String& units, const u32string& text)
+  {
+    code_point_view<Codec> v(units);
+    BOOST_TEST_EQ(v.empty(), text.empty());
+    BOOST_TEST_EQ(v.size(), text.size());
+    bool all = true;
+    for (std::size_t i = 0; i < text.size(); ++i)
+      all = all && v[i] == text[i];
+    BOOST_TEST(all);
+    BOOST_TEST(v.position(text.size()) == v.units_end());
+
+    //  substrings, converted back to UTF-32
+    const std::size_t bounds[][2] = {{0, 0}, {0, 1}, {63, 2}, {64, 64}, {65, 1000},
+      {text.size() / 2, 3}, {text.size() - 1, 1}, {text.size(), 5}, {100, v.npos}};
+    for (std::size_t i = 0; i < sizeof(bounds) / sizeof(bounds[0]); ++i)
+    {
+      std::size_t pos = bounds[i][0];
+      std::size_t n = bounds[i][1];
+      if (pos > text.size())
+        continue;
+      String sub = v.substr(pos, n);
+      BOOST_TEST((make_string<utf32, Codec, u32string>(sub) == text.substr(pos, n)));
+      BOOST_TEST_EQ(v.subview(pos, n).size(), text.substr(pos, n).size());
+    }
+
+    bool caught = false;
+    try { v.at(text.size()); }
+    catch (const std::out_of_range&) { caught = true; }
+    BOOST_TEST(caught);
+    caught = false;
+    try { v.subview(text.size() + 1); }
+    catch (const std::out_of_range&) { caught = true; }
+    BOOST_TEST(caught);
+
+    //  sequential access
+    u32string s;
+    for (typename code_point_view<Codec>::const_iterator it = v.begin();
+      it != v.end(); ++it)
+      s += *it;
+    BOOST_TEST(s == text);
+    s.assign(v.rbegin(), v.rend());
+    BOOST_TEST(s == u32string(text.rbegin(), text.rend()));
+  }
+
+  void index_test()
+  {
+    std::cout << "index test..." << std::endl;
+
+    const std::size_t sizes[] = {1, 63, 64, 65, 1000, 20000};
+    for (std::size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i)
+    {
+      u32string text = make_text(sizes[i]);
+      text.resize(sizes[i]);
+      check<utf8>(make_string<utf8, utf32, string>(text), text);
+      check<utf16>(make_string<utf16, utf32, u16string>(text), text);
+      check<utf32>(text, text);
+    }
+
+    //  single byte codepages have no scan
+    typedef narrow_codec<koi8_r> koi8;
+    const string cyrillic("\xF6\xD5\xCB abc");
+    u32string text = make_string<utf32, koi8, u32string>(cyrillic);
+    check<koi8>(cyrillic, text);
+  }
+
+  void empty_test()
+  {
+    std::cout << "empty test..." << std::endl;
+
+    code_point_view<utf8> v;
+    BOOST_TEST(v.empty());
+    BOOST_TEST_EQ(v.size(), 0u);
+    BOOST_TEST(v.begin() == v.end());
+    BOOST_TEST(v.substr(0).empty());
+
+    //  the view refers to the caller's units
+    const char s[] = "x\xE2\x82\xAC" "y";
+    code_point_view<utf8> w(s, sizeof(s) - 1);
+    BOOST_TEST_EQ(w.size(), 3u);
+    BOOST_TEST(w[1] == 0x20ACu);
+    BOOST_TEST(w.position(2) == s + 4);
+    BOOST_TEST(w.units_begin() == s);
+  }
+
+}  // unnamed namespace
+
+int cpp_main(int, char*[])
+{
+  index_test();
+  empty_test();
+
+  return ::boost::report_errors();
+}
@@ -7,7 +7,12 @@
 
 #include <iostream>
 #include <boost/interop/string_interop.hpp>
+#include <algorithm>
 #include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <list>
+#include <stdexcept>
 #include <boost/detail/lightweight_test.hpp>
 #include <boost/detail/lightweight_main.hpp>
 
@@ -231,6 +236,163 @@ namespace
 # endif
   }
 
+  void fused_tests()
+  {
+    cout << "fused_tests..." << endl;
+
+    BOOST_TEST((boost::is_same<
+      detail::conversion_iterator_base<utf16, utf8, const char*>::type,
+      detail::fused_conversion_iterator<utf16, utf8, const char*> >::value));
+    typedef std::istream_iterator<char32> input_iterator;
+    BOOST_TEST((boost::is_same<
+      detail::conversion_iterator_base<utf16, utf32, input_iterator>::type,
+      utf16::to_iterator<utf32::from_iterator<input_iterator> > >::value));
+    BOOST_TEST((boost::is_same<
+      detail::conversion_iterator_base<utf16, utf32, const char32*>::type,
+      detail::fused_conversion_iterator<utf16, utf32, const char32*> >::value));
+
+    // "a", U+20AC, U+1F60A
+    const char* utf8s = "a\xE2\x82\xAC\xF0\x9F\x98\x8A";
+    const char16 utf16s[] = {'a', 0x20AC, 0xD83D, 0xDE0A, 0};
+    typedef conversion_iterator<utf16, utf8, const char*> iter_8_16;
+    typedef conversion_iterator<utf8, utf16, const char16*> iter_16_8;
+
+    // positions compare equal when reached by different routes, including the second
+    // unit of a surrogate pair
+    iter_8_16 a(utf8s), b(utf8s, std::strlen(utf8s));
+    BOOST_TEST(a == b);
+    ++a; ++a; ++a;
+    ++b; ++b;
+    BOOST_TEST(a != b);
+    ++b;
+    BOOST_TEST(a == b);
+    BOOST_TEST(*a == 0xDE0A);
+    ++a;
+    BOOST_TEST(a == iter_8_16());
+    BOOST_TEST(iter_8_16(utf8s, utf8s) == iter_8_16());
+
+    std::size_t i = 0;
+    for (iter_16_8 it(utf16s); it != iter_16_8(); ++it, ++i)
+      BOOST_TEST_EQ(*it, utf8s[i]);
+    BOOST_TEST_EQ(i, std::strlen(utf8s));
+
+    // invalid input is reported when the iterator reaches it
+    bool caught = false;
+    try
+    {
+      const char* bad = "a\xC0\xAF";
+      iter_8_16 it(bad);
+      ++it;
+    }
+    catch (const std::out_of_range&) { caught = true; }
+    BOOST_TEST(caught);
+
+    caught = false;
+    const char16 lone[] = {'a', 0xD83D, 0};
+    try
+    {
+      iter_16_8 it(lone);
+      ++it;
+    }
+    catch (const std::out_of_range&) { caught = true; }
+    BOOST_TEST(caught);
+  }
+
+  template <class Iterator>
+  std::basic_string<typename std::iterator_traits<Iterator>::value_type>
+    reversed(Iterator first, Iterator last)
+  {
+    std::basic_string<typename std::iterator_traits<Iterator>::value_type> r;
+    for (std::reverse_iterator<Iterator> it(last), end(first); it != end; ++it)
+      r += *it;
+    return r;
+  }
+
+  void bidirectional_tests()
+  {
+    cout << "bidirectional_tests..." << endl;
+
+    BOOST_TEST((boost::is_same<std::iterator_traits<
+      utf8::from_iterator<const char*> >::iterator_category,
+      std::bidirectional_iterator_tag>::value));
+    BOOST_TEST((boost::is_same<std::iterator_traits<
+      conversion_iterator<utf8, utf16, std::list<char16>::iterator> >::iterator_category,
+      std::bidirectional_iterator_tag>::value));
+    BOOST_TEST((boost::is_same<std::iterator_traits<
+      utf32::from_iterator<std::istream_iterator<char32> > >::iterator_category,
+      std::input_iterator_tag>::value));
+
+    // "a/", U+00E9, U+20AC, "/", U+1F60A, "z"
+    const std::string s8("a/\xC3\xA9\xE2\x82\xAC/\xF0\x9F\x98\x8Az");
+    const char32 cps[] = {'z', 0x1F60A, '/', 0x20AC, 0xE9, '/', 'a', 0};
+    const std::basic_string<char32> expected(cps);
+    std::basic_string<char16> s16
+      = make_string<utf16, utf8, std::basic_string<char16> >(s8);
+    std::basic_string<char32> s32(expected.rbegin(), expected.rend());
+
+    // from_iterators, over a random access and a list range
+    typedef utf8::from_iterator<std::string::const_iterator> from8;
+    BOOST_TEST(reversed(from8(s8.begin(), s8.end()),
+      from8(s8.begin(), s8.end(), s8.end())) == expected);
+    std::list<char16> list16(s16.begin(), s16.end());
+    typedef utf16::from_iterator<std::list<char16>::iterator> from16;
+    BOOST_TEST(reversed(from16(list16.begin(), list16.end()),
+      from16(list16.begin(), list16.end(), list16.end())) == expected);
+    typedef utf32::from_iterator<const char32*> from32;
+    const char32* p32 = s32.c_str();
+    BOOST_TEST(reversed(from32(p32, p32 + s32.size()),
+      from32(p32, p32 + s32.size(), p32 + s32.size())) == expected);
+
+    // conversion_iterators, including a pair that is only fused for bidirectionality
+    typedef conversion_iterator<utf16, utf8, std::string::const_iterator> iter_8_16;
+    std::basic_string<char16> r16 = reversed(iter_8_16(s8.begin(), s8.end()),
+      iter_8_16(s8.begin(), s8.end(), s8.end()));
+    BOOST_TEST(r16 == std::basic_string<char16>(s16.rbegin(), s16.rend()));
+    typedef conversion_iterator<utf8, utf32, const char32*> iter_32_8;
+    std::string r8 = reversed(iter_32_8(p32, p32 + s32.size()),
+      iter_32_8(p32, p32 + s32.size(), p32 + s32.size()));
+    BOOST_TEST(r8 == std::string(s8.rbegin(), s8.rend()));
+
+    // the last separator of a UTF-16 path, found as UTF-8 without a forward pass
+    typedef conversion_iterator<utf8, utf16, const char16*> iter_16_8;
+    const char16* p16 = s16.c_str();
+    iter_16_8 first(p16, p16 + s16.size());
+    iter_16_8 last(p16, p16 + s16.size(), p16 + s16.size());
+    std::reverse_iterator<iter_16_8> sep = std::find(
+      std::reverse_iterator<iter_16_8>(last), std::reverse_iterator<iter_16_8>(first),
+      '/');
+    BOOST_TEST(std::string(sep.base(), last) == "\xF0\x9F\x98\x8Az");
+
+    // back and forth, within and across multi-unit sequences
+    iter_8_16 it(s8.begin(), s8.end());
+    ++it; ++it; ++it; ++it; ++it;
+    BOOST_TEST(*it == 0xD83D);
+    ++it;
+    BOOST_TEST(*it == 0xDE0A);
+    --it; --it;
+    BOOST_TEST(*it == '/');
+    --it;
+    BOOST_TEST(*it == 0x20AC);
+    ++it; ++it;
+    BOOST_TEST(*it == 0xD83D);
+    BOOST_TEST(it == iter_8_16(s8.begin(), s8.end(), s8.begin() + 8));
+
+    // invalid input is reported going backward too
+    const std::string bad[] = {"a\x80", "a\xE2\x82", "\xC0\xAF"};
+    for (std::size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); ++i)
+    {
+      bool caught = false;
+      try
+      {
+        from8 e(bad[i].begin(), bad[i].end(), bad[i].end());
+        --e;
+        *e;
+      }
+      catch (const std::out_of_range&) { caught = true; }
+      BOOST_TEST(caught);
+    }
+  }
+
 }  // unnamed namespace
 
 //------------------------------------  cpp_main  --------------------------------------//
@@ -257,6 +419,8 @@ int cpp_main(int, char*[])
   generate_1(std::basic_string<char32>(u32src));
 
   value_tests();
+  fused_tests();
+  bidirectional_tests();
 
 
   return ::boost::report_errors();
@@ -0,0 +1,123 @@
+//  interop/codecvt_test.cpp  ----------------------------------------------------------//
+
+//  Copyright Beman Dawes 2012
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+#include <boost/config/warning_disable.hpp>  // must precede other headers
+
+#include <iostream>
+#include <boost/interop/codecvt.hpp>
+#include <cstdio>
+#include <cwchar>
+#include <fstream>
+#include <iterator>
+#include <locale>
+#include <string>
+#include "sample_text.hpp"
+#include <boost/detail/lightweight_test.hpp>
+#include <boost/detail/lightweight_main.hpp>
+
+using std::string;
+using std::wstring;
+using boost::u16string;
+using boost::u32string;
+using boost::char16;
+using boost::char32;
+using namespace boost::interop;
+
+namespace
+{
+  typedef codecvt_facet<utf16> utf16_facet;
+
+  void facet_test()
+  {
+    std::cout << "facet test..." << std::endl;
+
+    const utf16_facet facet;
+    std::mbstate_t state = std::mbstate_t();
+    const char s[] = "a\xE2\x82\xAC" "b\xF0\x9F\x98\x8A";  // a, euro, b, smiley
+
+    //  an input buffer ending in the middle of a sequence
+    char16 out[8];
+    const char* from_next;
+    char16* to_next;
+    BOOST_TEST(facet.in(state, s, s + 3, from_next, out, out + 8, to_next)
+      == std::codecvt_base::partial);
+    BOOST_TEST(from_next == s + 1);
+    BOOST_TEST(to_next == out + 1);
+    BOOST_TEST(facet.in(state, s, s + 9, from_next, out, out + 8, to_next)
+      == std::codecvt_base::ok);
+    BOOST_TEST(to_next == out + 5);
+    BOOST_TEST(out[1] == 0x20AC && out[3] == 0xD83D && out[4] == 0xDE0A);
+
+    //  an output buffer too small for the next code point
+    BOOST_TEST(facet.in(state, s, s + 9, from_next, out, out + 4, to_next)
+      == std::codecvt_base::partial);
+    BOOST_TEST(from_next == s + 5);
+
+    //  a surrogate pair split across buffers, then invalid input
+    char ext[16];
+    const char16* ifrom_next;
+    char* eto_next;
+    BOOST_TEST(facet.out(state, out, out + 4, ifrom_next, ext, ext + 16, eto_next)
+      == std::codecvt_base::partial);
+    BOOST_TEST(ifrom_next == out + 3);
+    BOOST_TEST(string(ext, eto_next) == "a\xE2\x82\xAC" "b");
+    const char bad[] = "ab\xC0\xAF";
+    BOOST_TEST(facet.in(state, bad, bad + 4, from_next, out, out + 8, to_next)
+      == std::codecvt_base::error);
+    BOOST_TEST(from_next == bad + 2);
+
+    BOOST_TEST_EQ(facet.length(state, s, s + 9, 3), 5);
+    BOOST_TEST_EQ(facet.length(state, s, s + 9, 4), 5);  // the smiley needs 2 units
+    BOOST_TEST_EQ(facet.length(state, s, s + 9, 5), 9);
+    BOOST_TEST_EQ(facet.max_length(), 4);
+    BOOST_TEST(!facet.always_noconv());
+  }
+
+  void wfstream_test()
+  {
+    std::cout << "wfstream test..." << std::endl;
+
+    const char* path = "codecvt_test.tmp";
+    const u32string text = interop_test::make_text(20000);
+    const wstring wtext = make_string<wide, utf32, wstring>(text);
+    const std::locale loc(std::locale::classic(), new codecvt_facet<wide>);
+
+    {
+      std::wofstream out;
+      out.imbue(loc);
+      out.open(path, std::ios_base::binary);
+      out << wtext;
+      BOOST_TEST(out.good());
+    }
+
+    {
+      std::ifstream raw(path, std::ios_base::binary);
+      string bytes((std::istreambuf_iterator<char>(raw)), std::istreambuf_iterator<char>());
+      BOOST_TEST((bytes == make_string<utf8, utf32, string>(text)));
+    }
+
+    {
+      std::wifstream in;
+      in.imbue(loc);
+      in.open(path, std::ios_base::binary);
+      wstring result((std::istreambuf_iterator<wchar_t>(in)),
+        std::istreambuf_iterator<wchar_t>());
+      BOOST_TEST(result == wtext);
+    }
+
+    std::remove(path);
+  }
+
+}  // unnamed namespace
+
+int cpp_main(int, char*[])
+{
+  facet_test();
+  wfstream_test();
+
+  return ::boost::report_errors();
+}
@@ -0,0 +1,246 @@
+//  interop/codepage_test.cpp  ---------------------------------------------------------//
+
+//  Copyright Beman Dawes 2012
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+#include <boost/config/warning_disable.hpp>  // must precede other headers
+
+#include <iostream>
+#include <boost/interop/codepage.hpp>
+#include <boost/interop/string_operators.hpp>
+#include <string>
+#include "random_sequence.hpp"
+#include <boost/detail/lightweight_test.hpp>
+#include <boost/detail/lightweight_main.hpp>
+
+using std::string;
+using boost::u16string;
+using boost::u32string;
+using boost::char16;
+using boost::char32;
+using namespace boost::interop;
+
+namespace
+{
+  typedef narrow_codec<codepage_1252>  cp1252;
+  typedef narrow_codec<koi8_r>         koi8;
+
+  void narrow_codec_test()
+  {
+    std::cout << "narrow_codec test..." << std::endl;
+
+    //  "café €" in codepage 1252 and in UTF-8
+    const string latin("caf\xE9 \x80");
+    const string utf("caf\xC3\xA9 \xE2\x82\xAC");
+
+    BOOST_TEST((make_string<utf8, cp1252, string>(latin) == utf));
+    BOOST_TEST((make_string<cp1252, utf8, string>(utf) == latin));
+
+    //  through conversion_iterator rather than the block kernels
+    string s;
+    for (conversion_iterator<utf8, cp1252, const char*> it(latin.c_str()), end;
+      it != end; ++it)
+      s += *it;
+    BOOST_TEST(s == utf);
+
+    //  undefined bytes decode to U+FFFD; unrepresentable code points encode to '?'
+    u32string u32 = make_string<utf32, cp1252, u32string>(string("\x81z"));
+    BOOST_TEST_EQ(u32.size(), 2u);
+    BOOST_TEST(u32[0] == 0xFFFDu);
+    BOOST_TEST(u32[1] == char32('z'));
+    const char32 cyrillic[] = {0x416, 'x', 0x1F60A, 0};
+    BOOST_TEST((make_string<cp1252, utf32, string>(cyrillic) == "?x?"));
+
+    //  "Жук" in KOI8-R
+    BOOST_TEST((make_string<koi8, utf32, string>(u32string(cyrillic, 1))
+      == string("\xF6")));
+    u16string u16 = make_string<utf16, koi8, u16string>(string("\xF6\xD5\xCB"));
+    BOOST_TEST_EQ(u16.size(), 3u);
+    BOOST_TEST(u16[0] == 0x416u);
+    BOOST_TEST(u16[1] == 0x443u);
+    BOOST_TEST(u16[2] == 0x43Au);
+
+    //  caller supplied buffer
+    char16 buf[8];
+    transcode_result r = transcode<utf16, cp1252>(latin.data(),
+      latin.data() + latin.size(), buf, buf + 8);
+    BOOST_TEST(r.status == transcode_status::ok);
+    BOOST_TEST_EQ(r.written, latin.size());
+    BOOST_TEST(buf[5] == 0x20ACu);
+  }
+
+  //  every defined byte of every codepage survives a round trip
+  void round_trip_test()
+  {
+    std::cout << "round trip test..." << std::endl;
+
+    for (const codepage* cp = codepages_begin(); cp != codepages_end(); ++cp)
+    {
+      int defined = 0;
+      for (int i = 0; i < 256; ++i)
+      {
+        char c = static_cast<char>(i);
+        char32 u = cp->decode(c);
+        if (u == 0xFFFDu)
+          continue;
+        ++defined;
+        if (cp->encode(u) != c)
+        {
+          std::cout << "  " << cp->name << " fails at " << i << std::endl;
+          BOOST_TEST(false);
+        }
+        if (i < 0x80)
+          BOOST_TEST(u == char32(i));
+      }
+      BOOST_TEST(defined > 200);
+    }
+
+    //  the registry and the table types share tables
+    BOOST_TEST(find_codepage("windows-1252")->to_utf16 == codepage_1252::to_utf16);
+    BOOST_TEST(find_codepage(437u)->to_char == codepage_437::to_char);
+  }
+
+  interop_test::random_sequence next_random(1234);
+
+  //  long enough for the vector kernels, with ASCII runs and a ragged tail
+  template <class Table>
+  void bulk_test(const char* name)
+  {
+    typedef narrow_codec<Table> codec;
+    std::cout << "  " << name << std::endl;
+
+    string bytes;
+    for (std::size_t i = 0; i < 4000 + 13; ++i)
+      bytes += static_cast<char>(i % 512 < 100 ? 'a' + i % 26 : next_random() % 256);
+
+    u16string u16 = make_string<utf16, codec, u16string>(bytes);
+    u32string u32 = make_string<utf32, codec, u32string>(bytes);
+    BOOST_TEST_EQ(u16.size(), bytes.size());
+    BOOST_TEST_EQ(u32.size(), bytes.size());
+    for (std::size_t i = 0; i < bytes.size(); ++i)
+    {
+      BOOST_TEST(u16[i] == codec::to_code_point(bytes[i]));
+      BOOST_TEST(u32[i] == codec::to_code_point(bytes[i]));
+    }
+
+    //  the codepage's own characters, Latin-1, other BMP and supplementary code points
+    u32string text;
+    string expected;
+    for (std::size_t i = 0; i < 6000 + 5; ++i)
+    {
+      char32 c;
+      switch (i % 1024 < 200 ? 0 : next_random() % 6)
+      {
+      case 0:  c = 'A' + i % 26; break;
+      case 1:
+      case 2:  c = codec::to_code_point(static_cast<char>(next_random() % 256)); break;
+      case 3:  c = 0x80 + next_random() % 0x80; break;
+      case 4:  c = 0x100 + next_random() % 0xD000; break;
+      default: c = 0x10000 + next_random() % 0x1000; break;
+      }
+      text += c;
+      expected += codec::from_code_point(c);
+    }
+    BOOST_TEST((make_string<codec, utf32, string>(text) == expected));
+    BOOST_TEST((make_string<codec, utf16, string>(
+      make_string<utf16, utf32, u16string>(text)) == expected));
+  }
+
+  void bulk_conversion_test()
+  {
+    std::cout << "bulk conversion test..." << std::endl;
+
+    bulk_test<codepage_437>("codepage_437");
+    bulk_test<codepage_1252>("codepage_1252");
+    bulk_test<iso_8859_1>("iso_8859_1");
+    bulk_test<iso_8859_5>("iso_8859_5");
+    bulk_test<koi8_r>("koi8_r");
+
+    //  output full in the middle of a block
+    const string bytes(100, '\xE9');
+    char16 buf[50];
+    transcode_result r = transcode<utf16, cp1252>(bytes.data(),
+      bytes.data() + bytes.size(), buf, buf + 50);
+    BOOST_TEST(r.status == transcode_status::output_full);
+    BOOST_TEST_EQ(r.consumed, 50u);
+    BOOST_TEST_EQ(r.written, 50u);
+    BOOST_TEST(buf[49] == 0xE9u);
+
+    char out[50];
+    const u16string text(100, char16(0xE9));
+    r = transcode<cp1252, utf16>(text.data(), text.data() + text.size(), out, out + 50);
+    BOOST_TEST(r.status == transcode_status::output_full);
+    BOOST_TEST_EQ(r.written, 50u);
+    BOOST_TEST(out[49] == '\xE9');
+
+    //  a lone surrogate after a long valid run is still invalid
+    u16string bad(40, char16('x'));
+    bad += char16(0xDC00);
+    bad += char16('y');
+    r = transcode<cp1252, utf16>(bad.data(), bad.data() + bad.size(), out, out + 50);
+    BOOST_TEST(r.status == transcode_status::invalid);
+    BOOST_TEST_EQ(r.consumed, 40u);
+  }
+
+  void registry_test()
+  {
+    std::cout << "registry test..." << std::endl;
+
+    BOOST_TEST_EQ(codepages_end() - codepages_begin(), 29);
+    BOOST_TEST(find_codepage("ISO-8859-5") == find_codepage("iso8859_5"));
+    BOOST_TEST(find_codepage("ISO-8859-5") == find_codepage(28595u));
+    BOOST_TEST(find_codepage("ISO-8859-1") == find_codepage("Latin1"));
+    BOOST_TEST(find_codepage("ISO-8859-1") != find_codepage("ISO-8859-11"));
+    BOOST_TEST(find_codepage("cp1252") == find_codepage(1252u));
+    BOOST_TEST(find_codepage("koi8-u") != 0);
+    BOOST_TEST_EQ(find_codepage("koi8-u")->number, 21866u);
+    BOOST_TEST(find_codepage("ebcdic") == 0);
+    BOOST_TEST(find_codepage("") == 0);
+    BOOST_TEST(find_codepage(0u) == 0);
+    BOOST_TEST(find_codepage(65001u) == 0);
+  }
+
+  void run_time_conversion_test()
+  {
+    std::cout << "run time conversion test..." << std::endl;
+
+    const codepage* cp = find_codepage("KOI8-R");
+    BOOST_TEST(cp != 0);
+    const string koi("\xF6\xD5\xCB abc");
+    string s("x");
+    from_codepage<utf8>(*cp, koi.data(), koi.data() + koi.size(), s);
+    BOOST_TEST(s == "x\xD0\x96\xD1\x83\xD0\xBA abc");
+
+    string back;
+    to_codepage<utf8>(*cp, s.data() + 1, s.data() + s.size(), back);
+    BOOST_TEST(back == koi);
+
+    //  agrees with the compile time codec
+    u16string u16;
+    from_codepage<utf16>(*cp, koi.data(), koi.data() + koi.size(), u16);
+    BOOST_TEST((u16 == make_string<utf16, koi8, u16string>(koi)));
+
+    //  invalid input is reported by the source codec
+    const string bad("ab\xFF");
+    string out;
+    bool thrown = false;
+    try { to_codepage<utf8>(*cp, bad.data(), bad.data() + bad.size(), out); }
+    catch (const std::out_of_range&) { thrown = true; }
+    BOOST_TEST(thrown);
+    BOOST_TEST(out == "ab");
+  }
+
+}  // unnamed namespace
+
+int cpp_main(int, char*[])
+{
+  narrow_codec_test();
+  round_trip_test();
+  bulk_conversion_test();
+  registry_test();
+  run_time_conversion_test();
+
+  return ::boost::report_errors();
+}
@@ -0,0 +1,193 @@
+//  interop/conversion_stats_test.cpp  -------------------------------------------------//
+
+//  Copyright Beman Dawes 2012
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+#include <boost/config/warning_disable.hpp>  // must precede other headers
+
+#define BOOST_INTEROP_STATS
+
+#include <iostream>
+#include <boost/interop/string_interop.hpp>
+#include <boost/interop/conversion_stats.hpp>
+#include <boost/interop/string_operators.hpp>
+#include <cstring>
+#include <list>
+#include <string>
+#ifndef BOOST_INTEROP_NO_THREADS
+# include <thread>
+#endif
+#include <boost/detail/lightweight_test.hpp>
+#include <boost/detail/lightweight_main.hpp>
+
+using std::string;
+using boost::u16string;
+using boost::u32string;
+using boost::char16;
+using boost::char32;
+using namespace boost::interop;
+
+namespace
+{
+  //  the counts for a pair, all zero if it has not been used
+  conversion_stats pair_stats(const stats_snapshot& snapshot, const char* to_codec,
+    const char* from_codec)
+  {
+    for (std::size_t i = 0; i < snapshot.pairs.size(); ++i)
+    {
+      if (std::strcmp(snapshot.pairs[i].to_codec, to_codec) == 0
+        && std::strcmp(snapshot.pairs[i].from_codec, from_codec) == 0)
+        return snapshot.pairs[i];
+    }
+    conversion_stats none = {to_codec, from_codec, 0, 0, 0, 0, 0, 0};
+    return none;
+  }
+
+  //  the counts for a pair between two snapshots
+  conversion_stats since(const stats_snapshot& before, const stats_snapshot& after,
+    const char* to_codec, const char* from_codec)
+  {
+    conversion_stats a = pair_stats(after, to_codec, from_codec);
+    conversion_stats b = pair_stats(before, to_codec, from_codec);
+    a.calls -= b.calls;
+    a.input_units -= b.input_units;
+    a.output_units -= b.output_units;
+    a.errors -= b.errors;
+    a.fast_path -= b.fast_path;
+    a.fallback_path -= b.fallback_path;
+    return a;
+  }
+
+  void make_string_test()
+  {
+    std::cout << "make_string test..." << std::endl;
+
+    const string text("a\xCE\xB1\xF0\x9F\x98\x8A");  // 1 + 2 + 4 units, 4 UTF-16 units
+    stats_snapshot before = conversion_stats_snapshot();
+
+    u16string u16 = make_string<utf16, utf8, u16string>(text);
+    make_string<utf16, utf8, u16string>(text.c_str());
+    conversion_stats s = since(before, conversion_stats_snapshot(), "utf16", "utf8");
+    BOOST_TEST_EQ(s.calls, 2U);
+    BOOST_TEST_EQ(s.input_units, 14U);
+    BOOST_TEST_EQ(s.output_units, 8U);
+    BOOST_TEST_EQ(s.fast_path, 2U);
+    BOOST_TEST_EQ(s.fallback_path, 0U);
+    BOOST_TEST_EQ(s.errors, 0U);
+
+    //  a list is converted through conversion_iterator, not the block path
+    before = conversion_stats_snapshot();
+    std::list<char> lst(text.begin(), text.end());
+    make_string<utf32, utf8, u32string>(lst.begin(), lst.end());
+    s = since(before, conversion_stats_snapshot(), "utf32", "utf8");
+    BOOST_TEST_EQ(s.calls, 1U);
+    BOOST_TEST_EQ(s.input_units, 7U);
+    BOOST_TEST_EQ(s.output_units, 3U);
+    BOOST_TEST_EQ(s.fast_path + s.fallback_path, 1U);
+
+    //  each invalid sequence an ErrorPolicy deals with is an error
+    before = conversion_stats_snapshot();
+    make_string<utf8, utf16, string>(u16 + char16(0xDC00) + char16('b')
+      + char16(0xD800), replace_on_error());
+    s = since(before, conversion_stats_snapshot(), "utf8", "utf16");
+    BOOST_TEST_EQ(s.calls, 1U);
+    BOOST_TEST_EQ(s.errors, 2U);
+    BOOST_TEST_EQ(s.input_units, 7U);
+    BOOST_TEST_EQ(s.output_units, 7U + 3 + 1 + 3);
+
+    bool caught = false;
+    before = conversion_stats_snapshot();
+    try { make_string<utf16, utf8, u16string>(string("\xFF")); }
+    catch (const std::out_of_range&) { caught = true; }
+    BOOST_TEST(caught);
+    BOOST_TEST_EQ(since(before, conversion_stats_snapshot(), "utf16", "utf8").errors,
+      1U);
+  }
+
+  void iterator_test()
+  {
+    std::cout << "conversion_iterator test..." << std::endl;
+
+    const string text("abc");
+    stats_snapshot before = conversion_stats_snapshot();
+    typedef conversion_iterator<utf32, utf8, string::const_iterator> iterator;
+    iterator it(text.begin(), text.end());
+    iterator end;
+    BOOST_TEST(std::distance(it, end) == 3);
+    conversion_stats s = since(before, conversion_stats_snapshot(), "utf32", "utf8");
+    BOOST_TEST_EQ(s.calls, 1U);  // the end iterator does not count
+    BOOST_TEST_EQ(s.fast_path, 1U);  // utf8 to utf32 is fused
+    BOOST_TEST_EQ(s.input_units, 3U);
+    BOOST_TEST_EQ(s.output_units, 0U);  // not counted when iterating directly
+
+    //  a size is counted as input, as is a range of forward iterators
+    before = conversion_stats_snapshot();
+    iterator sized(text.begin(), 2);
+    s = since(before, conversion_stats_snapshot(), "utf32", "utf8");
+    BOOST_TEST_EQ(s.calls, 1U);
+    BOOST_TEST_EQ(s.input_units, 2U);
+
+    //  copy_string counts its output
+    before = conversion_stats_snapshot();
+    u16string u16;
+    copy_string<utf8, utf16>(text.begin(), text.end(), std::back_inserter(u16));
+    BOOST_TEST(u16.size() == 3);
+    s = since(before, conversion_stats_snapshot(), "utf16", "utf8");
+    BOOST_TEST_EQ(s.calls, 1U);
+    BOOST_TEST_EQ(s.input_units, 3U);
+    BOOST_TEST_EQ(s.output_units, 3U);
+
+    //  make_string through conversion_iterator counts each unit once
+    before = conversion_stats_snapshot();
+    std::list<char> lst(text.begin(), text.end());
+    make_string<utf16, utf8, u16string>(lst.begin(), lst.end());
+    s = since(before, conversion_stats_snapshot(), "utf16", "utf8");
+    BOOST_TEST_EQ(s.input_units, 3U);
+    BOOST_TEST_EQ(s.output_units, 3U);
+
+    //  narrow_codec pairs are named after the codepage
+    before = conversion_stats_snapshot();
+    make_string<narrow_codec<iso_8859_1>, utf8, string>(string("caf\xC3\xA9"));
+    s = since(before, conversion_stats_snapshot(), "ISO-8859-1", "utf8");
+    BOOST_TEST_EQ(s.calls, 1U);
+    BOOST_TEST_EQ(s.output_units, 4U);
+  }
+
+  void thread_test()
+  {
+#ifndef BOOST_INTEROP_NO_THREADS
+    std::cout << "thread test..." << std::endl;
+
+    stats_snapshot before = conversion_stats_snapshot();
+    std::thread worker([]
+    {
+      for (int i = 0; i < 100; ++i)
+        make_string<utf8, utf32, string>(u32string(10, char32('x')));
+    });
+    worker.join();
+    make_string<utf8, utf32, string>(u32string(5, char32('y')));
+
+    //  the exited thread's counts are kept
+    stats_snapshot after = conversion_stats_snapshot();
+    conversion_stats s = since(before, after, "utf8", "utf32");
+    BOOST_TEST_EQ(s.calls, 101U);
+    BOOST_TEST_EQ(s.input_units, 1005U);
+    BOOST_TEST_EQ(s.output_units, 1005U);
+    BOOST_TEST(after.totals.calls >= 101U + before.totals.calls);
+#endif
+  }
+
+}  // unnamed namespace
+
+int cpp_main(int, char*[])
+{
+  BOOST_TEST_EQ(sizeof(detail::stats_counters), detail::stats_line_size);
+
+  make_string_test();
+  iterator_test();
+  thread_test();
+
+  return ::boost::report_errors();
+}
@@ -10,6 +10,9 @@
 #include <iostream>
 #include <boost/interop/string_interop.hpp>
 #include <cstring>  // for memcmp
+#include <list>
+#include <vector>
+#include <stdexcept>
 #include <boost/detail/lightweight_test.hpp>
 #include <boost/detail/lightweight_main.hpp>
 
@@ -102,6 +105,273 @@ namespace
 # endif
   }
 
+
+//---------------------------------- block_path_test -----------------------------------//
+
+  //  contiguous sources take the block path, std::list sources the iterator path;
+  //  both must agree
+
+  template <class ToCodec, class String>
+  void agree(const String& src)
+  {
+    typedef typename String::value_type value_type;
+    typedef std::basic_string<typename ToCodec::value_type> result_type;
+    std::list<value_type> lst(src.begin(), src.end());
+    std::vector<value_type> vec(src.begin(), src.end());
+
+    result_type expected = make_string<ToCodec>(lst.begin(), lst.end());
+    BOOST_TEST(make_string<ToCodec>(src) == expected);
+    BOOST_TEST(make_string<ToCodec>(src.c_str()) == expected);
+    BOOST_TEST(make_string<ToCodec>(src.c_str(), src.size()) == expected);
+    BOOST_TEST(make_string<ToCodec>(src.begin(), src.end()) == expected);
+    BOOST_TEST(make_string<ToCodec>(vec) == expected);
+    BOOST_TEST(make_string<ToCodec>(vec.begin(), vec.end()) == expected);
+  }
+
+  template <class String>
+  void agree_all(const String& src)
+  {
+    agree<utf8>(src);
+    agree<utf16>(src);
+    agree<utf32>(src);
+    agree<wide>(src);
+  }
+
+  void block_path_test()
+  {
+# ifndef BOOST_NO_FUNCTION_TEMPLATE_DEFAULT_ARGS
+    std::cout << "block_path_test..." << std::endl;
+
+    // mix of 1, 2, 3, and 4 byte UTF-8 sequences, long enough to need output growth
+    u32string mixed32;
+    for (char32 c = 0x20; mixed32.size() < 5000; c = c * 7 % 0x10FFFF + 1)
+    {
+      if (c >= 0xD800 && c <= 0xDFFF)
+        continue;
+      mixed32 += c;
+      mixed32 += 'a';
+    }
+    u16string mixed16 = make_string<utf16>(mixed32.begin(), mixed32.end());
+    string mixed8 = make_string<utf8, utf32>(mixed32.begin(), mixed32.end());
+    BOOST_TEST(make_string<utf32>(mixed16) == mixed32);
+    BOOST_TEST((make_string<utf32, utf8>(mixed8) == mixed32));
+
+    agree_all(mixed32);
+    agree_all(mixed16);
+    agree_all(u16s);
+    agree_all(u32s);
+    agree_all(make_string<wide>(mixed32));
+
+    agree<utf16, string>(mixed8);
+    agree<utf32, string>(mixed8);
+
+    BOOST_TEST(make_string<utf16>(u16string()).empty());
+    BOOST_TEST(make_string<utf8>(std::vector<char16>()).empty());
+
+    // invalid input is reported by the block path just as by the iterator path
+    const char16 lone[] = {'a', 0xDC00, 'b', 0};
+    bool caught = false;
+    try { make_string<utf8>(lone); }
+    catch (const std::out_of_range&) { caught = true; }
+    BOOST_TEST(caught);
+
+    const char truncated[] = "ab\xE2\x82";
+    caught = false;
+    try { make_string<utf16, utf8>(string(truncated)); }
+    catch (const std::out_of_range&) { caught = true; }
+    BOOST_TEST(caught);
+
+    // continuation bytes alone count as no output; a vector target must still be sized
+    const string stray("\x80\x80");
+    std::vector<char16> replaced = make_string<utf16, utf8, std::vector<char16> >(stray,
+      replace_on_error());
+    BOOST_TEST_EQ(replaced.size(), 2u);
+    BOOST_TEST_EQ(replaced[0], 0xFFFDu);
+    BOOST_TEST_EQ(replaced[1], 0xFFFDu);
+    BOOST_TEST((make_string<utf16, utf8, std::vector<char16> >(stray,
+      skip_on_error()).empty()));
+    caught = false;
+    try { make_string<utf16, utf8, std::vector<char16> >(stray); }
+    catch (const std::out_of_range&) { caught = true; }
+    BOOST_TEST(caught);
+# endif
+  }
+
+
+//------------------------------- ascii_fast_path_test ---------------------------------//
+
+  void ascii_fast_path_test()
+  {
+# ifndef BOOST_NO_FUNCTION_TEMPLATE_DEFAULT_ARGS
+    std::cout << "ascii_fast_path_test..." << std::endl;
+
+    // place a non-ASCII code point at every offset around the 16, 32 and 64 unit
+    // block boundaries, so that each is found by the vector loop or the scalar tail
+    for (std::size_t len = 0; len < 140; len += 7)
+    {
+      for (std::size_t pos = 0; pos <= len; ++pos)
+      {
+        u32string s32(len, 'x');
+        if (pos < len)
+          s32[pos] = pos % 2 ? 0x1F60A : 0xE9;
+        agree_all(s32);
+        agree_all(make_string<utf16>(s32));
+        agree<utf16, string>(make_string<utf8>(s32));
+        agree<utf32, string>(make_string<utf8>(s32));
+      }
+    }
+
+    // code units that only look like ASCII in their low byte
+    const char16 fake16[] = {'a', 0x141, 'b', 0x1C1, 0};
+    BOOST_TEST_EQ(make_string<utf8>(fake16), string("a\xC5\x81" "b\xC7\x81"));
+# endif
+  }
+
+//---------------------------------- length_test ---------------------------------------//
+
+  void length_test()
+  {
+    std::cout << "length_test..." << std::endl;
+
+    // mix of one to four UTF-8 byte code points; every prefix length crosses the
+    // vector block sizes at a different point
+    const char32 cps[] = {'a', 0x7F, 0x80, 0x7FF, 0x800, 0xFFFF, 0x10000, 0x10FFFF,
+      0xE9, 0x20AC, 0x1F60A, 'z'};
+    u32string all32;
+    for (std::size_t i = 0; i < 300; ++i)
+      all32 += cps[(i * 7) % (sizeof(cps) / sizeof(cps[0]))];
+
+    for (std::size_t n = 0; n <= all32.size(); n += 13)
+    {
+      u32string s32(all32, 0, n);
+      string s8 = make_string<utf8, utf32, string>(s32);
+      u16string s16 = make_string<utf16, utf32, u16string>(s32);
+      wstring sw = make_string<wide, utf32, wstring>(s32);
+
+      BOOST_TEST_EQ(utf8_length_from_utf32(s32.data(), s32.size()), s8.size());
+      BOOST_TEST_EQ(utf16_length_from_utf32(s32.data(), s32.size()), s16.size());
+      BOOST_TEST_EQ(utf8_length_from_utf16(s16.data(), s16.size()), s8.size());
+      BOOST_TEST_EQ(utf32_length_from_utf16(s16.data(), s16.size()), s32.size());
+      BOOST_TEST_EQ(utf16_length_from_utf8(s8.data(), s8.size()), s16.size());
+      BOOST_TEST_EQ(utf32_length_from_utf8(s8.data(), s8.size()), s32.size());
+      BOOST_TEST_EQ(converted_length<utf8>(sw), s8.size());
+      BOOST_TEST_EQ(converted_length<wide>(s16), sw.size());
+      BOOST_TEST_EQ(converted_length<utf16>(s16), s16.size());
+    }
+  }
+
+//------------------------------- count_code_points_test -------------------------------//
+
+  void count_code_points_test()
+  {
+    std::cout << "count_code_points_test..." << std::endl;
+
+    // long enough that the per-byte vector counters are summed several times
+    const char32 cps[] = {'a', 0xE9, 0x20AC, 0x1F60A, 'b', 'c', 0x10FFFF};
+    u32string s32;
+    for (std::size_t i = 0; i < 40000; ++i)
+      s32 += cps[(i * 5) % (sizeof(cps) / sizeof(cps[0]))];
+    string s8 = make_string<utf8, utf32, string>(s32);
+    u16string s16 = make_string<utf16, utf32, u16string>(s32);
+    wstring sw = make_string<wide, utf32, wstring>(s32);
+
+    BOOST_TEST_EQ(count_code_points<utf8>(s8.data(), s8.size()), s32.size());
+    BOOST_TEST_EQ(count_code_points<utf16>(s16.data(), s16.size()), s32.size());
+    BOOST_TEST_EQ(count_code_points<utf32>(s32.data(), s32.size()), s32.size());
+    BOOST_TEST_EQ(count_code_points(s16), s32.size());
+    BOOST_TEST_EQ(count_code_points(s32), s32.size());
+    BOOST_TEST_EQ(count_code_points(sw), s32.size());
+    BOOST_TEST_EQ((converted_length<utf16, utf8>(s8.data(), s8.size())), s16.size());
+    BOOST_TEST_EQ(converted_length<utf8>(s16), s8.size());
+    BOOST_TEST_EQ((converted_length<utf8, utf8>(s8.data(), s8.size())), s8.size());
+
+    // null terminated
+    BOOST_TEST_EQ(count_code_points<utf8>(s8.c_str()), s32.size());
+    BOOST_TEST_EQ(count_code_points<utf16>(s16.c_str()), s32.size());
+    BOOST_TEST_EQ((converted_length<utf16, utf8>(s8.c_str())), s16.size());
+    BOOST_TEST_EQ((converted_length<utf8, utf32>(s32.c_str())), s8.size());
+    BOOST_TEST_EQ(count_code_points<utf8>(""), 0u);
+
+    // narrow
+    string sn = make_string<narrow, utf32, string>(s32, replace_on_error());
+    BOOST_TEST_EQ(count_code_points<narrow>(sn.data(), sn.size()),
+      (make_string<utf32, narrow, u32string>(sn).size()));
+    BOOST_TEST_EQ((converted_length<wide, narrow>(sn.c_str())),
+      (make_string<wide, narrow, wstring>(sn).size()));
+    BOOST_TEST_EQ((converted_length<narrow_codec<codepage_1252>, utf8>(s8.data(),
+      s8.size())), s32.size());
+    BOOST_TEST_EQ((converted_length<utf16, narrow_codec<codepage_1252> >(
+      sn.data(), sn.size())), sn.size());
+  }
+
+
+//------------------------------- null_terminated_test ---------------------------------//
+
+  void null_terminated_test()
+  {
+    std::cout << "null_terminated_test..." << std::endl;
+
+    // null terminated input is converted a chunk at a time; place sequences across
+    // the first chunk boundary of 16384 bytes, or 8192 UTF-16 units
+    u32string s32(8191, 'x');
+    s32 += 0x1F60A;
+    s32.append(16382 - 8191 - 4, 'y');
+    s32 += 0x1F60E;
+    for (std::size_t i = 0; s32.size() < 40000; ++i)
+      s32 += i % 3 ? char32('a' + i % 26) : char32(0x20AC);
+    string s8 = make_string<utf8, utf32, string>(s32);
+    u16string s16 = make_string<utf16, utf32, u16string>(s32);
+    BOOST_TEST(s16[8191] == 0xD83D && s16[8192] == 0xDE0A);
+    BOOST_TEST(s8.substr(16382, 4) == "\xF0\x9F\x98\x8E");
+
+    // from every alignment, with the terminator at offsets around the vector blocks
+    // and the chunk boundary
+    const std::size_t lengths[] = {0, 1, 15, 16, 17, 33, 8191, 8192, 8193, 16379,
+      16380, 16381, 16382, 40000};
+    for (std::size_t k = 0; k < 16; ++k)
+    {
+      for (std::size_t i = 0; i < sizeof(lengths) / sizeof(lengths[0]); ++i)
+      {
+        u32string t32(s32, 0, lengths[i]);
+        string t8 = string(k, '-') + make_string<utf8, utf32, string>(t32);
+        u16string t16 = u16string(k, '-') + make_string<utf16, utf32, u16string>(t32);
+        t32.insert(0, k, '-');
+        BOOST_TEST((make_string<utf32, utf8, u32string>(t8.c_str() + k)
+          == t32.substr(k)));
+        BOOST_TEST((make_string<utf8, utf16, string>(t16.c_str() + k) == t8.substr(k)));
+        BOOST_TEST((make_string<utf16, utf32, u16string>(t32.c_str() + k)
+          == t16.substr(k)));
+        BOOST_TEST_EQ((converted_length<utf16, utf8>(t8.c_str() + k)), t16.size() - k);
+        BOOST_TEST_EQ(count_code_points<utf16>(t16.c_str() + k), t32.size() - k);
+      }
+    }
+
+    // the iterators find the terminator as they reach it
+    string s;
+    for (conversion_iterator<utf8, utf16, const char16*> it(s16.c_str()), end;
+      it != end; ++it)
+      s += *it;
+    BOOST_TEST(s == s8);
+    u32string r;
+    for (conversion_iterator<utf32, utf8, const char*> it(s8.c_str()), end;
+      it != end; ++it)
+      r += *it;
+    BOOST_TEST(r == s32);
+
+    // errors in a later chunk, and a sequence truncated by the terminator
+    string bad(s8);
+    std::size_t pos = bad.find('b', 30000);
+    bad[pos] = '\xFF';
+    r = make_string<utf32, utf8, u32string>(bad.c_str(), replace_on_error());
+    BOOST_TEST_EQ(r.size(), s32.size());
+    BOOST_TEST(r[count_code_points<utf8>(bad.data(), pos)] == 0xFFFDu);
+    bool caught = false;
+    try { make_string<utf32, utf8, u32string>(bad.c_str()); }
+    catch (const std::out_of_range&) { caught = true; }
+    BOOST_TEST(caught);
+    BOOST_TEST((make_string<utf32, utf8, u32string>("ab\xE2\x82", replace_on_error())
+      .size() == 3));
+  }
 }
 
 //--------------------------------------------------------------------------------------//
@@ -119,6 +389,11 @@ int cpp_main(int, char*[])
 
   no_default_arguments_test();
   default_arguments_test();
+  block_path_test();
+  ascii_fast_path_test();
+  length_test();
+  count_code_points_test();
+  null_terminated_test();
 
   return ::boost::report_errors();
 }
@@ -0,0 +1,264 @@
+//  interop/error_policy_test.cpp  -----------------------------------------------------//
+
+//  Copyright Beman Dawes 2012
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+#include <boost/config/warning_disable.hpp>  // must precede other headers
+
+#include <iostream>
+#include <boost/interop/string_interop.hpp>
+#include <list>
+#include <string>
+#include <stdexcept>
+#include "random_sequence.hpp"
+#include <boost/detail/lightweight_test.hpp>
+#include <boost/detail/lightweight_main.hpp>
+
+using std::string;
+using boost::u16string;
+using boost::u32string;
+using boost::char16;
+using boost::char32;
+using namespace boost::interop;
+
+namespace
+{
+  const char16 fffd = 0xFFFD;
+
+  const char* const pieces[] =
+  {
+    "a", "Z", " ", "\xC2\x80", "\xE2\x82\xAC", "\xF0\x9F\x98\x8A",   // valid
+    "\x80", "\xC0\xAF", "\xED\xA0\x80", "\xF5", "\xE2\x82" "A", "\xFF"  // invalid
+  };
+  const std::size_t n_pieces = sizeof(pieces) / sizeof(pieces[0]);
+
+  interop_test::random_sequence next_random(54321);
+
+  void utf8_source_test()
+  {
+    std::cout << "utf8 source test..." << std::endl;
+
+    const string s("ab\x80" "cd\xE2\x82" "A\xF0\x9F\x98");  // ends truncated
+
+    u16string expect_replace;
+    expect_replace += 'a'; expect_replace += 'b'; expect_replace += fffd;
+    expect_replace += 'c'; expect_replace += 'd'; expect_replace += fffd;
+    expect_replace += 'A'; expect_replace += fffd;
+    BOOST_TEST((make_string<utf16, utf8, u16string>(s, replace_on_error())
+      == expect_replace));
+
+    u16string expect_skip;
+    expect_skip += 'a'; expect_skip += 'b'; expect_skip += 'c'; expect_skip += 'd';
+    expect_skip += 'A';
+    BOOST_TEST((make_string<utf16, utf8, u16string>(s, skip_on_error())
+      == expect_skip));
+
+    std::size_t offset = 99;
+    u16string stopped = make_string<utf16, utf8, u16string>(s, stop_on_error(offset));
+    BOOST_TEST_EQ(offset, 2U);
+    BOOST_TEST(stopped.size() == 2 && stopped[0] == 'a' && stopped[1] == 'b');
+
+    offset = 99;
+    make_string<utf16, utf8, u16string>(string("ab\xE2\x82\xAC"), stop_on_error(offset));
+    BOOST_TEST_EQ(offset, 5U);
+
+    bool caught = false;
+    try { make_string<utf16, utf8, u16string>(s, throw_on_error()); }
+    catch (const std::out_of_range&) { caught = true; }
+    BOOST_TEST(caught);
+
+    //  narrow targets; '?' only where narrow is a single byte encoding
+    string r = make_string<utf8, utf8, string>(s, replace_on_error());
+    BOOST_TEST(r == "ab\xEF\xBF\xBD" "cd\xEF\xBF\xBD" "A\xEF\xBF\xBD");
+  }
+
+  void utf16_utf32_source_test()
+  {
+    std::cout << "utf16 and utf32 source test..." << std::endl;
+
+    const char16 s16[] = {'a', 0xDC00, 'b', 0xD800, 'c', 0xD83D, 0xDE0A, 0xD800, 0};
+    string r = make_string<utf8, utf16, string>(s16, replace_on_error());
+    BOOST_TEST(r == "a\xEF\xBF\xBD" "b\xEF\xBF\xBD" "c\xF0\x9F\x98\x8A\xEF\xBF\xBD");
+    BOOST_TEST((make_string<utf8, utf16, string>(s16, skip_on_error())
+      == "abc\xF0\x9F\x98\x8A"));
+    std::size_t offset = 0;
+    BOOST_TEST((make_string<utf8, utf16, string>(s16, 8, stop_on_error(offset))
+      == "a"));
+    BOOST_TEST_EQ(offset, 1U);
+
+    const char32 s32[] = {'x', 0x110000, 'y', 0xD800, 0x10FFFF};
+    u16string r16 = make_string<utf16, utf32, u16string>(s32, s32 + 5,
+      replace_on_error());
+    BOOST_TEST(r16.size() == 6 && r16[0] == 'x' && r16[1] == fffd && r16[2] == 'y'
+      && r16[3] == fffd && r16[4] == 0xDBFF && r16[5] == 0xDFFF);
+    offset = 0;
+    BOOST_TEST((make_string<utf8, utf32, string>(s32, s32 + 5, stop_on_error(offset))
+      == "x"));
+    BOOST_TEST_EQ(offset, 1U);
+  }
+
+  //  the contiguous, validated path must agree with the iterator path for every policy
+  template <class ToCodec, class ErrorPolicy>
+  void agree(const string& s, ErrorPolicy policy)
+  {
+    typedef std::basic_string<typename ToCodec::value_type> to_string;
+    std::list<char> lst(s.begin(), s.end());
+    BOOST_TEST((make_string<ToCodec, utf8, to_string>(s, policy)
+      == make_string<ToCodec, utf8, to_string>(lst.begin(), lst.end(), policy)));
+  }
+
+  void agreement_test()
+  {
+    std::cout << "agreement test..." << std::endl;
+
+    for (int trial = 0; trial < 2000; ++trial)
+    {
+      string s;
+      std::size_t len = next_random() % 300;
+      while (s.size() < len)
+      {
+        unsigned r = next_random();
+        s += pieces[r % 16 < 15 ? r % 6 : 6 + (r >> 4) % (n_pieces - 6)];
+      }
+
+      agree<utf16>(s, replace_on_error());
+      agree<utf32>(s, skip_on_error());
+      agree<utf8>(s, replace_on_error());
+      agree<utf8>(s, skip_on_error());
+
+      std::size_t offset1 = 0, offset2 = 0;
+      std::list<char> lst(s.begin(), s.end());
+      u16string r1 = make_string<utf16, utf8, u16string>(s, stop_on_error(offset1));
+      u16string r2 = make_string<utf16, utf8, u16string>(lst.begin(), lst.end(),
+        stop_on_error(offset2));
+      BOOST_TEST(r1 == r2);
+      BOOST_TEST_EQ(offset1, offset2);
+      BOOST_TEST_EQ(offset1, validate_utf8(s.data(), s.size()));
+
+      offset1 = 0, offset2 = 0;
+      string c1 = make_string<utf8, utf8, string>(s, stop_on_error(offset1));
+      string c2 = make_string<utf8, utf8, string>(lst.begin(), lst.end(),
+        stop_on_error(offset2));
+      BOOST_TEST(c1 == c2);
+      BOOST_TEST_EQ(offset1, offset2);
+      BOOST_TEST(c1 == s.substr(0, offset1));
+    }
+  }
+
+  //  conversions between the same encoding copy runs of valid input, and must agree
+  //  with the iterator path, which decodes and encodes every code point
+  void same_encoding_test()
+  {
+    std::cout << "same encoding test..." << std::endl;
+
+    const char16 units[] = {'a', 0x3B1, 0xD83D, 0xDE0A, 0xDC00, 0xD800};
+    for (int trial = 0; trial < 500; ++trial)
+    {
+      u16string s;
+      std::size_t len = next_random() % 100;
+      while (s.size() < len)
+      {
+        unsigned r = next_random() % 16;
+        if (r < 12)
+          s += units[r % 2];
+        else if (r < 15)
+          s.append(units + 2, units + 4);
+        else
+          s += units[4 + next_random() % 2];
+      }
+      std::list<char16> lst(s.begin(), s.end());
+      BOOST_TEST((make_string<utf16, utf16, u16string>(s, replace_on_error())
+        == make_string<utf16, utf16, u16string>(lst.begin(), lst.end(),
+             replace_on_error())));
+      std::size_t offset1 = 0, offset2 = 0;
+      BOOST_TEST((make_string<utf16, utf16, u16string>(s, stop_on_error(offset1))
+        == make_string<utf16, utf16, u16string>(lst.begin(), lst.end(),
+             stop_on_error(offset2))));
+      BOOST_TEST_EQ(offset1, offset2);
+    }
+
+    const char32 s32[] = {'x', 0x110000, 'y', 0xD800, 0x10FFFF, 0xFFFFFFFF, 'z'};
+    u32string r32 = make_string<utf32, utf32, u32string>(s32, s32 + 7,
+      replace_on_error());
+    BOOST_TEST(r32.size() == 7 && r32[0] == 'x' && r32[1] == 0xFFFD && r32[2] == 'y'
+      && r32[3] == 0xFFFD && r32[4] == 0x10FFFF && r32[5] == 0xFFFD && r32[6] == 'z');
+
+    //  assume_valid copies without validating, but other conversions still check
+    const string bad("ab\x80" "cd");
+    BOOST_TEST((make_string<utf8, utf8, string>(bad, assume_valid()) == bad));
+    bool caught = false;
+    try { make_string<utf16, utf8, u16string>(bad, assume_valid()); }
+    catch (const std::out_of_range&) { caught = true; }
+    BOOST_TEST(caught);
+    caught = false;
+    try { make_string<utf8, utf8, string>(bad); }
+    catch (const std::out_of_range&) { caught = true; }
+    BOOST_TEST(caught);
+
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+    //  an rvalue source gives up its buffer when it is valid
+    string long8(1000, 'x');
+    long8 += "\xE2\x82\xAC";
+    const char* buffer = long8.data();
+    string moved = make_string<utf8, utf8, string>(std::move(long8));
+    BOOST_TEST(moved.data() == buffer);
+    BOOST_TEST_EQ(moved.size(), 1003U);
+
+    u16string long16(1000, 0x3B1);
+    const char16* buffer16 = long16.data();
+    u16string moved16 = make_string<utf16, utf16, u16string>(std::move(long16),
+      skip_on_error());
+    BOOST_TEST(moved16.data() == buffer16);
+
+    string invalid8(1000, 'x');
+    invalid8 += '\x80';
+    string replaced = make_string<utf8, utf8, string>(std::move(invalid8),
+      replace_on_error());
+    BOOST_TEST_EQ(replaced, string(1000, 'x') + "\xEF\xBF\xBD");
+    caught = false;
+    try { make_string<utf8, utf8, string>(string(bad)); }
+    catch (const std::out_of_range&) { caught = true; }
+    BOOST_TEST(caught);
+#endif
+
+    //  char sources default to narrow, which is the same encoding as utf8 unless the
+    //  locale selects a codepage; on Windows it is always a codepage
+#ifndef BOOST_WINDOWS_API
+    if (!narrow_codepage())
+    {
+      const string text("caf\xC3\xA9");
+      BOOST_TEST((make_string<utf8, default_codec, string>(text) == text));
+      BOOST_TEST((make_string<utf8, default_codec, string>(bad, replace_on_error())
+        == "ab\xEF\xBF\xBD" "cd"));
+      BOOST_TEST((make_string<narrow, utf8, string>(bad, assume_valid()) == bad));
+    }
+#endif
+#if !defined(BOOST_NO_CXX11_RVALUE_REFERENCES) \
+  && !defined(BOOST_NO_FUNCTION_TEMPLATE_DEFAULT_ARGS) && !defined(BOOST_WINDOWS_API)
+    string from_narrow(1000, 'n');
+    const char* narrow_buffer = from_narrow.data();
+    string to_utf8 = make_string<utf8>(std::move(from_narrow));
+    BOOST_TEST_EQ(to_utf8, string(1000, 'n'));
+    BOOST_TEST((to_utf8.data() == narrow_buffer) == !narrow_codepage());
+
+    string from_utf8(1000, 'u');
+    const char* utf8_buffer = from_utf8.data();
+    string to_narrow = make_string<narrow>(std::move(from_utf8));
+    BOOST_TEST_EQ(to_narrow, string(1000, 'u'));
+    BOOST_TEST((to_narrow.data() == utf8_buffer) == !narrow_codepage());
+#endif
+  }
+
+}  // unnamed namespace
+
+int cpp_main(int, char*[])
+{
+  utf8_source_test();
+  utf16_utf32_source_test();
+  agreement_test();
+  same_encoding_test();
+
+  return ::boost::report_errors();
+}
@@ -0,0 +1,265 @@
+//  interop/narrow_encoding_test.cpp  --------------------------------------------------//
+
+//  Copyright Beman Dawes 2012
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+//  narrow follows the environment's locale on POSIX, so the conversion tests check
+//  narrow against whichever encoding was selected. selection_test() covers both the
+//  UTF-8 and the table paths in any locale, through the forms of the locale_narrow
+//  functions that are given the selection.
+
+#include <boost/config/warning_disable.hpp>  // must precede other headers
+
+#include <iostream>
+#include <boost/interop/codepage.hpp>
+#include <boost/interop/string_operators.hpp>
+#include <boost/interop/code_point_view.hpp>
+#include <list>
+#include <string>
+#include <boost/detail/lightweight_test.hpp>
+#include <boost/detail/lightweight_main.hpp>
+
+using std::string;
+using boost::u16string;
+using boost::u32string;
+using boost::char16;
+using boost::char32;
+using namespace boost::interop;
+
+//  narrow is narrow_codec<codepage_437> on Windows; see codepage_test.cpp
+#ifndef BOOST_WINDOWS_API
+
+namespace
+{
+  void codeset_test()
+  {
+    std::cout << "codeset test..." << std::endl;
+
+    BOOST_TEST(detail::codeset_codepage("UTF-8") == 0);
+    BOOST_TEST(detail::codeset_codepage("utf8") == 0);
+    BOOST_TEST(detail::codeset_codepage("ANSI_X3.4-1968") == 0);  // the "C" locale
+    BOOST_TEST(detail::codeset_codepage("EUC-JP") == 0);
+    BOOST_TEST(detail::codeset_codepage("") == 0);
+    BOOST_TEST(detail::codeset_codepage(0) == 0);
+
+    //  glibc and BSD spellings
+    BOOST_TEST(detail::codeset_codepage("ISO-8859-1") == find_codepage(28591u));
+    BOOST_TEST(detail::codeset_codepage("ISO8859-15") == find_codepage(28605u));
+    BOOST_TEST(detail::codeset_codepage("KOI8-R") == find_codepage(20866u));
+    BOOST_TEST(detail::codeset_codepage("CP1251") == find_codepage(1251u));
+
+    //  detected once
+    BOOST_TEST(narrow_codepage() == detail::detect_narrow_codepage());
+    BOOST_TEST(narrow_codepage() == narrow_codepage());
+    std::cout << "  narrow is "
+      << (narrow_codepage() ? narrow_codepage()->name : "UTF-8") << std::endl;
+  }
+
+  //  code points every encoding narrow may select can represent
+  u32string make_text()
+  {
+    u32string s;
+    for (int i = 0; i < 3000; ++i)
+    {
+      s += char32('a' + i % 26);
+      if (i % 7 == 0)
+        s += char32(' ');
+    }
+    return s;
+  }
+
+  //  narrow must agree with utf8, or with the selected table, on every path
+  void conversion_test()
+  {
+    std::cout << "conversion test..." << std::endl;
+
+    u32string text = make_text();
+    const codepage* table = narrow_codepage();
+    if (table)
+      text += table->decode('\xE9');  // a byte every table defines
+    else
+      text += char32(0xE9);
+    text += char32('z');
+
+    string expected;
+    if (table)
+      to_codepage<utf32>(*table, text.data(), text.data() + text.size(), expected);
+    else
+      expected = make_string<utf8, utf32, string>(text);
+
+    //  block paths
+    string n = make_string<narrow, utf32, string>(text);
+    BOOST_TEST(n == expected);
+    BOOST_TEST((make_string<utf32, narrow, u32string>(n) == text));
+    u16string u16 = make_string<utf16, utf32, u16string>(text);
+    BOOST_TEST((make_string<narrow, utf16, string>(u16) == expected));
+    BOOST_TEST((make_string<utf16, narrow, u16string>(n) == u16));
+    string u8 = make_string<utf8, utf32, string>(text);
+    BOOST_TEST((make_string<narrow, utf8, string>(u8) == expected));
+    BOOST_TEST((make_string<utf8, narrow, string>(n) == u8));
+    BOOST_TEST((make_string<narrow, narrow, string>(n) == expected));
+
+    //  iterator paths
+    std::list<char32> list32(text.begin(), text.end());
+    BOOST_TEST((make_string<narrow, utf32, string>(list32.begin(), list32.end())
+      == expected));
+    std::list<char> list8(n.begin(), n.end());
+    BOOST_TEST((make_string<utf32, narrow, u32string>(list8.begin(), list8.end())
+      == text));
+    string s;
+    for (conversion_iterator<narrow, utf32, const char32*> it(text.c_str()), end;
+      it != end; ++it)
+      s += *it;
+    BOOST_TEST(s == expected);
+
+    //  length queries
+    BOOST_TEST_EQ((converted_length<narrow, utf32>(text.data(), text.size())),
+      expected.size());
+    BOOST_TEST_EQ((converted_length<utf16, narrow>(n.data(), n.size())), u16.size());
+  }
+
+  //  converts in with block_converter<ToCodec, FromCodec>, given the selection
+  template <class ToCodec, class FromCodec>
+  std::basic_string<typename ToCodec::value_type> block_convert(const codepage* table,
+    const std::basic_string<typename FromCodec::value_type>& in)
+  {
+    typedef typename ToCodec::value_type to_type;
+    typedef typename FromCodec::value_type from_type;
+
+    std::basic_string<to_type> out(in.size() * 4 + 1, to_type());
+    const from_type* first = in.data();
+    to_type* p = &out[0];
+    char32 cp = 0;
+    BOOST_TEST((detail::block_converter<ToCodec, FromCodec>::convert(table, first,
+      in.data() + in.size(), p, p + out.size(), cp) == detail::block_ok));
+    BOOST_TEST(first == in.data() + in.size());
+    out.resize(p - &out[0]);
+    return out;
+  }
+
+  //  every locale_narrow path, with the selection given rather than detected
+  void selection_test(const codepage* table)
+  {
+    std::cout << "selection test, "
+      << (table ? table->name : "UTF-8") << "..." << std::endl;
+
+    //  text narrow can represent, with its narrow form n
+    u32string text = make_text();
+    string n;
+    if (table)
+    {
+      text += table->decode('\xC1');
+      text += table->decode('\xE9');
+      for (u32string::size_type i = 0; i != text.size(); ++i)
+        n += table->encode(text[i]);
+    }
+    else
+    {
+      text += char32(0xE9);
+      text += char32(0x20AC);
+      text += char32(0x1F60A);
+      n = make_string<utf8, utf32, string>(text);
+    }
+    const u16string u16 = make_string<utf16, utf32, u16string>(text);
+    const string u8 = make_string<utf8, utf32, string>(text);
+    const char* const n_last = n.data() + n.size();
+
+    //  codec functions
+    u32string decoded;
+    std::size_t length = 0;
+    string encoded;
+    for (const char* p = n.data(); p != n_last;)
+    {
+      char32 cp;
+      BOOST_TEST(locale_narrow::decode(table, p, n_last, cp) == detail::decode_ok);
+      decoded += cp;
+      length += locale_narrow::encoded_length(table, cp);
+      locale_narrow::encode(table, cp, std::back_inserter(encoded));
+    }
+    BOOST_TEST(decoded == text);
+    BOOST_TEST_EQ(length, n.size());
+    BOOST_TEST(encoded == n);
+    BOOST_TEST(locale_narrow::validate(table, n.data(), n_last) == n_last);
+    const char* const n_first = n.data();
+    BOOST_TEST(locale_narrow::sequence_start(table, n_first, n_last - 1)
+      == n_last - (table ? 1 : 4));
+    const char* p = n.data();
+    char32 cp;
+    locale_narrow::decode_unchecked(table, p, cp);
+    BOOST_TEST(p == n.data() + 1 && cp == text[0]);
+
+    const string bad("ab\xFF" "c");
+    const char* bad_last = bad.data() + bad.size();
+    BOOST_TEST(locale_narrow::validate(table, bad.data(), bad_last)
+      == (table ? bad_last : bad.data() + 2));
+
+    //  length counters
+    BOOST_TEST_EQ((detail::length_counter<utf32, locale_narrow>::count(table,
+      n.data(), n_last)), text.size());
+    BOOST_TEST_EQ((detail::length_counter<utf16, locale_narrow>::count(table,
+      n.data(), n_last)), u16.size());
+    BOOST_TEST_EQ((detail::length_counter<utf8, locale_narrow>::count(table,
+      n.data(), n_last)), u8.size());
+    BOOST_TEST_EQ((detail::length_counter<locale_narrow, utf32>::count(table,
+      text.data(), text.data() + text.size())), n.size());
+    BOOST_TEST_EQ((detail::length_counter<locale_narrow, utf8>::count(table,
+      u8.data(), u8.data() + u8.size())), n.size());
+    BOOST_TEST_EQ((detail::length_counter<locale_narrow, locale_narrow>::count(table,
+      n.data(), n_last)), n.size());
+
+    //  block converters, both the codepage kernels and the general loops
+    BOOST_TEST((block_convert<utf32, locale_narrow>(table, n) == text));
+    BOOST_TEST((block_convert<utf16, locale_narrow>(table, n) == u16));
+    BOOST_TEST((block_convert<utf8, locale_narrow>(table, n) == u8));
+    BOOST_TEST((block_convert<locale_narrow, utf32>(table, text) == n));
+    BOOST_TEST((block_convert<locale_narrow, utf16>(table, u16) == n));
+    BOOST_TEST((block_convert<locale_narrow, utf8>(table, u8) == n));
+    BOOST_TEST((block_convert<locale_narrow, locale_narrow>(table, n) == n));
+
+    //  code_point_view's index
+    std::vector<std::size_t> offsets;
+    BOOST_TEST_EQ((detail::code_point_index<locale_narrow>::build(table, n.data(),
+      n_last, 64, offsets)), text.size());
+    BOOST_TEST_EQ(offsets.empty(), table != 0);  // single byte: no checkpoints
+    BOOST_TEST(detail::code_point_index<locale_narrow>::advance(table, n.data(),
+      n_last, text.size() - 1) == n_last - (table ? 1 : 4));
+
+    //  only UTF-8 is copied as it is
+    BOOST_TEST((detail::copies_as_is<utf8, locale_narrow>(table) == !table));
+    BOOST_TEST((detail::copies_as_is<locale_narrow, locale_narrow>(table) == !table));
+  }
+
+  void error_test()
+  {
+    std::cout << "error test..." << std::endl;
+
+    //  a byte that is never valid UTF-8 is only an error when narrow is UTF-8
+    const string bad("ab\xFF" "c");
+    u32string r = make_string<utf32, narrow, u32string>(bad, replace_on_error());
+    BOOST_TEST_EQ(r.size(), 4u);
+    BOOST_TEST(r[3] == char32('c'));
+    if (narrow_codepage())
+      BOOST_TEST(r[2] == narrow_codepage()->decode('\xFF'));
+    else
+      BOOST_TEST(r[2] == 0xFFFDu);
+  }
+
+}  // unnamed namespace
+
+#endif  // BOOST_WINDOWS_API
+
+int cpp_main(int, char*[])
+{
+#ifndef BOOST_WINDOWS_API
+  codeset_test();
+  conversion_test();
+  selection_test(0);
+  selection_test(find_codepage(28591u));  // ISO-8859-1
+  selection_test(find_codepage(20866u));  // KOI8-R
+  error_test();
+#endif
+
+  return ::boost::report_errors();
+}
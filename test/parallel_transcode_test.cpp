@@ -0,0 +1,154 @@
+//  interop/parallel_transcode_test.cpp  -----------------------------------------------//
+
+//  Copyright Beman Dawes 2012
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+#include <boost/config/warning_disable.hpp>  // must precede other headers
+
+#include <iostream>
+#include <boost/interop/parallel_transcode.hpp>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "random_sequence.hpp"
+#include <boost/detail/lightweight_test.hpp>
+#include <boost/detail/lightweight_main.hpp>
+
+using std::string;
+using boost::u16string;
+using boost::u32string;
+using boost::char16;
+using boost::char32;
+using namespace boost::interop;
+
+namespace
+{
+  const unsigned threads = 7;  // leaves chunks of uneven length
+
+  interop_test::random_sequence next_random(4321);
+
+  //  long enough for every thread to get a chunk, and dense in multi-unit sequences so
+  //  that most splits need adjusting
+  u32string make_text()
+  {
+    u32string s;
+    std::size_t n = parallel_min_units * threads + 12345;
+    s.reserve(n);
+    while (s.size() < n)
+    {
+      switch (next_random() % 4)
+      {
+      case 0:  s += char32('a' + next_random() % 26); break;
+      case 1:  s += char32(0x80 + next_random() % 0x780); break;
+      case 2:  s += char32(0x4E00 + next_random() % 0x5000); break;
+      default: s += char32(0x10000 + next_random() % 0xFFFFF); break;
+      }
+    }
+    return s;
+  }
+
+  template <class ToCodec, class FromCodec, class FromString, class ToString>
+  void agree(const FromString& src, const ToString& expected)
+  {
+    typedef typename ToCodec::value_type to_type;
+    std::vector<to_type> buf(expected.size() + 10);
+    transcode_result r = parallel_transcode<ToCodec, FromCodec>(src.data(),
+      src.data() + src.size(), &buf[0], &buf[0] + buf.size(), threads);
+    BOOST_TEST(r.status == transcode_status::ok);
+    BOOST_TEST_EQ(r.consumed, src.size());
+    BOOST_TEST_EQ(r.written, expected.size());
+    BOOST_TEST(ToString(&buf[0], r.written) == expected);
+
+    ToString s;
+    s += to_type('x');
+    BOOST_TEST((parallel_transcode<ToCodec, FromCodec>(src.data(),
+      src.data() + src.size(), s, threads) == transcode_status::ok));
+    BOOST_TEST((s.size() == expected.size() + 1 && s.compare(1, s.npos, expected) == 0));
+  }
+
+  void conversion_test()
+  {
+    std::cout << "conversion test..." << std::endl;
+
+    const u32string text32 = make_text();
+    const string text8 = make_string<utf8, utf32, string>(text32);
+    const u16string text16 = make_string<utf16, utf32, u16string>(text32);
+
+    agree<utf16, utf8>(text8, text16);
+    agree<utf32, utf8>(text8, text32);
+    agree<utf8, utf16>(text16, text8);
+    agree<utf32, utf16>(text16, text32);
+    agree<utf8, utf32>(text32, text8);
+    agree<utf16, utf32>(text32, text16);
+  }
+
+  //  errors must be reported exactly as transcode() reports them
+  void error_test()
+  {
+    std::cout << "error test..." << std::endl;
+
+    const string text8 = make_string<utf8, utf32, string>(make_text());
+    std::vector<char16> buf(text8.size() + 10);
+    std::vector<char16> serial_buf(buf.size());
+
+    const std::size_t positions[] = {0, 1, 1000, text8.size() / 3, text8.size() / 2 + 1,
+      text8.size() - 2};
+    for (std::size_t i = 0; i < sizeof(positions) / sizeof(positions[0]); ++i)
+    {
+      for (int kind = 0; kind < 2; ++kind)
+      {
+        string bad(text8);
+        if (kind == 0)
+          bad[positions[i]] = '\xFF';
+        else
+        {
+          bad.resize(positions[i]);
+          bad += '\xE4';  // truncated sequence at the end
+        }
+        transcode_result p = parallel_transcode<utf16, utf8>(bad.data(),
+          bad.data() + bad.size(), &buf[0], &buf[0] + buf.size(), threads);
+        transcode_result s = transcode<utf16, utf8>(bad.data(), bad.data() + bad.size(),
+          &serial_buf[0], &serial_buf[0] + serial_buf.size());
+        BOOST_TEST(p.status == s.status);
+        BOOST_TEST(p.status != transcode_status::ok);
+        BOOST_TEST_EQ(p.consumed, s.consumed);
+        BOOST_TEST_EQ(p.written, s.written);
+        BOOST_TEST((std::equal(buf.begin(), buf.begin() + p.written,
+          serial_buf.begin())));
+
+        u16string str;
+        BOOST_TEST((parallel_transcode<utf16, utf8>(bad.data(), bad.data() + bad.size(),
+          str, threads) == s.status));
+        BOOST_TEST(str.size() == s.written);
+      }
+    }
+
+    //  output too small
+    transcode_result r = parallel_transcode<utf16, utf8>(text8.data(),
+      text8.data() + text8.size(), &buf[0], &buf[0] + 100, threads);
+    BOOST_TEST(r.status == transcode_status::output_full);
+    BOOST_TEST(r.written <= 100);
+
+    //  continuation bytes alone count as no output, but are still invalid
+    const string stray(parallel_min_units * threads, '\x80');
+    r = parallel_transcode<utf16, utf8>(stray.data(), stray.data() + stray.size(),
+      &buf[0], &buf[0] + buf.size(), threads);
+    BOOST_TEST(r.status == transcode_status::invalid);
+    BOOST_TEST_EQ(r.consumed, 0u);
+    u16string str;
+    BOOST_TEST((parallel_transcode<utf16, utf8>(stray.data(),
+      stray.data() + stray.size(), str, threads) == transcode_status::invalid));
+    BOOST_TEST(str.empty());
+  }
+
+}  // unnamed namespace
+
+int cpp_main(int, char*[])
+{
+  conversion_test();
+  error_test();
+
+  return ::boost::report_errors();
+}
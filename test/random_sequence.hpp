@@ -0,0 +1,35 @@
+//  interop/test/random_sequence.hpp  --------------------------------------------------//
+
+//  Copyright Beman Dawes 2012
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+//  A small linear congruential generator for the tests and the benchmark, so that every
+//  platform generates the same input from the same seed.
+
+#if !defined(BOOST_INTEROP_TEST_RANDOM_SEQUENCE_HPP)
+# define BOOST_INTEROP_TEST_RANDOM_SEQUENCE_HPP
+
+namespace interop_test
+{
+  class random_sequence
+  {
+  public:
+    explicit random_sequence(unsigned long seed) : m_seed(seed) {}
+
+    void seed(unsigned long seed) { m_seed = seed; }
+
+    //  the next value, in [0, 0x800000)
+    unsigned operator()()
+    {
+      m_seed = (m_seed * 1103515245UL + 12345UL) & 0x7FFFFFFFUL;
+      return static_cast<unsigned>(m_seed >> 8);
+    }
+
+  private:
+    unsigned long m_seed;
+  };
+}  // namespace interop_test
+
+#endif  // BOOST_INTEROP_TEST_RANDOM_SEQUENCE_HPP
@@ -0,0 +1,36 @@
+//  interop/test/sample_text.hpp  ------------------------------------------------------//
+
+//  Copyright Beman Dawes 2012
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+//  Sample text for the tests that stream or feed text in pieces. The code points cycle
+//  unevenly through ASCII and every UTF-8 and UTF-16 sequence length, with the edges
+//  of each, so that pieces split sequences at every position.
+
+#if !defined(BOOST_INTEROP_TEST_SAMPLE_TEXT_HPP)
+# define BOOST_INTEROP_TEST_SAMPLE_TEXT_HPP
+
+#include <boost/interop/cxx11_char_types.hpp>
+#include <cstddef>
+
+namespace interop_test
+{
+  //  n code points, with exclude, if given, replaced by U+FFFD
+  inline boost::u32string make_text(std::size_t n, boost::char32 exclude = 0)
+  {
+    const boost::char32 cps[] = {'a', 'b', ' ', '\n', 0xE9, 0x3B1, 0x20AC, 0x4E2D,
+      0x1F60A, 0x10FFFF, 0x7FF, 0x800, 0xFFFF, 0x10000};
+    boost::u32string s;
+    s.reserve(n);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+      boost::char32 c = cps[(i * 5 + i / 7) % (sizeof(cps) / sizeof(cps[0]))];
+      s += c == exclude && exclude ? boost::char32(0xFFFD) : c;
+    }
+    return s;
+  }
+}  // namespace interop_test
+
+#endif  // BOOST_INTEROP_TEST_SAMPLE_TEXT_HPP
@@ -12,6 +12,11 @@ using std::cout; using std::endl; using std::hex;
 #include <boost/detail/lightweight_main.hpp>
 #include <string>
 #include <sstream>
+#include <iomanip>
+#include <stdexcept>
+#include <algorithm>
+#include <cstddef>
+#include <streambuf>
 
 using namespace boost;
 using boost::char16;
@@ -75,13 +80,186 @@ namespace
 #endif
   }
 
+  void formatting_test()
+  {
+    cout << "  formatting test...\n";
+
+    std::stringstream ss;
+    ss << std::setw(12) << std::setfill('*') << std::wstring(wmeow) << '|';
+    ss << std::left << std::setw(6) << u16meow << '|';
+    ss << std::setw(2) << boost::u32string(u32meow) << '|';
+    ss << boost::u32string(u32meow) << '|';
+    BOOST_TEST_EQ(ss.str(), std::string("********Meow|Meow**|Meow|Meow|"));
+
+    std::wstringstream wss;
+    wss << std::right << std::setw(6) << std::string(meow) << L'|';
+    BOOST_TEST(wss.str() == std::wstring(L"  Meow|"));
+
+    //  longer than the inserter's buffer, with multi-unit sequences straddling chunks
+    boost::u16string long16;
+    for (int i = 0; i < 300; ++i)
+    {
+      long16 += char16(0x20AC);
+      long16 += char16(0xD83D);
+      long16 += char16(0xDE0A);
+    }
+    std::wstringstream ls;
+    ls << long16;
+    BOOST_TEST((ls.str() == boost::interop::make_string<boost::interop::wide,
+      boost::interop::utf16, std::wstring>(long16)));
+
+    //  a null terminated string spanning several of the chunks its terminator is
+    //  searched for in, with and without padding
+    std::string ascii;
+    for (int i = 0; i < 20000; ++i)
+      ascii += char('a' + i % 26);
+    boost::u16string ascii16(ascii.begin(), ascii.end());
+    std::stringstream ns;
+    ns << ascii16.c_str() << '|' << std::setw(30000) << std::setfill('*')
+      << ascii16.c_str();
+    BOOST_TEST(ns.str() == ascii + '|' + std::string(10000, '*') + ascii);
+
+    std::stringstream es;
+    const char16 bad[] = {'a', 0xDC00, 0};
+    bool caught = false;
+    try { es << bad; }
+    catch (const std::out_of_range&) { caught = true; }
+    BOOST_TEST(caught);
+  }
+
+  //  a streambuf whose get area holds at most chunk characters at a time, so that
+  //  sequences are split across refills, or none at all if chunk is 0
+  class chunked_buf : public std::streambuf
+  {
+  public:
+    chunked_buf(const std::string& s, std::size_t chunk)
+      : m_s(s), m_pos(0), m_chunk(chunk) {}
+
+  protected:
+    int_type underflow()
+    {
+      if (m_pos == m_s.size())
+        return traits_type::eof();
+      if (m_chunk == 0)
+        return traits_type::to_int_type(m_s[m_pos]);
+      std::size_t n = (std::min)(m_chunk, m_s.size() - m_pos);
+      char* p = &m_s[m_pos];
+      setg(p, p, p + n);
+      m_pos += n;
+      return traits_type::to_int_type(*p);
+    }
+
+    int_type uflow()
+    {
+      if (m_chunk != 0)
+        return std::streambuf::uflow();
+      if (m_pos == m_s.size())
+        return traits_type::eof();
+      return traits_type::to_int_type(m_s[m_pos++]);
+    }
+
+  private:
+    std::string  m_s;
+    std::size_t  m_pos;
+    std::size_t  m_chunk;
+  };
+
+  template <class String>
+  String from_utf32(const char32* p)
+  {
+    return boost::interop::make_string<
+      typename boost::interop::select_codec<typename String::value_type>::type,
+      boost::interop::utf32, String>(p);
+  }
+
+  void extract_lines(std::istream& is)
+  {
+    const char32 hello[] = {'h', 0xE9, 'l', 'l', 'o', 0};
+    const char32 world[] = {'w', 0xF6, 'r', 'l', 'd', 0};
+    const char32 line[] = {0xE9, 't', 0xE9, ' ', 'l', 'i', 'n', 'e', 0};
+    const char32 last[] = {'l', 'a', 's', 't', 0};
+
+    boost::u16string word1;
+    boost::u32string word2;
+    is >> word1 >> word2;
+    BOOST_TEST(word1 == from_utf32<boost::u16string>(hello));
+    BOOST_TEST(word2 == from_utf32<boost::u32string>(world));
+
+    std::wstring rest;
+    BOOST_TEST(std::getline(is, rest));
+    BOOST_TEST(rest.empty());
+    BOOST_TEST(std::getline(is, rest));
+    BOOST_TEST(rest == from_utf32<std::wstring>(line));
+    BOOST_TEST(std::getline(is, rest));
+    BOOST_TEST(rest == from_utf32<std::wstring>(last));
+    BOOST_TEST(is.eof() && !is.fail());
+    BOOST_TEST(!std::getline(is, rest));
+  }
+
+  void stream_extractor_test()
+  {
+    cout << "  stream extractor test...\n";
+
+    const char32 text[] = {' ', ' ', 'h', 0xE9, 'l', 'l', 'o', ' ', 'w', 0xF6, 'r', 'l',
+      'd', '\n', 0xE9, 't', 0xE9, ' ', 'l', 'i', 'n', 'e', '\n', 'l', 'a', 's', 't', 0};
+    const std::string narrow_text = from_utf32<std::string>(text);
+
+    {
+      std::istringstream is(narrow_text);
+      extract_lines(is);
+    }
+    for (std::size_t chunk = 0; chunk <= 5; ++chunk)
+    {
+      chunked_buf buf(narrow_text, chunk);
+      std::istream is(&buf);
+      extract_lines(is);
+    }
+
+    //  width limits the extraction
+    {
+      const char32 abcd[] = {'a', 'b', 'c', 'd', 0};
+      const char32 ef[] = {'e', 'f', 0};
+      std::istringstream is("abcdef gh");
+      boost::u16string s;
+      is >> std::setw(4) >> s;
+      BOOST_TEST(s == from_utf32<boost::u16string>(abcd));
+      is >> s;
+      BOOST_TEST(s == from_utf32<boost::u16string>(ef));
+    }
+
+    //  surrogate pairs from a wide stream
+    {
+      const char32 emoji[] = {'a', 0x1F60A, 'b', 0x10000, 0};
+      std::wistringstream is(from_utf32<std::wstring>(emoji) + L" next");
+      boost::u16string s;
+      is >> s;
+      BOOST_TEST(s == from_utf32<boost::u16string>(emoji));
+      std::string n;
+      is >> n;
+      BOOST_TEST_EQ(n, std::string("next"));
+    }
+
+    //  no word, and invalid input
+    {
+      std::istringstream is("   ");
+      boost::u32string s;
+      BOOST_TEST(!(is >> s));
+      BOOST_TEST(is.eof());
+
+      const wchar_t bad[] = {'a', 'b', 0xD800, ' ', 'c', 0};
+      std::wistringstream ws(bad);
+      BOOST_TEST(!(ws >> s));
+    }
+  }
+
 }  // unnamed namespace
 
 int cpp_main(int, char*[])
 {
   cout << "stream tests...\n" << hex;
   stream_inserter_test();
-  //stream_extractor_test();
+  formatting_test();
+  stream_extractor_test();
 
   return ::boost::report_errors();
 }
@@ -0,0 +1,203 @@
+//  interop/string_batch_test.cpp  -----------------------------------------------------//
+
+//  Copyright Beman Dawes 2012
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+#include <boost/config/warning_disable.hpp>  // must precede other headers
+
+#include <iostream>
+#include <boost/interop/string_batch.hpp>
+#include <list>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "random_sequence.hpp"
+#include <boost/detail/lightweight_test.hpp>
+#include <boost/detail/lightweight_main.hpp>
+
+using std::string;
+using boost::u16string;
+using boost::u32string;
+using boost::char16;
+using boost::char32;
+using namespace boost::interop;
+
+namespace
+{
+  interop_test::random_sequence next_random(1234);
+
+  //  the offsets are consistent, and string i is what make_string() makes of source i
+  template <class ToCodec, class FromCodec, class ToString, class Sources,
+    class ErrorPolicy>
+  void check(const string_batch<ToCodec>& batch, const Sources& sources,
+    ErrorPolicy policy)
+  {
+    BOOST_TEST_EQ(batch.size(), sources.size());
+    BOOST_TEST_EQ(batch.offsets()[0], 0U);
+    BOOST_TEST_EQ(batch.offsets()[batch.size()], batch.units());
+    std::size_t i = 0;
+    for (typename Sources::const_iterator it = sources.begin(); it != sources.end();
+      ++it, ++i)
+    {
+      ToString expected = make_string<ToCodec, FromCodec, ToString>(*it, policy);
+      BOOST_TEST(batch.str(i) == expected);
+      BOOST_TEST_EQ(batch.length(i), expected.size());
+      BOOST_TEST(batch.begin(i) + batch.length(i) == batch.end(i));
+    }
+  }
+
+  std::vector<string> utf8_sources()
+  {
+    std::vector<string> v;
+    v.push_back("abc");
+    v.push_back("");
+    v.push_back("\xCE\xB1\xCE\xB2");                // alpha beta
+    v.push_back("\xE2\x82\xAC 10");                 // euro sign
+    v.push_back("\xF0\x9F\x98\x8A smile");          // outside the BMP
+    v.push_back("");
+    v.push_back(string(100, 'x') + "\xC3\xA9");
+    return v;
+  }
+
+  void valid_test()
+  {
+    std::cout << "valid test..." << std::endl;
+
+    std::vector<string> v = utf8_sources();
+    string_batch<utf16> b16 = make_batch<utf16, utf8>(v.begin(), v.end());
+    check<utf16, utf8, u16string>(b16, v, throw_on_error());
+
+    string_batch<utf32> b32 = make_batch<utf32, utf8>(v.begin(), v.end());
+    check<utf32, utf8, u32string>(b32, v, throw_on_error());
+
+    //  same encoding, copied
+    string_batch<utf8> b8 = make_batch<utf8, utf8>(v.begin(), v.end());
+    check<utf8, utf8, string>(b8, v, throw_on_error());
+
+    //  and back again, from the UTF-16 strings
+    std::vector<u16string> v16;
+    for (std::size_t i = 0; i < b16.size(); ++i)
+      v16.push_back(b16.str(i));
+    string_batch<utf8> back = make_batch<utf8, utf16>(v16.begin(), v16.end());
+    BOOST_TEST(string(back.data(), back.units()) == string(b8.data(), b8.units()));
+    check<utf8, utf16, string>(back, v16, throw_on_error());
+
+    //  a codepage, from a list
+    std::list<string> lst;
+    lst.push_back("caf\xC3\xA9");
+    lst.push_back("na\xC3\xAFve");
+    string_batch<narrow_codec<iso_8859_1> > latin1
+      = make_batch<narrow_codec<iso_8859_1>, utf8>(lst.begin(), lst.end());
+    BOOST_TEST(latin1.str(0) == "caf\xE9");
+    BOOST_TEST(latin1.str(1) == "na\xEFve");
+    BOOST_TEST_EQ(latin1.units(), 9U);
+
+    //  no strings at all
+    string_batch<utf16> none = make_batch<utf16, utf8>(v.end(), v.end());
+    BOOST_TEST(none.empty());
+    BOOST_TEST_EQ(none.units(), 0U);
+    BOOST_TEST_EQ(none.offsets()[0], 0U);
+  }
+
+  void append_test()
+  {
+    std::cout << "append test..." << std::endl;
+
+    std::vector<string> v = utf8_sources();
+    string_batch<utf16> batch;
+    append_batch<utf16, utf8>(v.begin(), v.begin() + 3, batch);
+    append_batch<utf16, utf8>(v.begin() + 3, v.end(), batch);
+    check<utf16, utf8, u16string>(batch, v, throw_on_error());
+
+    //  clear keeps the buffer, so the same input again needs no allocation
+    const char16* data = batch.data();
+    batch.clear();
+    BOOST_TEST(batch.empty());
+    BOOST_TEST_EQ(batch.units(), 0U);
+    append_batch<utf16, utf8>(v.begin(), v.end(), batch);
+    BOOST_TEST(batch.data() == data);
+    check<utf16, utf8, u16string>(batch, v, throw_on_error());
+
+    string_batch<utf16> other;
+    other.swap(batch);
+    BOOST_TEST(batch.empty());
+    BOOST_TEST_EQ(other.size(), v.size());
+  }
+
+  void invalid_test()
+  {
+    std::cout << "invalid input test..." << std::endl;
+
+    std::vector<string> v = utf8_sources();
+    v.insert(v.begin() + 2, "a\xFF" "b");
+    v.insert(v.begin() + 4, "\xE2\x82");   // truncated
+    v.push_back("\xC0\xAF end");           // overlong
+
+    string_batch<utf16> replaced = make_batch<utf16, utf8>(v.begin(), v.end(),
+      replace_on_error());
+    check<utf16, utf8, u16string>(replaced, v, replace_on_error());
+
+    string_batch<utf32> skipped = make_batch<utf32, utf8>(v.begin(), v.end(),
+      skip_on_error());
+    check<utf32, utf8, u32string>(skipped, v, skip_on_error());
+
+    string_batch<utf8> copied = make_batch<utf8, utf8>(v.begin(), v.end(),
+      replace_on_error());
+    check<utf8, utf8, string>(copied, v, replace_on_error());
+
+    //  unchecked, invalid input is copied as it is
+    string_batch<utf8> as_is = make_batch<utf8, utf8>(v.begin(), v.end(),
+      assume_valid());
+    BOOST_TEST(as_is.str(2) == "a\xFF" "b");
+
+    //  a throw leaves the batch as it was
+    string_batch<utf16> batch;
+    std::vector<string> good = utf8_sources();
+    append_batch<utf16, utf8>(good.begin(), good.end(), batch);
+    bool caught = false;
+    try { append_batch<utf16, utf8>(v.begin(), v.end(), batch); }
+    catch (const std::out_of_range&) { caught = true; }
+    BOOST_TEST(caught);
+    check<utf16, utf8, u16string>(batch, good, throw_on_error());
+  }
+
+  //  random strings, some invalid, must agree with make_string()
+  void random_test()
+  {
+    std::cout << "random test..." << std::endl;
+
+    const char* const pieces[] = {"a", "z", "\xC3\xA9", "\xE2\x82\xAC",
+      "\xF0\x9F\x98\x8A", "\x80", "\xED\xA0\x80", "\xF4\x90\x80\x80", "\xE2"};
+    const unsigned n_pieces = sizeof(pieces) / sizeof(pieces[0]);
+    for (int round = 0; round < 20; ++round)
+    {
+      std::vector<string> v;
+      for (unsigned i = next_random() % 50; i != 0; --i)
+      {
+        string s;
+        for (unsigned j = next_random() % 12; j != 0; --j)
+          s += pieces[next_random() % (round % 2 ? n_pieces : n_pieces - 4)];
+        v.push_back(s);
+      }
+      string_batch<utf16> b16 = make_batch<utf16, utf8>(v.begin(), v.end(),
+        replace_on_error());
+      check<utf16, utf8, u16string>(b16, v, replace_on_error());
+      string_batch<utf8> b8 = make_batch<utf8, utf8>(v.begin(), v.end(),
+        skip_on_error());
+      check<utf8, utf8, string>(b8, v, skip_on_error());
+    }
+  }
+
+}  // unnamed namespace
+
+int cpp_main(int, char*[])
+{
+  valid_test();
+  append_test();
+  invalid_test();
+  random_test();
+
+  return ::boost::report_errors();
+}
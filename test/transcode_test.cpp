@@ -0,0 +1,157 @@
+//  interop/transcode_test.cpp  --------------------------------------------------------//
+
+//  Copyright Beman Dawes 2012
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+#include <boost/config/warning_disable.hpp>  // must precede other headers
+
+#include <iostream>
+#include <boost/interop/string_operators.hpp>
+#include <string>
+#include <vector>
+#include <boost/detail/lightweight_test.hpp>
+#include <boost/detail/lightweight_main.hpp>
+
+using std::string;
+using std::wstring;
+using boost::u16string;
+using boost::u32string;
+using boost::char16;
+using boost::char32;
+using namespace boost::interop;
+
+namespace
+{
+  const char utf8_text[] = "Hello \xE2\x82\xAC \xF0\x9F\x98\x8A world \xC3\xA9\xC3\xA8"
+    " and some more ASCII to cover the vector loops";
+
+  //  convert s through a buffer of n units, resuming after each output_full
+  template <class ToCodec, class FromCodec, class FromString>
+  std::basic_string<typename ToCodec::value_type>
+    through_buffer(const FromString& s, std::size_t n)
+  {
+    typedef typename ToCodec::value_type to_type;
+    std::vector<to_type> buffer(n);
+    std::basic_string<to_type> result;
+    const typename FromString::value_type* first = s.data();
+    const typename FromString::value_type* last = first + s.size();
+    for (;;)
+    {
+      transcode_result r = transcode<ToCodec, FromCodec>(first, last,
+        &buffer[0], &buffer[0] + n);
+      result.append(&buffer[0], r.written);
+      first += r.consumed;
+      if (r.status != transcode_status::output_full)
+      {
+        BOOST_TEST(r.status == transcode_status::ok);
+        break;
+      }
+      BOOST_TEST(r.written != 0 || n < ToCodec::max_units);
+      if (r.written == 0)
+        break;
+    }
+    return result;
+  }
+
+  void buffer_test()
+  {
+    std::cout << "buffer test..." << std::endl;
+
+    const string s8(utf8_text);
+    const u16string s16 = make_string<utf16, utf8, u16string>(s8);
+    const u32string s32 = make_string<utf32, utf8, u32string>(s8);
+
+    for (std::size_t n = 4; n <= 20; ++n)
+    {
+      BOOST_TEST((through_buffer<utf16, utf8>(s8, n) == s16));
+      BOOST_TEST((through_buffer<utf32, utf8>(s8, n) == s32));
+      BOOST_TEST((through_buffer<utf8, utf16>(s16, n) == s8));
+      BOOST_TEST((through_buffer<utf32, utf16>(s16, n) == s32));
+      BOOST_TEST((through_buffer<utf8, utf32>(s32, n) == s8));
+      BOOST_TEST((through_buffer<utf16, utf32>(s32, n) == s16));
+    }
+  }
+
+  void status_test()
+  {
+    std::cout << "status test..." << std::endl;
+
+    char16 buf[32];
+
+    transcode_result r = transcode<utf16, utf8>(string("abc\xE2\x82"), buf);
+    BOOST_TEST(r.status == transcode_status::incomplete_input);
+    BOOST_TEST_EQ(r.consumed, 3U);
+    BOOST_TEST_EQ(r.written, 3U);
+
+    r = transcode<utf16, utf8>(string("ab\xC0\xAF" "cd"), buf);
+    BOOST_TEST(r.status == transcode_status::invalid);
+    BOOST_TEST_EQ(r.consumed, 2U);
+
+    //  a surrogate pair never straddles the end of the buffer
+    r = transcode<utf16, utf8>(string("a\xF0\x9F\x98\x8A"), buf, 2);
+    BOOST_TEST(r.status == transcode_status::output_full);
+    BOOST_TEST_EQ(r.consumed, 1U);
+    BOOST_TEST_EQ(r.written, 1U);
+
+    r = transcode<utf16, utf8>(string(), buf);
+    BOOST_TEST(r.status == transcode_status::ok);
+    BOOST_TEST_EQ(r.consumed, 0U);
+    BOOST_TEST_EQ(r.written, 0U);
+
+    const char32 bad[] = {'x', 0x110000};
+    char out[8];
+    r = transcode<utf8, utf32>(bad, bad + 2, out, out + 8);
+    BOOST_TEST(r.status == transcode_status::invalid);
+    BOOST_TEST_EQ(r.consumed, 1U);
+    BOOST_TEST_EQ(out[0], 'x');
+  }
+
+  void default_codec_test()
+  {
+    std::cout << "default codec test..." << std::endl;
+
+    //  codecs selected by the character types, as make_string() does
+    const wstring w(L"wide \x20AC text");
+    char narrow_buf[64];
+    transcode_result r = transcode<default_codec, default_codec>(w, narrow_buf);
+    BOOST_TEST(r.status == transcode_status::ok);
+    BOOST_TEST((string(narrow_buf, r.written) == to_narrow<wide, string>(w)));
+
+    const std::vector<char16> v(5, char16('z'));
+    char32 wide_buf[8];
+    r = transcode<default_codec, default_codec>(v, wide_buf);
+    BOOST_TEST(r.status == transcode_status::ok);
+    BOOST_TEST_EQ(r.written, 5U);
+  }
+
+#ifdef BOOST_INTEROP_SPAN
+  void span_test()
+  {
+    std::cout << "span test..." << std::endl;
+
+    const string s8(utf8_text);
+    char16 buf[128];
+    transcode_result r = transcode<utf16, utf8>(std::span<const char>(s8),
+      std::span<char16>(buf));
+    BOOST_TEST(r.status == transcode_status::ok);
+    BOOST_TEST((u16string(buf, r.written) == make_string<utf16, utf8, u16string>(s8)));
+    r = transcode(s8, std::span<char16>(buf, 3));
+    BOOST_TEST(r.status == transcode_status::output_full);
+  }
+#endif
+
+}  // unnamed namespace
+
+int cpp_main(int, char*[])
+{
+  buffer_test();
+  status_test();
+  default_codec_test();
+#ifdef BOOST_INTEROP_SPAN
+  span_test();
+#endif
+
+  return ::boost::report_errors();
+}
@@ -0,0 +1,200 @@
+//  interop/transcoder_test.cpp  -------------------------------------------------------//
+
+//  Copyright Beman Dawes 2012
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+#include <boost/config/warning_disable.hpp>  // must precede other headers
+
+#include <iostream>
+#include <boost/interop/transcoder.hpp>
+#include <string>
+#include <stdexcept>
+#include "sample_text.hpp"
+#include <boost/detail/lightweight_test.hpp>
+#include <boost/detail/lightweight_main.hpp>
+
+using std::string;
+using boost::u16string;
+using boost::u32string;
+using boost::char16;
+using boost::char32;
+using namespace boost::interop;
+
+namespace
+{
+  //  feed src to a transcoder in chunks of chunk_size units, converting into an output
+  //  buffer of out_size units, and return the concatenated output
+  template <class ToCodec, class FromCodec, class FromString>
+  std::basic_string<typename ToCodec::value_type>
+    chunked(const FromString& src, std::size_t chunk_size, std::size_t out_size)
+  {
+    typedef typename ToCodec::value_type to_type;
+    transcoder<ToCodec, FromCodec> t;
+    std::basic_string<to_type> result;
+    std::basic_string<to_type> buffer(out_size, to_type());
+    const typename FromCodec::value_type* p = src.data();
+    const typename FromCodec::value_type* end = p + src.size();
+    while (p != end)
+    {
+      const typename FromCodec::value_type* chunk_end
+        = p + (std::min)(chunk_size, static_cast<std::size_t>(end - p));
+      for (;;)
+      {
+        transcode_result r = t.feed(p, chunk_end, &buffer[0], &buffer[0] + out_size);
+        result.append(buffer, 0, r.written);
+        p += r.consumed;
+        if (r.status == transcode_status::ok)
+          break;
+        BOOST_TEST(r.status == transcode_status::output_full);
+        if (r.status != transcode_status::output_full)
+          return result;
+      }
+    }
+    BOOST_TEST(t.finish() == transcode_status::ok);
+    return result;
+  }
+
+  void split_test()
+  {
+    std::cout << "split test..." << std::endl;
+
+    u32string text32 = interop_test::make_text(500);
+    string text8 = make_string<utf8, utf32, string>(text32);
+    u16string text16 = make_string<utf16, utf32, u16string>(text32);
+
+    for (std::size_t chunk = 1; chunk <= 17; ++chunk)
+    {
+      for (std::size_t out = 4; out <= 9; out += 5)
+      {
+        BOOST_TEST((chunked<utf16, utf8>(text8, chunk, out) == text16));
+        BOOST_TEST((chunked<utf32, utf8>(text8, chunk, out) == text32));
+        BOOST_TEST((chunked<utf8, utf16>(text16, chunk, out) == text8));
+        BOOST_TEST((chunked<utf32, utf16>(text16, chunk, out) == text32));
+        BOOST_TEST((chunked<utf8, utf32>(text32, chunk, out) == text8));
+      }
+    }
+    BOOST_TEST((chunked<utf16, utf8>(text8, 4096, 64) == text16));
+    BOOST_TEST((chunked<utf16, utf8>(text8, 4096, 65536) == text16));
+  }
+
+  void string_feed_test()
+  {
+    std::cout << "string feed test..." << std::endl;
+
+    u32string text32 = interop_test::make_text(500);
+    string text8 = make_string<utf8, utf32, string>(text32);
+    u16string text16 = make_string<utf16, utf32, u16string>(text32);
+
+    transcoder<utf16, utf8> t;
+    u16string result;
+    for (std::size_t pos = 0; pos < text8.size(); pos += 7)
+    {
+      std::size_t n = (std::min)(static_cast<std::size_t>(7), text8.size() - pos);
+      BOOST_TEST(t.feed(text8.data() + pos, text8.data() + pos + n, result)
+        == transcode_status::ok);
+    }
+    BOOST_TEST(!t.pending());
+    BOOST_TEST(result == text16);
+  }
+
+  void error_test()
+  {
+    std::cout << "error test..." << std::endl;
+
+    char16 buf[16];
+
+    //  invalid sequence within a chunk
+    {
+      transcoder<utf16, utf8> t;
+      const char* s = "ab\xC0\xAF" "cd";
+      transcode_result r = t.feed(s, s + 6, buf, buf + 16);
+      BOOST_TEST(r.status == transcode_status::invalid);
+      BOOST_TEST_EQ(r.consumed, 2U);
+      BOOST_TEST_EQ(r.written, 2U);
+    }
+
+    //  sequence split across chunks, then found to be invalid
+    {
+      transcoder<utf16, utf8> t;
+      const char* s1 = "ab\xE2";
+      const char* s2 = "\x82" "A";
+      transcode_result r = t.feed(s1, s1 + 3, buf, buf + 16);
+      BOOST_TEST(r.status == transcode_status::ok);
+      BOOST_TEST_EQ(r.consumed, 3U);
+      BOOST_TEST(t.pending());
+      r = t.feed(s2, s2 + 2, buf, buf + 16);
+      BOOST_TEST(r.status == transcode_status::invalid);
+      BOOST_TEST_EQ(r.consumed, 0U);
+      BOOST_TEST(!t.pending());
+    }
+
+    //  stream ends in the middle of a sequence
+    {
+      transcoder<utf16, utf8> t;
+      const char* s = "ab\xF0\x9F\x98";
+      transcode_result r = t.feed(s, s + 5, buf, buf + 16);
+      BOOST_TEST(r.status == transcode_status::ok);
+      BOOST_TEST_EQ(r.written, 2U);
+      BOOST_TEST(t.finish() == transcode_status::incomplete_input);
+      BOOST_TEST(!t.pending());
+    }
+
+    //  surrogate pair split across chunks, and output too small for it
+    {
+      transcoder<utf8, utf16> t;
+      const char16 s[] = {'a', 0xD83D, 0xDE0A};
+      char out[8];
+      transcode_result r = t.feed(s, s + 2, out, out + 8);
+      BOOST_TEST(r.status == transcode_status::ok);
+      BOOST_TEST_EQ(r.written, 1U);
+      r = t.feed(s + 2, s + 3, out, out + 3);
+      BOOST_TEST(r.status == transcode_status::output_full);
+      BOOST_TEST_EQ(r.consumed, 0U);
+      BOOST_TEST(t.pending());
+      r = t.feed(s + 2, s + 3, out, out + 8);
+      BOOST_TEST(r.status == transcode_status::ok);
+      BOOST_TEST_EQ(r.written, 4U);
+      BOOST_TEST(string(out, 4) == "\xF0\x9F\x98\x8A");
+    }
+  }
+
+  //  from_iterator must not read past the end of a range that splits a surrogate pair
+  void from_iterator_test()
+  {
+    std::cout << "from_iterator test..." << std::endl;
+
+    const char16 s[] = {'a', 0xD83D, 0xDE0A, 0};
+    utf16::from_iterator<const char16*> it(s, s + 2);
+    BOOST_TEST(*it == static_cast<char32>('a'));
+    ++it;
+    bool caught = false;
+    try { *it; }
+    catch (const std::out_of_range&) { caught = true; }
+    BOOST_TEST(caught);
+
+    utf16::from_iterator<const char16*> whole(s, s + 3);
+    ++whole;
+    BOOST_TEST(*whole == static_cast<char32>(0x1F60A));
+    ++whole;
+    BOOST_TEST(whole == utf16::from_iterator<const char16*>());
+
+    const char16 lone_low[] = {0xDE0A, 'a', 0};
+    caught = false;
+    try { *utf16::from_iterator<const char16*>(lone_low); }
+    catch (const std::out_of_range&) { caught = true; }
+    BOOST_TEST(caught);
+  }
+
+}  // unnamed namespace
+
+int cpp_main(int, char*[])
+{
+  split_test();
+  string_feed_test();
+  error_test();
+  from_iterator_test();
+
+  return ::boost::report_errors();
+}
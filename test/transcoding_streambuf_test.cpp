@@ -0,0 +1,135 @@
+//  interop/transcoding_streambuf_test.cpp  --------------------------------------------//
+
+//  Copyright Beman Dawes 2012
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+#include <boost/config/warning_disable.hpp>  // must precede other headers
+
+#include <iostream>
+#include <boost/interop/transcoding_streambuf.hpp>
+#include <istream>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include "sample_text.hpp"
+#include <boost/detail/lightweight_test.hpp>
+#include <boost/detail/lightweight_main.hpp>
+
+using std::string;
+using std::wstring;
+using boost::u16string;
+using boost::u32string;
+using boost::char16;
+using boost::char32;
+using namespace boost::interop;
+
+namespace
+{
+  //  reads everything from buf, n units at a time
+  template <class Streambuf>
+  std::basic_string<typename Streambuf::char_type> read_all(Streambuf& buf,
+    std::streamsize n)
+  {
+    std::basic_string<typename Streambuf::char_type> s;
+    typename Streambuf::char_type chunk[64];
+    std::streamsize got;
+    while ((got = buf.sgetn(chunk, n)) > 0)
+      s.append(chunk, static_cast<std::size_t>(got));
+    return s;
+  }
+
+  void input_test()
+  {
+    std::cout << "input test..." << std::endl;
+
+    //  U+FFFF is left out, here and below, since some char_traits<char16_t>::eof() is
+    //  0xFFFF
+    const u32string text = interop_test::make_text(5000, 0xFFFF);
+    const string utf8_text = make_string<utf8, utf32, string>(text);
+    const u16string text16 = make_string<utf16, utf32, u16string>(text);
+
+    for (std::streamsize n = 1; n <= 64; n *= 4)
+    {
+      std::stringbuf raw(utf8_text);
+      transcoding_streambuf<utf16> buf(&raw);
+      BOOST_TEST(read_all(buf, n) == text16);
+    }
+
+    std::stringbuf raw(utf8_text);
+    transcoding_streambuf<utf32> buf(&raw);
+    BOOST_TEST(read_all(buf, 64) == text);
+
+    //  formatted input through a wistream
+    std::stringbuf words("h\xC3\xA9llo w\xC3\xB6rld");
+    transcoding_streambuf<wide> wbuf(&words);
+    std::wistream is(&wbuf);
+    wstring w1, w2;
+    is >> w1 >> w2;
+    BOOST_TEST(w1.size() == 5 && w1[1] == 0xE9);
+    BOOST_TEST(w2.size() == 5 && w2[1] == 0xF6);
+    BOOST_TEST(is.eof());
+  }
+
+  void output_test()
+  {
+    std::cout << "output test..." << std::endl;
+
+    const u32string text = interop_test::make_text(5000, 0xFFFF);
+    const string utf8_text = make_string<utf8, utf32, string>(text);
+    const u16string text16 = make_string<utf16, utf32, u16string>(text);
+
+    //  odd sized writes split surrogate pairs across flushes
+    {
+      std::stringbuf raw;
+      {
+        transcoding_streambuf<utf16> buf(&raw);
+        for (std::size_t pos = 0; pos < text16.size(); pos += 7)
+          buf.sputn(text16.data() + pos,
+            static_cast<std::streamsize>((std::min)(std::size_t(7), text16.size() - pos)));
+      }
+      BOOST_TEST(raw.str() == utf8_text);
+    }
+
+    {
+      std::stringbuf raw;
+      transcoding_streambuf<wide> buf(&raw);
+      std::wostream os(&buf);
+      os << L"x=" << 42 << L' ' << make_string<wide, utf32, wstring>(text) << std::flush;
+      BOOST_TEST(raw.str() == "x=42 " + utf8_text);
+    }
+
+    //  a lone surrogate cannot be written
+    {
+      std::stringbuf raw;
+      transcoding_streambuf<utf16> buf(&raw);
+      const char16 bad[] = {'a', 0xDC00, 'b'};
+      buf.sputn(bad, 3);
+      BOOST_TEST_EQ(buf.pubsync(), -1);
+    }
+  }
+
+  void error_test()
+  {
+    std::cout << "error test..." << std::endl;
+
+    std::stringbuf invalid("ab\xC0\xAF" "cd");
+    transcoding_streambuf<utf32> buf1(&invalid);
+    BOOST_TEST(read_all(buf1, 64).size() == 2);
+
+    std::stringbuf truncated("ab\xF0\x9F\x98");
+    transcoding_streambuf<utf32> buf2(&truncated);
+    BOOST_TEST(read_all(buf2, 64).size() == 2);
+  }
+
+}  // unnamed namespace
+
+int cpp_main(int, char*[])
+{
+  input_test();
+  output_test();
+  error_test();
+
+  return ::boost::report_errors();
+}
@@ -0,0 +1,242 @@
+//  interop/validate_test.cpp  ---------------------------------------------------------//
+
+//  Copyright Beman Dawes 2012
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+#include <boost/config/warning_disable.hpp>  // must precede other headers
+
+#include <iostream>
+#include <boost/interop/string_interop.hpp>
+#include <cstring>  // for strlen
+#include <list>
+#include <string>
+#include <stdexcept>
+#include "random_sequence.hpp"
+#include <boost/detail/lightweight_test.hpp>
+#include <boost/detail/lightweight_main.hpp>
+
+using std::string;
+using boost::u16string;
+using boost::u32string;
+using boost::char32;
+using namespace boost::interop;
+
+namespace
+{
+  //  straightforward implementation of Unicode 6.1 table 3-7, "Well-Formed UTF-8 Byte
+  //  Sequences", used as the reference
+  std::size_t reference_validate(const string& s)
+  {
+    std::size_t i = 0;
+    while (i < s.size())
+    {
+      unsigned char c = static_cast<unsigned char>(s[i]);
+      unsigned len;
+      unsigned char lo = 0x80, hi = 0xBF;  // range of the second byte
+      if (c <= 0x7F) len = 1;
+      else if (c >= 0xC2 && c <= 0xDF) len = 2;
+      else if (c == 0xE0) { len = 3; lo = 0xA0; }
+      else if (c >= 0xE1 && c <= 0xEC) len = 3;
+      else if (c == 0xED) { len = 3; hi = 0x9F; }
+      else if (c >= 0xEE && c <= 0xEF) len = 3;
+      else if (c == 0xF0) { len = 4; lo = 0x90; }
+      else if (c >= 0xF1 && c <= 0xF3) len = 4;
+      else if (c == 0xF4) { len = 4; hi = 0x8F; }
+      else return i;
+      if (i + len > s.size())
+        return i;
+      for (unsigned k = 1; k < len; ++k)
+      {
+        unsigned char t = static_cast<unsigned char>(s[i + k]);
+        if (k == 1 ? (t < lo || t > hi) : (t < 0x80 || t > 0xBF))
+          return i;
+      }
+      i += len;
+    }
+    return s.size();
+  }
+
+  std::size_t validate(const string& s)
+  {
+    return validate_utf8(s.data(), s.size());
+  }
+
+  //  minimal linear congruential generator so results do not depend on std::rand()
+  interop_test::random_sequence next_random(12345);
+
+  const char* const valid_pieces[] =
+  {
+    "a", "Z", " ", "\xC2\x80", "\xDF\xBF", "\xE0\xA0\x80", "\xE2\x82\xAC",
+    "\xED\x9F\xBF", "\xEE\x80\x80", "\xEF\xBF\xBF", "\xF0\x90\x80\x80",
+    "\xF0\x9F\x98\x8A", "\xF4\x8F\xBF\xBF"
+  };
+
+  const char* const invalid_pieces[] =
+  {
+    "\x80",              // lone continuation
+    "\xBF",
+    "\xC0\xAF",          // overlong '/'
+    "\xC1\xBF",          // overlong
+    "\xE0\x80\xAF",      // overlong
+    "\xE0\x9F\xBF",      // overlong
+    "\xF0\x80\x80\xAF",  // overlong
+    "\xF0\x8F\xBF\xBF",  // overlong
+    "\xED\xA0\x80",      // encoded high surrogate
+    "\xED\xBF\xBF",      // encoded low surrogate
+    "\xF4\x90\x80\x80",  // U+110000
+    "\xF5\x80\x80\x80",  // beyond U+10FFFF
+    "\xFF",
+    "\xC2",              // truncated
+    "\xE2\x82",          // truncated
+    "\xF0\x9F\x98",      // truncated
+    "\xC2\x41",          // missing continuation
+    "\xE2\x41\x82"
+  };
+
+  const std::size_t n_valid = sizeof(valid_pieces) / sizeof(valid_pieces[0]);
+  const std::size_t n_invalid = sizeof(invalid_pieces) / sizeof(invalid_pieces[0]);
+
+  void known_cases_test()
+  {
+    std::cout << "known cases test..." << std::endl;
+
+    BOOST_TEST_EQ(validate(""), 0U);
+    BOOST_TEST_EQ(validate("hello"), 5U);
+    for (std::size_t i = 0; i < n_valid; ++i)
+      BOOST_TEST_EQ(validate(valid_pieces[i]), std::strlen(valid_pieces[i]));
+    for (std::size_t i = 0; i < n_invalid; ++i)
+      BOOST_TEST_EQ(validate(invalid_pieces[i]), 0U);
+    BOOST_TEST_EQ(validate("ab\xE2\x82\xAC\x80"), 5U);
+    BOOST_TEST_EQ(validate(string("a\0b", 3)), 3U);
+  }
+
+  //  place each invalid piece at every offset, in both ASCII and multibyte context,
+  //  so that errors fall on and around every vector block boundary
+  void position_test()
+  {
+    std::cout << "position test..." << std::endl;
+
+    for (std::size_t i = 0; i < n_invalid; ++i)
+    {
+      for (std::size_t pos = 0; pos < 140; ++pos)
+      {
+        string ascii(pos, 'x');
+        ascii += invalid_pieces[i];
+        string s = ascii + string(70, 'y');
+        BOOST_TEST_EQ(validate(s), pos);
+        BOOST_TEST_EQ(validate(ascii), pos);  // error in the tail
+
+        string mixed;
+        while (mixed.size() + 4 <= pos)
+          mixed += valid_pieces[3 + mixed.size() % (n_valid - 3)];
+        mixed.append(pos - mixed.size(), 'x');
+        mixed += invalid_pieces[i];
+        mixed += "\xE2\x82\xAC\xE2\x82\xAC\xE2\x82\xAC";
+        mixed.append(64, 'z');
+        BOOST_TEST_EQ(validate(mixed), reference_validate(mixed));
+        BOOST_TEST_EQ(validate(mixed), pos);
+      }
+    }
+  }
+
+  void random_test()
+  {
+    std::cout << "random test..." << std::endl;
+
+    for (int trial = 0; trial < 20000; ++trial)
+    {
+      string s;
+      std::size_t len = next_random() % 200;
+      unsigned kind = next_random() % 4;
+      while (s.size() < len)
+      {
+        unsigned r = next_random();
+        if (kind == 0 || r % 64 != 0)
+          s += valid_pieces[r % n_valid];
+        else if (kind == 1)
+          s += invalid_pieces[(r >> 6) % n_invalid];
+        else
+          s += static_cast<char>(r >> 6);
+      }
+      if (kind == 3 && !s.empty())
+        s.erase(s.size() - 1);  // likely truncation
+      BOOST_TEST_EQ(validate(s), reference_validate(s));
+    }
+  }
+
+  template <class ToCodec>
+  bool throws(const string& s)
+  {
+    try { make_string<ToCodec, utf8, std::basic_string<typename ToCodec::value_type> >(s); }
+    catch (const std::out_of_range&) { return true; }
+    return false;
+  }
+
+  template <class ToCodec>
+  bool list_throws(const string& s)
+  {
+    std::list<char> lst(s.begin(), s.end());
+    try
+    {
+      make_string<ToCodec, utf8, std::basic_string<typename ToCodec::value_type> >(
+        lst.begin(), lst.end());
+    }
+    catch (const std::out_of_range&) { return true; }
+    return false;
+  }
+
+  void decoder_test()
+  {
+    std::cout << "decoder test..." << std::endl;
+
+    for (std::size_t i = 0; i < n_invalid; ++i)
+    {
+      string s("abc");
+      s += invalid_pieces[i];
+      s += "def";
+      BOOST_TEST(throws<utf16>(s));
+      BOOST_TEST(throws<utf32>(s));
+      BOOST_TEST(list_throws<utf16>(s));  // from_iterator
+      BOOST_TEST(list_throws<utf32>(s));
+    }
+
+    //  the validated, unchecked path must agree with the iterator path
+    string big;
+    for (std::size_t i = 0; i < 3000; ++i)
+      big += valid_pieces[i % n_valid];
+    std::list<char> lst(big.begin(), big.end());
+    BOOST_TEST((make_string<utf16, utf8, u16string>(big)
+      == make_string<utf16, utf8, u16string>(lst.begin(), lst.end())));
+    BOOST_TEST((make_string<utf32, utf8, u32string>(big)
+      == make_string<utf32, utf8, u32string>(lst.begin(), lst.end())));
+
+    //  from_iterator must not read past the end of a range that truncates a sequence
+    const char truncated[] = "a\xE2\x82\xAC";
+    utf8::from_iterator<const char*> it(truncated, truncated + 3);
+    BOOST_TEST(*it == static_cast<char32>('a'));
+    ++it;
+    bool caught = false;
+    try { *it; }
+    catch (const std::out_of_range&) { caught = true; }
+    BOOST_TEST(caught);
+
+    utf8::from_iterator<const char*> whole(truncated, truncated + 4);
+    ++whole;
+    BOOST_TEST(*whole == static_cast<char32>(0x20AC));
+    ++whole;
+    BOOST_TEST(whole == utf8::from_iterator<const char*>());
+  }
+
+}  // unnamed namespace
+
+int cpp_main(int, char*[])
+{
+  known_cases_test();
+  position_test();
+  random_test();
+  decoder_test();
+
+  return ::boost::report_errors();
+}
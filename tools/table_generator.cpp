@@ -17,10 +17,18 @@ using namespace std;
 //   Generate codec tables from http://unicode.org/Public/MAPPINGS/ Format A
 //
 //     Format: Three tab-separated columns
-//        Column #1 is the cp437_DOSLatinUS code (in hex)
-//        Column #2 is the Unicode (in hex as 0xXXXX)
+//        Column #1 is the codepage code (in hex as 0xXX)
+//        Column #2 is the Unicode (in hex as 0xXXXX), or empty if the code is undefined
 //        Column #3 is the Unicode name (follows a comment sign, '#')
 //
+//   Usage: table_generator table-name <mapping >src/table-name.cpp
+//
+//     e.g. table_generator codepage_1252 <CP1252.TXT >src/codepage_1252.cpp
+//          table_generator iso_8859_5 <8859-5.TXT >src/iso_8859_5.cpp
+//
+//   table-name must be declared in boost/interop/codepage_tables.hpp. Undefined codes
+//   decode to U+FFFD, and code points with no codepage representation encode to '?'.
+//
 //--------------------------------------------------------------------------------------//
 
 namespace
@@ -37,9 +45,18 @@ namespace
   int active_slices = 0;
 }
 
-int main()
+int main(int argc, char* argv[])
 {
-  cout << hex;
+  if (argc != 2)
+  {
+    cerr << "Usage: table_generator table-name <mapping >table-name.cpp\n";
+    return 1;
+  }
+  const string name(argv[1]);
+
+  for (int i = 0; i < 256; ++i)
+    wide_char[i] = 0xFFFD;
+
   while (!cin.eof())
   {
     string str;
@@ -49,21 +66,54 @@ int main()
       //cout << str << '\n';
 
       char* endptr;
-      long v1 = strtol(str.c_str()+2, &endptr, 16);
-      long v2 = strtol(str.c_str()+7, &endptr, 16);
-
-      wide_char[v1] = v2;
+      char* endptr2;
+      long v1 = strtol(str.c_str(), &endptr, 16);
+      long v2 = strtol(endptr, &endptr2, 16);
+      if (endptr2 == endptr)
+        continue;  // undefined code
 
       assert(v1 <= 0xFF);
-      narrow_char[v2] = unsigned char(v1);
+      assert(v2 <= 0xFFFF);
+      wide_char[v1] = v2;
+      narrow_char[v2] = static_cast<unsigned char>(v1);
 
       //cout << hex << v1 << " " << v2 << '\n';
     }
   }
 
+  //  narrow_codec treats every table as ASCII compatible
+  for (unsigned int i = 0; i < 0x80; ++i)
+  {
+    if (wide_char[i] != i)
+    {
+      cerr << "table_generator: " << name << " is not a superset of ASCII\n";
+      return 1;
+    }
+  }
+
+  //  generate the file header
+
+  string banner = "//  libs/interop/src/" + name + ".cpp  ";
+  banner.resize(88, '-');
+  cout << banner << "//\n\n"
+          "//  Copyright Beman Dawes 2011\n\n"
+          "//  Distributed under the Boost Software License, Version 1.0.\n"
+          "//  See http://www.boost.org/LICENSE_1_0.txt\n\n"
+          "// define BOOST_INTEROP_SOURCE so that <boost/interop/config.hpp> knows\n"
+          "// the library is being built (possibly exporting rather than importing code)\n"
+          "#define BOOST_INTEROP_SOURCE \n\n"
+          "#include <boost/interop/codepage_tables.hpp>\n"
+          "#include <boost/static_assert.hpp>\n\n"
+          "namespace boost\n{\nnamespace interop\n{\n\n"
+          "/****************** tables generated by tools/table_generator.cpp "
+          "***********************/\n\n"
+          "/****************************** DO NOT EDIT BY HAND "
+          "*************************************/\n\n";
+
   //  generate to_utf16
 
-  cout << "const boost::char16  to_utf16[] =\n{\n";
+  cout << hex;
+  cout << "const boost::char16  " << name << "::to_utf16[256] =\n{";
   for (int i = 0; i < 256; ++i)
   {
     if (i)
@@ -72,11 +122,29 @@ int main()
       cout << '\n';
     cout << "0x" << wide_char[i];
   }
-  cout << "\n};\n\nBOOST_STATIC_ASSERT(sizeof(to_utf16) == 2*256);\n\n";
+  cout << "\n};\n\nBOOST_STATIC_ASSERT(sizeof(" << name
+       << "::to_utf16) == 2*256);\n\n";
+
+  //  count the active slices, so that to_char can be defined with its size
+
+  for (int i = 0; i < n_slices; ++i)
+  {
+    bool slice_active = !i ? true : false;   // character '\0' must be active
+    for (int j = 0; j < chars_per_slice; ++j)
+    {
+      if (narrow_char[i * chars_per_slice + j])
+        slice_active = true;
+    }
+    if (slice_active)
+      ++active_slices;
+  }
+  assert(active_slices < 256);
 
   //  generate to_char output and build slice_index
 
-  cout << "const unsigned char to_char[] =\n{\n";
+  cout << "const unsigned char " << name << "::to_char["
+       << dec << (active_slices + 1) * chars_per_slice << hex << "] =\n{\n";
+  active_slices = 0;
 
   //  slice 0 - characters with no codepage representation
   cout << "//  slice 0 - characters with no codepage representation\n";
@@ -100,7 +168,7 @@ int main()
 
     if (slice_active)
     {
-      slice_index[i] = ++active_slices;
+      slice_index[i] = static_cast<unsigned char>(++active_slices);
 
       cout << "\n//  slice " << dec << active_slices
            << hex << " - 0x" << i * chars_per_slice << '\n';
@@ -111,23 +179,22 @@ int main()
         if (active_slices == 1 && j == 0)
           cout << "0x00";  // character '\0' must be itself
         else if (narrow_char[i * chars_per_slice + j])
-          cout << "0x" << unsigned int(narrow_char[i * chars_per_slice + j]);
+          cout << "0x" << static_cast<unsigned int>(narrow_char[i * chars_per_slice + j]);
         else
           cout << "'?'";
-        if ((i < n_slices-1) || (j < chars_per_slice-1))
-          cout << ',';
+        cout << ',';
         if ((j+1) % 16 == 0)
           cout << '\n';
       }
     }
   }
 
-  cout << "\n};\n\nBOOST_STATIC_ASSERT(sizeof(to_char) == "
+  cout << "\n};\n\nBOOST_STATIC_ASSERT(sizeof(" << name << "::to_char) == "
        << dec << (active_slices + 1) * chars_per_slice << hex << ");\n\n";
 
   //  generate slice_index
 
-  cout << "const boost::uint8_t slice_index[] =\n{\n";
+  cout << "const boost::uint8_t " << name << "::slice_index[512] =\n{\n";
 
   for (int i = 0; i < n_slices; ++i)
   {
@@ -138,10 +205,11 @@ int main()
       cout << '\n';
   }
 
-  cout << "\n};\n\nBOOST_STATIC_ASSERT(sizeof(slice_index) == "
+  cout << "\n};\n\nBOOST_STATIC_ASSERT(sizeof(" << name << "::slice_index) == "
        << dec << n_slices << hex << ");\n\n";
 
+  cout << "}  // namespace interop\n"
+          "}  // namespace boost\n";
 
   return 0;
 }
-
@@ -0,0 +1,633 @@
+//  libs/interop/tools/transcode.cpp  --------------------------------------------------//
+
+//  Copyright Beman Dawes 2012
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+//--------------------------------------------------------------------------------------//
+//
+//   Transcode a file between UTF-8, UTF-16, and UTF-32
+//
+//     Usage: transcode [-f from] [-t to] [-b] [-m] input output
+//
+//     from   auto (the default), utf8, utf16le, utf16be, utf32le, or utf32be. auto
+//            uses the byte order mark if there is one, and otherwise looks for the
+//            zero bytes that UTF-16 and UTF-32 text is full of.
+//     to     utf8 (the default), utf16le, utf16be, utf32le, or utf32be.
+//     -b     write a byte order mark.
+//     -m     write the output through a memory mapped file, sized up front with
+//            converted_length(), rather than through a large buffer.
+//
+//   The input is memory mapped and converted in place when it is in the native byte
+//   order, or a chunk at a time through a byte swapping buffer when it is not, so that
+//   files of any size are converted without first being read into memory. A byte order
+//   mark in the input is not copied to the output. If the input is invalid or ends in
+//   the middle of a sequence, or the output cannot be written, the output file is
+//   removed and the exit status is 1.
+//
+//--------------------------------------------------------------------------------------//
+
+#include <boost/interop/string_interop.hpp>
+#include <boost/interop/transcoder.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#ifdef BOOST_WINDOWS_API
+# include <windows.h>
+#else
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <unistd.h>
+#endif
+
+using namespace boost::interop;
+using boost::char16;
+using boost::char32;
+
+namespace
+{
+  const std::size_t chunk_units = 64 * 1024;          // byte swapped input chunk
+  const std::size_t output_bytes = 4 * 1024 * 1024;   // buffered output
+
+//--------------------------------------------------------------------------------------//
+//                                    encodings                                         //
+//--------------------------------------------------------------------------------------//
+
+  enum encoding { enc_auto, enc_utf8, enc_utf16le, enc_utf16be, enc_utf32le, enc_utf32be };
+
+  struct encoding_info
+  {
+    const char*    name;
+    encoding       enc;
+    std::size_t    unit;   // bytes per code unit
+    bool           big_endian;
+  };
+
+  const encoding_info encodings[] =
+  {
+    {"auto", enc_auto, 0, false},
+    {"utf8", enc_utf8, 1, false},
+    {"utf16le", enc_utf16le, 2, false},
+    {"utf16be", enc_utf16be, 2, true},
+    {"utf32le", enc_utf32le, 4, false},
+    {"utf32be", enc_utf32be, 4, true}
+  };
+
+  const encoding_info* find_encoding(const char* name)
+  {
+    for (std::size_t i = 0; i < sizeof(encodings) / sizeof(encodings[0]); ++i)
+      if (std::strcmp(name, encodings[i].name) == 0)
+        return &encodings[i];
+    return 0;
+  }
+
+  const encoding_info& info(encoding enc) { return encodings[enc]; }
+
+  bool host_is_big_endian()
+  {
+    const unsigned short one = 1;
+    return *reinterpret_cast<const unsigned char*>(&one) == 0;
+  }
+
+  //  whether code units of enc must be byte swapped on this host
+  bool needs_swap(encoding enc)
+  {
+    return info(enc).unit > 1 && info(enc).big_endian != host_is_big_endian();
+  }
+
+  //  returns the length of the byte order mark at p if it is one for enc
+  std::size_t bom_length(const unsigned char* p, std::size_t n, encoding enc)
+  {
+    switch (enc)
+    {
+    case enc_utf8:
+      return n >= 3 && p[0] == 0xEF && p[1] == 0xBB && p[2] == 0xBF ? 3 : 0;
+    case enc_utf16le:
+      return n >= 2 && p[0] == 0xFF && p[1] == 0xFE ? 2 : 0;
+    case enc_utf16be:
+      return n >= 2 && p[0] == 0xFE && p[1] == 0xFF ? 2 : 0;
+    case enc_utf32le:
+      return n >= 4 && p[0] == 0xFF && p[1] == 0xFE && p[2] == 0 && p[3] == 0 ? 4 : 0;
+    case enc_utf32be:
+      return n >= 4 && p[0] == 0 && p[1] == 0 && p[2] == 0xFE && p[3] == 0xFF ? 4 : 0;
+    default:
+      return 0;
+    }
+  }
+
+  encoding detect(const unsigned char* p, std::size_t n)
+  {
+    //  UTF-32LE is tried first, since its BOM begins with the UTF-16LE BOM
+    const encoding by_bom[] = {enc_utf32le, enc_utf32be, enc_utf8, enc_utf16le,
+      enc_utf16be};
+    for (std::size_t i = 0; i < sizeof(by_bom) / sizeof(by_bom[0]); ++i)
+      if (bom_length(p, n, by_bom[i]))
+        return by_bom[i];
+
+    //  count the zero bytes at each position modulo 4 in a sample of whole units
+    std::size_t sample = (std::min)(n, static_cast<std::size_t>(4096)) & ~std::size_t(3);
+    std::size_t zeros[4] = {0, 0, 0, 0};
+    for (std::size_t i = 0; i < sample; ++i)
+      if (p[i] == 0)
+        ++zeros[i % 4];
+    std::size_t units = sample / 4;
+    if (units == 0)
+      return enc_utf8;
+
+    //  the high byte of UTF-32 is always zero, and the next is for the BMP
+    if (zeros[3] == units && zeros[2] >= units / 2)
+      return enc_utf32le;
+    if (zeros[0] == units && zeros[1] >= units / 2)
+      return enc_utf32be;
+
+    //  the high byte of UTF-16 is zero for ASCII, the low byte rarely so
+    std::size_t even = zeros[0] + zeros[2], odd = zeros[1] + zeros[3];
+    if (odd > units / 2 && even < odd / 8)
+      return enc_utf16le;
+    if (even > units / 2 && odd < even / 8)
+      return enc_utf16be;
+    return enc_utf8;
+  }
+
+  template <class T>
+  void swap_units(T* first, T* last)
+  {
+    for (; first != last; ++first)
+    {
+      unsigned char* b = reinterpret_cast<unsigned char*>(first);
+      std::reverse(b, b + sizeof(T));
+    }
+  }
+
+//--------------------------------------------------------------------------------------//
+//                                  mapped files                                        //
+//--------------------------------------------------------------------------------------//
+
+  class mapped_file
+  {
+  public:
+    mapped_file() : m_data(0), m_size(0)
+#ifdef BOOST_WINDOWS_API
+      , m_file(INVALID_HANDLE_VALUE), m_mapping(0)
+#else
+      , m_fd(-1)
+#endif
+    {}
+
+    ~mapped_file() { close(); }
+
+    //  maps path for reading, or if size is given, creates it with that size and maps
+    //  it for writing
+    bool open(const char* path, bool write = false, std::size_t size = 0)
+    {
+#ifdef BOOST_WINDOWS_API
+      m_file = ::CreateFileA(path, write ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ,
+        write ? 0 : FILE_SHARE_READ, 0, write ? CREATE_ALWAYS : OPEN_EXISTING,
+        FILE_FLAG_SEQUENTIAL_SCAN, 0);
+      if (m_file == INVALID_HANDLE_VALUE)
+        return false;
+      if (!write)
+      {
+        LARGE_INTEGER sz;
+        if (!::GetFileSizeEx(m_file, &sz))
+          return false;
+        size = static_cast<std::size_t>(sz.QuadPart);
+      }
+      m_size = size;
+      if (size == 0)
+        return true;
+      unsigned long long sz64 = size;
+      m_mapping = ::CreateFileMappingA(m_file, 0, write ? PAGE_READWRITE : PAGE_READONLY,
+        static_cast<DWORD>(sz64 >> 32), static_cast<DWORD>(sz64), 0);
+      if (!m_mapping)
+        return false;
+      m_data = static_cast<unsigned char*>(::MapViewOfFile(m_mapping,
+        write ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, size));
+      return m_data != 0;
+#else
+      m_fd = write ? ::open(path, O_RDWR | O_CREAT | O_TRUNC, 0666)
+        : ::open(path, O_RDONLY);
+      if (m_fd < 0)
+        return false;
+      if (write)
+      {
+        if (::ftruncate(m_fd, static_cast<off_t>(size)) != 0)
+          return false;
+      }
+      else
+      {
+        struct stat st;
+        if (::fstat(m_fd, &st) != 0)
+          return false;
+        size = static_cast<std::size_t>(st.st_size);
+      }
+      m_size = size;
+      if (size == 0)
+        return true;
+      void* p = ::mmap(0, size, write ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED,
+        m_fd, 0);
+      if (p == MAP_FAILED)
+        return false;
+      m_data = static_cast<unsigned char*>(p);
+      ::madvise(p, size, MADV_SEQUENTIAL);
+      return true;
+#endif
+    }
+
+    void close()
+    {
+#ifdef BOOST_WINDOWS_API
+      if (m_data)
+        ::UnmapViewOfFile(m_data);
+      if (m_mapping)
+        ::CloseHandle(m_mapping);
+      if (m_file != INVALID_HANDLE_VALUE)
+        ::CloseHandle(m_file);
+      m_mapping = 0;
+      m_file = INVALID_HANDLE_VALUE;
+#else
+      if (m_data)
+        ::munmap(m_data, m_size);
+      if (m_fd >= 0)
+        ::close(m_fd);
+      m_fd = -1;
+#endif
+      m_data = 0;
+      m_size = 0;
+    }
+
+    unsigned char* data() const { return m_data; }
+    std::size_t size() const    { return m_size; }
+
+  private:
+    unsigned char*  m_data;
+    std::size_t     m_size;
+#ifdef BOOST_WINDOWS_API
+    HANDLE          m_file;
+    HANDLE          m_mapping;
+#else
+    int             m_fd;
+#endif
+
+    mapped_file(const mapped_file&);
+    mapped_file& operator=(const mapped_file&);
+  };
+
+//--------------------------------------------------------------------------------------//
+//                                     sinks                                            //
+//--------------------------------------------------------------------------------------//
+
+//  A sink supplies the output buffer [out, out_last) with buffer(), and is told with
+//  commit() how many units were written to it. Both sinks byte swap in place.
+
+  template <class T>
+  class buffered_sink
+  {
+  public:
+    buffered_sink(std::FILE* file, bool swap)
+      : m_file(file), m_swap(swap), m_buffer(output_bytes / sizeof(T)), m_size(0) {}
+
+    bool buffer(T*& out, T*& out_last, std::size_t min_room)
+    {
+      if (m_buffer.size() - m_size < min_room && !flush())
+        return false;
+      out = &m_buffer[0] + m_size;
+      out_last = &m_buffer[0] + m_buffer.size();
+      return true;
+    }
+
+    void commit(std::size_t n) { m_size += n; }
+
+    bool flush()
+    {
+      if (m_swap)
+        swap_units(&m_buffer[0], &m_buffer[0] + m_size);
+      bool ok = std::fwrite(&m_buffer[0], sizeof(T), m_size, m_file) == m_size;
+      m_size = 0;
+      return ok;
+    }
+
+  private:
+    std::FILE*      m_file;
+    bool            m_swap;
+    std::vector<T>  m_buffer;
+    std::size_t     m_size;
+  };
+
+  template <class T>
+  class mapped_sink
+  {
+  public:
+    mapped_sink(T* first, T* last, bool swap)
+      : m_next(first), m_last(last), m_swap(swap) {}
+
+    bool buffer(T*& out, T*& out_last, std::size_t)
+    {
+      out = m_next;
+      out_last = m_last;
+      return true;
+    }
+
+    void commit(std::size_t n)
+    {
+      if (m_swap)
+        swap_units(m_next, m_next + n);
+      m_next += n;
+    }
+
+    bool flush() { return m_next == m_last; }  // the size was computed exactly
+
+  private:
+    T*    m_next;
+    T*    m_last;
+    bool  m_swap;
+  };
+
+//--------------------------------------------------------------------------------------//
+//                                   conversion                                         //
+//--------------------------------------------------------------------------------------//
+
+  //  the length of the next input chunk, which does not end with a UTF-16 high
+  //  surrogate unless it is the last
+  template <class T>
+  std::size_t chunk_length(const T* p, std::size_t remaining, bool swap)
+  {
+    std::size_t n = (std::min)(remaining, chunk_units);
+    if (sizeof(T) == 2 && n < remaining)
+    {
+      T last = p[n - 1];
+      if (swap)
+        swap_units(&last, &last + 1);
+      if (last >= 0xD800 && last <= 0xDBFF)
+        --n;
+    }
+    return n;
+  }
+
+  //  the number of ToCodec units the input converts to
+  template <class ToCodec, class FromCodec>
+  std::size_t output_length(const unsigned char* data, std::size_t size, bool swap)
+  {
+    typedef typename FromCodec::value_type from_type;
+    const from_type* units = reinterpret_cast<const from_type*>(data);
+    std::size_t n = size / sizeof(from_type);
+    if (!swap)
+      return converted_length<ToCodec, FromCodec>(units, n);
+
+    std::vector<from_type> chunk(chunk_units);
+    std::size_t length = 0;
+    for (std::size_t pos = 0; pos < n;)
+    {
+      std::size_t len = chunk_length(units + pos, n - pos, true);
+      std::copy(units + pos, units + pos + len, chunk.begin());
+      swap_units(&chunk[0], &chunk[0] + len);
+      length += converted_length<ToCodec, FromCodec>(&chunk[0], len);
+      pos += len;
+    }
+    return length;
+  }
+
+  template <class ToCodec, class FromCodec, class Sink>
+  bool convert(const unsigned char* data, std::size_t size, bool swap, Sink& sink)
+  {
+    typedef typename FromCodec::value_type  from_type;
+    typedef typename ToCodec::value_type    to_type;
+
+    const from_type* units = reinterpret_cast<const from_type*>(data);
+    std::size_t n = size / sizeof(from_type);
+    transcoder<ToCodec, FromCodec> converter;
+    std::vector<from_type> chunk(swap ? chunk_units : 0);
+    bool ok = true;
+
+    for (std::size_t pos = 0; ok && pos < n;)
+    {
+      std::size_t len = chunk_length(units + pos, n - pos, swap);
+      const from_type* first = units + pos;
+      if (swap)
+      {
+        std::copy(first, first + len, chunk.begin());
+        swap_units(&chunk[0], &chunk[0] + len);
+        first = &chunk[0];
+      }
+      const from_type* const chunk_first = first;
+      const from_type* const last = first + len;
+
+      while (first != last)
+      {
+        to_type* out;
+        to_type* out_last;
+        if (!sink.buffer(out, out_last, ToCodec::max_units))
+        {
+          std::cerr << "transcode: write failed\n";
+          ok = false;
+          break;
+        }
+        transcode_result r = converter.feed(first, last, out, out_last);
+        first += r.consumed;
+        sink.commit(r.written);
+        if (r.status == transcode_status::invalid)
+        {
+          std::cerr << "transcode: invalid input at byte offset "
+            << (pos + (first - chunk_first)) * sizeof(from_type) << '\n';
+          ok = false;
+          break;
+        }
+        if (r.status == transcode_status::output_full && r.written == 0
+          && r.consumed == 0)
+        {
+          //  a mapped output is sized by converted_length(), whose count for invalid
+          //  input is unspecified, so the invalid input is here or further on
+          std::cerr << "transcode: invalid input at or after byte offset "
+            << (pos + (first - chunk_first)) * sizeof(from_type) << '\n';
+          ok = false;
+          break;
+        }
+      }
+      pos += len;
+    }
+
+    if (ok && converter.finish() != transcode_status::ok)
+    {
+      std::cerr << "transcode: input ends in the middle of a sequence\n";
+      ok = false;
+    }
+    if (ok && !sink.flush())
+    {
+      std::cerr << "transcode: write failed\n";
+      ok = false;
+    }
+    return ok;
+  }
+
+  struct options
+  {
+    encoding     from;
+    encoding     to;
+    bool         bom;
+    bool         mapped;
+    const char*  input;
+    const char*  output;
+  };
+
+  void write_bom(unsigned char* p, encoding enc)
+  {
+    const unsigned char boms[][4] =
+    {
+      {0, 0, 0, 0}, {0xEF, 0xBB, 0xBF, 0}, {0xFF, 0xFE, 0, 0}, {0xFE, 0xFF, 0, 0},
+      {0xFF, 0xFE, 0, 0}, {0, 0, 0xFE, 0xFF}
+    };
+    std::memcpy(p, boms[enc], 4);
+  }
+
+  std::size_t bom_size(encoding enc) { return enc == enc_utf8 ? 3 : info(enc).unit; }
+
+  template <class ToCodec, class FromCodec>
+  int run(const options& opt, const unsigned char* data, std::size_t size)
+  {
+    typedef typename ToCodec::value_type to_type;
+
+    bool swap_in = needs_swap(opt.from);
+    bool swap_out = needs_swap(opt.to);
+    std::size_t bom = opt.bom ? bom_size(opt.to) : 0;
+
+    if (opt.mapped)
+    {
+      std::size_t length = output_length<ToCodec, FromCodec>(data, size, swap_in);
+      mapped_file out;
+      if (!out.open(opt.output, true, bom + length * sizeof(to_type)))
+      {
+        std::cerr << "transcode: could not map " << opt.output << '\n';
+        out.close();
+        std::remove(opt.output);
+        return 1;
+      }
+      if (bom)
+      {
+        unsigned char b[4];
+        write_bom(b, opt.to);
+        std::memcpy(out.data(), b, bom);
+      }
+      to_type* first = reinterpret_cast<to_type*>(out.data() + bom);
+      mapped_sink<to_type> sink(first, first + length, swap_out);
+      bool ok = convert<ToCodec, FromCodec>(data, size, swap_in, sink);
+      out.close();
+      if (!ok)
+        std::remove(opt.output);  // rather than leave it partly written
+      return ok ? 0 : 1;
+    }
+
+    std::FILE* file = std::fopen(opt.output, "wb");
+    if (!file)
+    {
+      std::cerr << "transcode: could not open " << opt.output << '\n';
+      return 1;
+    }
+    std::setvbuf(file, 0, _IONBF, 0);  // the sink does the buffering
+    bool ok = true;
+    if (bom)
+    {
+      unsigned char b[4];
+      write_bom(b, opt.to);
+      ok = std::fwrite(b, 1, bom, file) == bom;
+    }
+    {
+      buffered_sink<to_type> sink(file, swap_out);
+      ok = ok && convert<ToCodec, FromCodec>(data, size, swap_in, sink);
+    }
+    ok = std::fclose(file) == 0 && ok;
+    if (!ok)
+      std::remove(opt.output);  // rather than leave it partly written
+    return ok ? 0 : 1;
+  }
+
+  template <class FromCodec>
+  int run_from(const options& opt, const unsigned char* data, std::size_t size)
+  {
+    switch (info(opt.to).unit)
+    {
+    case 1:  return run<utf8, FromCodec>(opt, data, size);
+    case 2:  return run<utf16, FromCodec>(opt, data, size);
+    default: return run<utf32, FromCodec>(opt, data, size);
+    }
+  }
+
+  int usage()
+  {
+    std::cerr << "Usage: transcode [-f from] [-t to] [-b] [-m] input output\n"
+      "  from: auto, utf8, utf16le, utf16be, utf32le, utf32be (default auto)\n"
+      "  to:   utf8, utf16le, utf16be, utf32le, utf32be (default utf8)\n"
+      "  -b    write a byte order mark\n"
+      "  -m    write through a memory mapped output file\n";
+    return 2;
+  }
+
+}  // unnamed namespace
+
+int main(int argc, char* argv[])
+{
+  options opt = {enc_auto, enc_utf8, false, false, 0, 0};
+
+  for (int i = 1; i < argc; ++i)
+  {
+    const encoding_info* e;
+    if ((std::strcmp(argv[i], "-f") == 0 || std::strcmp(argv[i], "-t") == 0)
+      && i + 1 < argc && (e = find_encoding(argv[i + 1])) != 0)
+    {
+      if (argv[i][1] == 'f')
+        opt.from = e->enc;
+      else if (e->enc != enc_auto)
+        opt.to = e->enc;
+      else
+        return usage();
+      ++i;
+    }
+    else if (std::strcmp(argv[i], "-b") == 0)
+      opt.bom = true;
+    else if (std::strcmp(argv[i], "-m") == 0)
+      opt.mapped = true;
+    else if (argv[i][0] != '-' && !opt.input)
+      opt.input = argv[i];
+    else if (argv[i][0] != '-' && !opt.output)
+      opt.output = argv[i];
+    else
+      return usage();
+  }
+  if (!opt.output)
+    return usage();
+
+  mapped_file in;
+  if (!in.open(opt.input))
+  {
+    std::cerr << "transcode: could not map " << opt.input << '\n';
+    return 1;
+  }
+  const unsigned char* data = in.data();
+  std::size_t size = in.size();
+
+  if (opt.from == enc_auto)
+    opt.from = detect(data, size);
+  std::size_t bom = bom_length(data, size, opt.from);
+  data += bom;
+  size -= bom;
+  if (size % info(opt.from).unit)
+  {
+    std::cerr << "transcode: " << opt.input << " is not a whole number of "
+      << info(opt.from).name << " code units\n";
+    return 1;
+  }
+
+  switch (info(opt.from).unit)
+  {
+  case 1:  return run_from<utf8>(opt, data, size);
+  case 2:  return run_from<utf16>(opt, data, size);
+  default: return run_from<utf32>(opt, data, size);
+  }
+}